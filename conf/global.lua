@@ -8,5 +8,8 @@ return {
   },
   autoupdate = {
     enable = false
+  },
+  rebase = {
+    inmemory = false
   }
 }
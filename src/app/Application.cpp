@@ -103,6 +103,8 @@ Application::Application(int &argc, char **argv, bool haltOnParseError)
 
   // Register types that are queued at runtime.
   qRegisterMetaType<git::Id>();
+  qRegisterMetaType<git::Commit>();
+  qRegisterMetaType<git::Rebase>();
 
   // Connect updater signals.
   connect(Updater::instance(), &Updater::sslErrors, this,
@@ -30,6 +30,7 @@ public:
     PushAfterEachCommit,
     UpdateSubmodulesAfterPullAndClone,
     PruneAfterFetch,
+    RebaseInMemory,
     FontFamily,
     FontSize,
     UseTabsForIndent,
@@ -0,0 +1,115 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "ContributorsDialog.h"
+#include "index/Statistics.h"
+#include "ui/RepoView.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+enum Column { Name, Email, Commits, Additions, Deletions };
+
+class Item : public QTreeWidgetItem {
+public:
+  Item(const Statistics::Author &author, QTreeWidget *parent)
+      : QTreeWidgetItem(parent), mCounts(author.counts) {
+    setText(Name, author.name);
+    setText(Email, author.email);
+    setText(Commits, QString::number(mCounts.commits));
+    setText(Additions, QString::number(mCounts.additions));
+    setText(Deletions, QString::number(mCounts.deletions));
+
+    for (int column = Commits; column <= Deletions; ++column)
+      setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+  }
+
+  bool operator<(const QTreeWidgetItem &other) const override {
+    const Statistics::Counts &rhs = static_cast<const Item &>(other).mCounts;
+    switch (treeWidget()->sortColumn()) {
+      case Commits:
+        return mCounts.commits < rhs.commits;
+      case Additions:
+        return mCounts.additions < rhs.additions;
+      case Deletions:
+        return mCounts.deletions < rhs.deletions;
+      default:
+        return QTreeWidgetItem::operator<(other);
+    }
+  }
+
+private:
+  Statistics::Counts mCounts;
+};
+
+} // namespace
+
+ContributorsDialog::ContributorsDialog(RepoView *parent, const QString &path)
+    : QDialog(parent), mStatistics(parent->statistics()) {
+  setAttribute(Qt::WA_DeleteOnClose);
+  setWindowTitle(tr("Contributors"));
+
+  mPath = new QLineEdit(path, this);
+  mPath->setPlaceholderText(tr("Whole repository"));
+  connect(mPath, &QLineEdit::textChanged, this,
+          &ContributorsDialog::updateAuthors);
+
+  QFormLayout *form = new QFormLayout;
+  form->addRow(tr("Directory:"), mPath);
+
+  mAuthors = new QTreeWidget(this);
+  mAuthors->setRootIsDecorated(false);
+  mAuthors->setUniformRowHeights(true);
+  mAuthors->setHeaderLabels(
+      {tr("Name"), tr("Email"), tr("Commits"), tr("Added"), tr("Removed")});
+  mAuthors->header()->setStretchLastSection(false);
+  mAuthors->header()->setSectionResizeMode(Name, QHeaderView::Stretch);
+  mAuthors->setSortingEnabled(true);
+  mAuthors->sortByColumn(Commits, Qt::DescendingOrder);
+
+  mStatus = new QLabel(this);
+
+  QDialogButtonBox *buttons = new QDialogButtonBox(this);
+  buttons->addButton(QDialogButtonBox::Close);
+  connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addLayout(form);
+  layout->addWidget(mAuthors, 1);
+  layout->addWidget(mStatus);
+  layout->addWidget(buttons);
+
+  // Refresh as new commits are counted.
+  connect(mStatistics, &Statistics::updated, this,
+          &ContributorsDialog::updateAuthors);
+  mStatistics->update();
+  updateAuthors();
+
+  resize(640, 480);
+}
+
+void ContributorsDialog::updateAuthors() {
+  mAuthors->setSortingEnabled(false);
+  mAuthors->clear();
+
+  QList<Statistics::Author> authors = mStatistics->authors(mPath->text());
+  foreach (const Statistics::Author &author, authors)
+    new Item(author, mAuthors);
+
+  mAuthors->setSortingEnabled(true);
+
+  QString text = tr("%1 authors").arg(authors.size());
+  if (mStatistics->isRunning())
+    text = tr("Counting commits... %1").arg(text);
+  mStatus->setText(text);
+}
@@ -0,0 +1,36 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef CONTRIBUTORSDIALOG_H
+#define CONTRIBUTORSDIALOG_H
+
+#include <QDialog>
+
+class QLabel;
+class QLineEdit;
+class QTreeWidget;
+class RepoView;
+class Statistics;
+
+// Lists the authors of changes under a directory.
+class ContributorsDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  ContributorsDialog(RepoView *parent, const QString &path = QString());
+
+private:
+  void updateAuthors();
+
+  Statistics *mStatistics;
+
+  QLineEdit *mPath;
+  QTreeWidget *mAuthors;
+  QLabel *mStatus;
+};
+
+#endif
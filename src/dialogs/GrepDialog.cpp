@@ -0,0 +1,144 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "GrepDialog.h"
+#include "git/Blob.h"
+#include "git/Repository.h"
+#include "git/Tree.h"
+#include "index/TrigramIndex.h"
+#include "ui/RepoView.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+const int kLineRole = Qt::UserRole;
+
+} // namespace
+
+GrepDialog::GrepDialog(const git::Commit &commit, RepoView *parent)
+    : QDialog(parent), mCommit(commit) {
+  setAttribute(Qt::WA_DeleteOnClose);
+  setWindowTitle(tr("Find in Tree - %1").arg(commit.shortId()));
+
+  mPattern = new QLineEdit(this);
+  mPattern->setPlaceholderText(tr("Search text"));
+
+  mRegex = new QCheckBox(tr("Regular expression"), this);
+  mCaseSensitive = new QCheckBox(tr("Case sensitive"), this);
+
+  mField = new QComboBox(this);
+  mField->addItem(tr("Anywhere"), Grep::AnyField);
+  mField->addItem(tr("Code"), Grep::Code);
+  mField->addItem(tr("Comments"), Grep::Comments);
+  mField->addItem(tr("Strings"), Grep::Strings);
+
+  QHBoxLayout *options = new QHBoxLayout;
+  options->addWidget(mRegex);
+  options->addWidget(mCaseSensitive);
+  options->addStretch();
+
+  QFormLayout *form = new QFormLayout;
+  form->addRow(tr("Find:"), mPattern);
+  form->addRow(tr("Options:"), options);
+  form->addRow(tr("Match in:"), mField);
+
+  mResults = new QTreeWidget(this);
+  mResults->setHeaderHidden(true);
+  mResults->setUniformRowHeights(true);
+  mResults->setColumnCount(1);
+
+  mStatus = new QLabel(this);
+
+  QDialogButtonBox *buttons = new QDialogButtonBox(this);
+  buttons->addButton(QDialogButtonBox::Close);
+  QPushButton *find =
+      buttons->addButton(tr("Find"), QDialogButtonBox::ActionRole);
+  find->setDefault(true);
+  find->setEnabled(false);
+  connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+  connect(find, &QPushButton::clicked, this, &GrepDialog::search);
+
+  connect(mPattern, &QLineEdit::textChanged, [find](const QString &text) {
+    find->setEnabled(!text.isEmpty());
+  });
+
+  mGrep = new Grep(this);
+  connect(mGrep, &Grep::matchesFound, this, &GrepDialog::addMatches);
+  connect(mGrep, &Grep::finished, this, &GrepDialog::updateStatus);
+
+  // Open the blob at the matching line.
+  connect(mResults, &QTreeWidget::itemActivated,
+          [this, parent](QTreeWidgetItem *item) {
+            QVariant line = item->data(0, kLineRole);
+            if (!line.isValid())
+              return;
+
+            QString path = item->parent()->text(0);
+            git::Id id = mCommit.tree().id(path);
+            git::Blob blob = mCommit.repo().lookupBlob(id);
+            parent->openEditor(path, line.toInt(), blob, mCommit);
+          });
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addLayout(form);
+  layout->addWidget(mResults, 1);
+  layout->addWidget(mStatus);
+  layout->addWidget(buttons);
+
+  resize(640, 480);
+}
+
+void GrepDialog::search() {
+  mResults->clear();
+  mFiles.clear();
+  mCount = 0;
+
+  Grep::Options options;
+  options.pattern = mPattern->text();
+  options.regex = mRegex->isChecked();
+  options.caseSensitive = mCaseSensitive->isChecked();
+  options.field = static_cast<Grep::Field>(mField->currentData().toInt());
+
+  RepoView *view = static_cast<RepoView *>(parentWidget());
+  mGrep->start(mCommit.tree(), options, view->trigramIndex());
+  updateStatus();
+}
+
+void GrepDialog::addMatches(const QList<Grep::Match> &matches) {
+  foreach (const Grep::Match &match, matches) {
+    QTreeWidgetItem *file = mFiles.value(match.path);
+    if (!file) {
+      file = new QTreeWidgetItem(mResults, {match.path});
+      file->setExpanded(true);
+      mFiles.insert(match.path, file);
+    }
+
+    QString text = QString("%1: %2").arg(match.line).arg(match.text.trimmed());
+    QTreeWidgetItem *item = new QTreeWidgetItem(file, {text});
+    item->setData(0, kLineRole, match.line);
+  }
+
+  mCount += matches.size();
+  updateStatus();
+}
+
+void GrepDialog::updateStatus() {
+  QString text = tr("%1 matches in %2 files").arg(mCount).arg(mFiles.size());
+  if (mGrep->isRunning())
+    text = tr("Searching... %1").arg(text);
+  mStatus->setText(text);
+}
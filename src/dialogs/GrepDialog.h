@@ -0,0 +1,49 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef GREPDIALOG_H
+#define GREPDIALOG_H
+
+#include "git/Commit.h"
+#include "index/Grep.h"
+#include <QDialog>
+#include <QHash>
+
+class RepoView;
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// Searches the content of a commit's tree and lists matching lines.
+class GrepDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  GrepDialog(const git::Commit &commit, RepoView *parent);
+
+private:
+  void search();
+  void addMatches(const QList<Grep::Match> &matches);
+  void updateStatus();
+
+  git::Commit mCommit;
+  Grep *mGrep;
+  int mCount = 0;
+  QHash<QString, QTreeWidgetItem *> mFiles;
+
+  QLineEdit *mPattern;
+  QCheckBox *mRegex;
+  QCheckBox *mCaseSensitive;
+  QComboBox *mField;
+  QTreeWidget *mResults;
+  QLabel *mStatus;
+};
+
+#endif
@@ -14,9 +14,11 @@
 #include <QCheckBox>
 #include <QDialogButtonBox>
 #include <QFormLayout>
+#include <QFutureWatcher>
 #include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 
 namespace {
 
@@ -25,6 +27,9 @@ const ReferenceView::Kinds kRefKinds =
     ReferenceView::RemoteBranches | ReferenceView::Tags |
     ReferenceView::ExcludeHead;
 
+// Maximum number of conflicting paths listed in the preview.
+const int kPreviewConflicts = 5;
+
 } // namespace
 
 MergeDialog::MergeDialog(RepoView::MergeFlags flags,
@@ -68,14 +73,19 @@ MergeDialog::MergeDialog(RepoView::MergeFlags flags,
     label->setText(labelText());
     mAccept->setText(buttonText());
     noCommit->setVisible(merge && !ffonly);
+    updatePreview();
   });
 
+  mPreview = new QLabel(this);
+  mPreview->setWordWrap(true);
+
   QFormLayout *form = new QFormLayout;
   form->setFieldGrowthPolicy(QFormLayout::AllNonFixedFieldsGrow);
   form->addRow(label);
   form->addRow(tr("Reference:"), mRefs);
   form->addRow(tr("Action:"), mAction);
   form->addRow(QString(), noCommit);
+  form->addRow(mPreview);
 
   QDialogButtonBox *buttons = new QDialogButtonBox(this);
   buttons->addButton(QDialogButtonBox::Cancel);
@@ -116,7 +126,74 @@ void MergeDialog::setReference(const git::Reference &ref) {
   update();
 }
 
-void MergeDialog::update() { mAccept->setEnabled(mRefs->target().isValid()); }
+void MergeDialog::update() {
+  mAccept->setEnabled(mRefs->target().isValid());
+  updatePreview();
+}
+
+void MergeDialog::updatePreview() {
+  git::Commit theirs = mRefs->target();
+  git::Reference head = mRepo.head();
+  if (!theirs.isValid() || !head.isValid() || (flags() & RepoView::Rebase)) {
+    mPreviewOurs = git::Id();
+    mPreviewTheirs = git::Id();
+    mPreview->clear();
+    return;
+  }
+
+  git::Commit ours = head.target();
+  if (ours.id() == mPreviewOurs && theirs.id() == mPreviewTheirs)
+    return;
+
+  mPreviewOurs = ours.id();
+  mPreviewTheirs = theirs.id();
+  mPreview->setText(tr("Checking for conflicts..."));
+
+  // Merge the trees in the background.
+  using Watcher = QFutureWatcher<git::Repository::MergePreview>;
+  Watcher *watcher = new Watcher(this);
+  connect(watcher, &Watcher::finished, this, [this, watcher, ours, theirs] {
+    // Ignore results for a pair that's no longer selected.
+    if (ours.id() == mPreviewOurs && theirs.id() == mPreviewTheirs)
+      setPreview(watcher->result());
+    watcher->deleteLater();
+  });
+
+  git::Repository repo = mRepo;
+  watcher->setFuture(QtConcurrent::run(
+      [repo, ours, theirs] { return repo.mergePreview(ours, theirs); }));
+}
+
+void MergeDialog::setPreview(const git::Repository::MergePreview &preview) {
+  if (!preview.valid) {
+    mPreview->setText(tr("Unable to check for conflicts."));
+    return;
+  }
+
+  if (preview.upToDate) {
+    mPreview->setText(tr("Already up-to-date."));
+    return;
+  }
+
+  QString stats = tr("%1 files changed, %2 insertions(+), %3 deletions(-)")
+                      .arg(preview.files)
+                      .arg(preview.additions)
+                      .arg(preview.deletions);
+
+  if (preview.conflicts.isEmpty()) {
+    QString fmt = preview.fastForward ? tr("Fast-forward: %1")
+                                      : tr("No conflicts: %1");
+    mPreview->setText(fmt.arg(stats));
+    return;
+  }
+
+  QStringList paths = preview.conflicts.mid(0, kPreviewConflicts);
+  if (preview.conflicts.size() > kPreviewConflicts)
+    paths.append("...");
+
+  QString fmt = tr("%1 conflicting files: %2");
+  mPreview->setText(fmt.arg(preview.conflicts.size()).arg(paths.join(", ")));
+}
 
 QString MergeDialog::labelText() const {
   QString fmt;
@@ -16,6 +16,7 @@
 
 class ReferenceList;
 class QComboBox;
+class QLabel;
 class QPushButton;
 
 namespace git {
@@ -38,6 +39,8 @@ public:
 
 private:
   void update();
+  void updatePreview();
+  void setPreview(const git::Repository::MergePreview &preview);
   QString labelText() const;
   QString buttonText() const;
 
@@ -45,6 +48,11 @@ private:
   QPushButton *mAccept;
   ReferenceList *mRefs;
   QComboBox *mAction;
+  QLabel *mPreview;
+
+  // The pair that the pending preview belongs to.
+  git::Id mPreviewOurs;
+  git::Id mPreviewTheirs;
 };
 
 #endif
@@ -105,6 +105,8 @@ public:
     mPullUpdate =
         new QCheckBox(tr("Update submodules after pull and clone"), this);
     mAutoPrune = new QCheckBox(tr("Prune when fetching"), this);
+    mRebaseInMemory = new QCheckBox(
+        tr("Rebase in memory and update the working directory once"), this);
     mNoTranslation = new QCheckBox(tr("No translation"), this);
     mLanguages = new QComboBox(this);
 
@@ -130,6 +132,7 @@ public:
     form->addRow(QString(), mPushCommit);
     form->addRow(QString(), mPullUpdate);
     form->addRow(QString(), mAutoPrune);
+    form->addRow(QString(), mRebaseInMemory);
     form->addRow(tr("Language:"), mNoTranslation);
     form->addRow(tr("Language:"), mLanguages);
     form->addRow(tr("Credentials:"), mStoreCredentials);
@@ -189,6 +192,10 @@ public:
       Settings::instance()->setValue(Setting::Id::PruneAfterFetch, checked);
     });
 
+    connect(mRebaseInMemory, &QCheckBox::toggled, [](bool checked) {
+      Settings::instance()->setValue(Setting::Id::RebaseInMemory, checked);
+    });
+
     connect(mNoTranslation, &QCheckBox::toggled, [](bool checked) {
       Settings::instance()->setValue(Setting::Id::DontTranslate, checked);
     });
@@ -245,6 +252,8 @@ public:
             .toBool());
     mAutoPrune->setChecked(
         settings->value(Setting::Id::PruneAfterFetch).toBool());
+    mRebaseInMemory->setChecked(
+        settings->value(Setting::Id::RebaseInMemory).toBool());
 
     mNoTranslation->setChecked(
         settings->value(Setting::Id::DontTranslate).toBool());
@@ -281,6 +290,7 @@ private:
   QCheckBox *mPushCommit;
   QCheckBox *mPullUpdate;
   QCheckBox *mAutoPrune;
+  QCheckBox *mRebaseInMemory;
   QCheckBox *mNoTranslation;
   QComboBox *mLanguages;
   QCheckBox *mStoreCredentials;
@@ -28,6 +28,7 @@ private:
   operator git_blob *() const;
 
   friend class Diff;
+  friend class FilterList;
   friend class Patch;
   friend class Repository;
 };
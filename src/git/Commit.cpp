@@ -9,6 +9,7 @@
 
 #include "Commit.h"
 #include "Diff.h"
+#include "IdHash.h"
 #include "Patch.h"
 #include "Reference.h"
 #include "Repository.h"
@@ -66,7 +67,7 @@ QString Commit::message(MessageOptions options) const {
 
 QString Commit::description() const {
   // Build list of candidates.
-  QHash<Id, TagRef> candidates;
+  IdMap<TagRef> candidates;
   foreach (const TagRef &tag, repo().tags()) {
     if (Commit commit = tag.target())
       candidates.insert(commit.id(), tag);
@@ -76,24 +77,25 @@ QString Commit::description() const {
     return QString();
 
   // Check for exact match.
-  auto it = candidates.constFind(id());
-  if (it != candidates.constEnd())
-    return it->name();
+  if (const TagRef *tag = candidates.find(id()))
+    return tag->name();
 
   // Walk parents.
   QList<Commit> commits = parents();
   while (!commits.isEmpty()) {
-    QSet<Commit> parents;
+    IdSet ids;
+    QList<Commit> parents;
     foreach (const Commit &commit, commits) {
-      auto it = candidates.constFind(commit.id());
-      if (it != candidates.constEnd())
-        return QString("%1 +%2").arg(it->name()).arg(difference(commit));
+      if (const TagRef *tag = candidates.find(commit.id()))
+        return QString("%1 +%2").arg(tag->name()).arg(difference(commit));
 
-      foreach (const Commit &parent, commit.parents())
-        parents.insert(parent);
+      foreach (const Commit &parent, commit.parents()) {
+        if (ids.insert(parent.id()))
+          parents.append(parent);
+      }
     }
 
-    commits = parents.values();
+    commits = parents;
   }
 
   return QString();
@@ -124,7 +126,7 @@ Signature Commit::committer() const {
 }
 
 Diff Commit::diff(const git::Commit &commit, int contextLines,
-                  bool ignoreWhitespace) const {
+                  bool ignoreWhitespace, qint64 maxSize) const {
   Tree old;
   if (commit.isValid()) {
     old = commit.tree();
@@ -139,6 +141,8 @@ Diff Commit::diff(const git::Commit &commit, int contextLines,
   opts.flags |= GIT_DIFF_INCLUDE_TYPECHANGE;
   if (ignoreWhitespace)
     opts.flags |= GIT_DIFF_IGNORE_WHITESPACE;
+  if (maxSize > 0)
+    opts.max_size = maxSize;
 
   git_diff *diff = nullptr;
   git_repository *repo = git_object_owner(d.data());
@@ -176,27 +180,12 @@ QList<Reference> Commit::refs() const {
       refs.append(head);
   }
 
-  // Iterate over references.
-  git_reference_iterator *it = nullptr;
-  if (git_reference_iterator_new(&it, repo))
-    return QList<Reference>();
-
-  git_reference *ref = nullptr;
-  const git_oid *id = git_object_id(d.data());
-  while (!git_reference_next(&ref, it)) {
-    git_object *obj = nullptr;
-    if (!git_reference_peel(&obj, ref, GIT_OBJECT_COMMIT) &&
-        git_oid_equal(git_object_id(obj), id)) {
-      refs.append(Reference(ref));
-    } else {
-      git_reference_free(ref);
-    }
-
-    git_object_free(obj);
+  // Look up the references that peel to this commit.
+  foreach (const RefSnapshot::Entry &entry, repo.refSnapshot().entries(id())) {
+    if (Reference ref = repo.lookupRef(QString::fromUtf8(entry.name)))
+      refs.append(ref);
   }
 
-  git_reference_iterator_free(it);
-
   return refs;
 }
 
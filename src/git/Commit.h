@@ -47,8 +47,10 @@ public:
   Signature author() const;
   Signature committer() const;
 
+  // Blobs larger than maxSize are treated as binary without loading
+  // their content. Zero uses the libgit2 default.
   Diff diff(const Commit &commit = git::Commit(), int contextLines = -1,
-            bool ignoreWhitespace = false) const;
+            bool ignoreWhitespace = false, qint64 maxSize = 0) const;
   Tree tree() const;
   QList<Commit> parents() const;
 
@@ -95,6 +97,7 @@ private:
 
   friend class Blame;
   friend class AnnotatedCommit;
+  friend class Identities;
   friend class Rebase;
   friend class Reference;
   friend class Repository;
@@ -44,10 +44,12 @@ template <> QString Config::Entry::value<QString>() const {
   return (isValid() && d.data()->value) ? d.data()->value : QString();
 }
 
-Config::Iterator::Iterator(git_config_iterator *iterator)
-    : d(iterator, git_config_iterator_free) {}
+Config::Iterator::Iterator(git_config_iterator *iterator,
+                           const QSharedPointer<QMutex> &lock)
+    : d(iterator, git_config_iterator_free), mLock(lock) {}
 
 Config::Entry Config::Iterator::next() const {
+  QMutexLocker locker(mLock.data());
   git_config_entry *entry = nullptr;
   if (!isValid() || git_config_next(&entry, d.data()))
     return Config::Entry();
@@ -57,8 +59,11 @@ Config::Entry Config::Iterator::next() const {
 
 Config::Config(git_config *config) : d(config, git_config_free) {}
 
+void Config::setShared() { mLock.reset(new QMutex); }
+
 bool Config::addFile(const QString &path, git_config_level_t level,
                      const Repository &repo) {
+  QMutexLocker locker(mLock.data());
   git_repository *ptr =
       repo.isValid() ? static_cast<git_repository *>(repo) : nullptr;
   return !git_config_add_file_ondisk(d.data(), path.toUtf8(), level, ptr,
@@ -67,6 +72,7 @@ bool Config::addFile(const QString &path, git_config_level_t level,
 
 template <>
 bool Config::value<bool>(const QString &key, const bool &defaultValue) const {
+  QMutexLocker locker(mLock.data());
   int value = defaultValue;
   if (isValid()) {
     git_config_get_bool(&value, d.data(), key.toUtf8());
@@ -75,6 +81,7 @@ bool Config::value<bool>(const QString &key, const bool &defaultValue) const {
 }
 
 template <> void Config::setValue<bool>(const QString &key, const bool &value) {
+  QMutexLocker locker(mLock.data());
   if (isValid()) {
     git_config_set_bool(d.data(), key.toUtf8(), value);
   }
@@ -82,6 +89,7 @@ template <> void Config::setValue<bool>(const QString &key, const bool &value) {
 
 template <>
 int Config::value<int>(const QString &key, const int &defaultValue) const {
+  QMutexLocker locker(mLock.data());
   int value = defaultValue;
   if (isValid()) {
     git_config_get_int32(&value, d.data(), key.toUtf8());
@@ -90,6 +98,7 @@ int Config::value<int>(const QString &key, const int &defaultValue) const {
 }
 
 template <> void Config::setValue<int>(const QString &key, const int &value) {
+  QMutexLocker locker(mLock.data());
   if (isValid()) {
     git_config_set_int32(d.data(), key.toUtf8(), value);
   }
@@ -98,6 +107,7 @@ template <> void Config::setValue<int>(const QString &key, const int &value) {
 template <>
 QString Config::value<QString>(const QString &key,
                                const QString &defaultValue) const {
+  QMutexLocker locker(mLock.data());
   if (!isValid()) {
     return defaultValue;
   }
@@ -111,17 +121,20 @@ QString Config::value<QString>(const QString &key,
 
 template <>
 void Config::setValue<QString>(const QString &key, const QString &value) {
+  QMutexLocker locker(mLock.data());
   if (isValid()) {
     git_config_set_string(d.data(), key.toUtf8(), value.toUtf8());
   }
 }
 
 bool Config::remove(const QString &key) {
+  QMutexLocker locker(mLock.data());
   return isValid() && !git_config_delete_entry(d.data(), key.toUtf8());
 }
 
 QStringList Config::value(const QString &key, const QString &regexp,
                           const QStringList &defaultValue) const {
+  QMutexLocker locker(mLock.data());
   if (!isValid()) {
     return defaultValue;
   }
@@ -148,6 +161,7 @@ QStringList Config::value(const QString &key, const QString &regexp,
 
 void Config::setValue(const QString &key, const QString regexp,
                       const QString &value) {
+  QMutexLocker locker(mLock.data());
   if (isValid()) {
     git_config_set_multivar(d.data(), key.toUtf8(), regexp.toUtf8(),
                             value.toUtf8());
@@ -155,16 +169,18 @@ void Config::setValue(const QString &key, const QString regexp,
 }
 
 bool Config::remove(const QString &key, const QString regexp) {
+  QMutexLocker locker(mLock.data());
   return isValid() && git_config_delete_multivar(d.data(), key.toUtf8(),
                                                  regexp.toUtf8()) >= 0;
 }
 
 Config::Iterator Config::glob(const QString &pattern) const {
+  QMutexLocker locker(mLock.data());
   git_config_iterator *iterator = nullptr;
   if (isValid()) {
     git_config_iterator_glob_new(&iterator, d.data(), pattern.toUtf8());
   }
-  return Iterator(iterator);
+  return Iterator(iterator, mLock);
 }
 
 Config Config::global() {
@@ -190,6 +206,12 @@ QString Config::globalPath() {
   return path;
 }
 
+QString Config::appGlobalPath() {
+  QDir dir =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+  return dir.filePath(kConfigFile);
+}
+
 Config Config::appGlobal() {
   git_config *config = nullptr;
   if (git_config_new(&config))
@@ -202,7 +224,7 @@ Config Config::appGlobal() {
   if (!dir.exists())
     dir.mkpath(dir.path());
 
-  QByteArray path = dir.filePath(kConfigFile).toUtf8();
+  QByteArray path = appGlobalPath().toUtf8();
   if (git_config_add_file_ondisk(config, path, GIT_CONFIG_LEVEL_GLOBAL, nullptr,
                                  0)) {
     git_config_free(config);
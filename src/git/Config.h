@@ -12,6 +12,7 @@
 
 #include "Repository.h"
 #include "git2/config.h"
+#include <QMutex>
 #include <QSharedPointer>
 
 namespace git {
@@ -37,6 +38,8 @@ public:
     friend class Iterator;
   };
 
+  // Entries returned by a shared config's iterator are only valid
+  // until the next write to it.
   class Iterator {
   public:
     bool isValid() const { return !d.isNull(); }
@@ -44,9 +47,11 @@ public:
     Entry next() const;
 
   private:
-    Iterator(git_config_iterator *iterator = nullptr);
+    Iterator(git_config_iterator *iterator = nullptr,
+             const QSharedPointer<QMutex> &lock = QSharedPointer<QMutex>());
 
     QSharedPointer<git_config_iterator> d;
+    QSharedPointer<QMutex> mLock;
 
     friend class Config;
   };
@@ -77,13 +82,19 @@ public:
   static QString globalPath();
 
   static Config appGlobal();
+  static QString appGlobalPath();
 
   static Config open(const QString &path);
 
 private:
   Config(git_config *config = nullptr);
 
+  // Serialize every access to a config that's shared between threads.
+  // libgit2 config objects aren't safe for concurrent use.
+  void setShared();
+
   QSharedPointer<git_config> d;
+  QSharedPointer<QMutex> mLock;
 
   friend class Repository;
 };
@@ -35,6 +35,58 @@ int Diff::Callbacks::progress(const git_diff *diff, const char *oldPath,
   return cbs->progress(oldPath, newPath) ? 0 : -1;
 }
 
+namespace {
+
+// The file callback is deferred until the content of the delta has been
+// loaded. Its binary flag isn't known before that.
+struct VisitState {
+  Diff::Visitor *visitor;
+  const git_diff_delta *delta;
+};
+
+bool flush(VisitState *state) {
+  const git_diff_delta *delta = state->delta;
+  if (!delta)
+    return true;
+
+  state->delta = nullptr;
+  bool binary = (delta->flags & GIT_DIFF_FLAG_BINARY);
+  return state->visitor->file(delta->new_file.path, binary);
+}
+
+int visitFile(const git_diff_delta *delta, float progress, void *payload) {
+  VisitState *state = reinterpret_cast<VisitState *>(payload);
+  if (!flush(state))
+    return GIT_EUSER;
+
+  state->delta = delta;
+  return 0;
+}
+
+int visitBinary(const git_diff_delta *delta, const git_diff_binary *binary,
+                void *payload) {
+  return flush(reinterpret_cast<VisitState *>(payload)) ? 0 : GIT_EUSER;
+}
+
+int visitHunk(const git_diff_delta *delta, const git_diff_hunk *hunk,
+              void *payload) {
+  VisitState *state = reinterpret_cast<VisitState *>(payload);
+  if (!flush(state))
+    return GIT_EUSER;
+
+  QByteArray header(hunk->header, hunk->header_len);
+  return state->visitor->hunk(header) ? 0 : GIT_EUSER;
+}
+
+int visitLine(const git_diff_delta *delta, const git_diff_hunk *hunk,
+              const git_diff_line *line, void *payload) {
+  VisitState *state = reinterpret_cast<VisitState *>(payload);
+  QByteArray content(line->content, line->content_len);
+  return state->visitor->line(line->origin, content) ? 0 : GIT_EUSER;
+}
+
+} // namespace
+
 Diff::Data::Data(git_diff *diff) : diff(diff) { resetMap(); }
 
 Diff::Data::~Data() { git_diff_free(diff); }
@@ -142,6 +194,16 @@ Patch Diff::patch(int index) const {
 
 QString Diff::name(int index) const { return d->delta(index)->new_file.path; }
 
+bool Diff::visit(Visitor &visitor) const {
+  // Binary content isn't generated without GIT_DIFF_SHOW_BINARY.
+  VisitState state = {&visitor, nullptr};
+  if (git_diff_foreach(d->diff, &visitFile, &visitBinary, &visitHunk,
+                       &visitLine, &state))
+    return false;
+
+  return flush(&state);
+}
+
 bool Diff::isBinary(int index) const {
   return d->delta(index)->flags & GIT_DIFF_FLAG_BINARY;
 }
@@ -51,6 +51,16 @@ public:
                         const char *newPath, void *payload);
   };
 
+  // Receives content as it's generated. Return false from any callback
+  // to stop. Binary files, including blobs over the size limit of the
+  // diff, only get a file callback. Their content isn't loaded.
+  class Visitor {
+  public:
+    virtual bool file(const QString &path, bool binary) { return true; }
+    virtual bool hunk(const QByteArray &header) { return true; }
+    virtual bool line(char origin, const QByteArray &content) { return true; }
+  };
+
   Diff();
   /*!
    * Writes the complete diff into an array.
@@ -75,6 +85,10 @@ public:
 
   int indexOf(const QString &name) const;
 
+  // Stream the content without generating patches. Returns
+  // false if the visitor stopped early or an error occurred.
+  bool visit(Visitor &visitor) const;
+
   // Merge the given diff into this diff.
   void merge(const Diff &diff);
 
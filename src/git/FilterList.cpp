@@ -8,12 +8,26 @@
 //
 
 #include "FilterList.h"
+#include "Blob.h"
 
 namespace git {
 
 FilterList::FilterList(git_filter_list *filter)
     : d(filter, git_filter_list_free) {}
 
+QByteArray FilterList::apply(const Blob &blob) const {
+  if (!isValid())
+    return blob.content();
+
+  git_buf out = GIT_BUF_INIT_CONST(nullptr, 0);
+  if (git_filter_list_apply_to_blob(&out, d.data(), blob))
+    return QByteArray();
+
+  QByteArray result(out.ptr, out.size);
+  git_buf_dispose(&out);
+  return result;
+}
+
 FilterList::operator git_filter_list *() const { return d.data(); }
 
 } // namespace git
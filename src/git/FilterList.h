@@ -11,14 +11,20 @@
 #define FILTERLIST_H
 
 #include "git2/filter.h"
+#include <QByteArray>
 #include <QSharedPointer>
 
 namespace git {
 
+class Blob;
+
 class FilterList {
 public:
   bool isValid() const { return !d.isNull(); }
 
+  // Apply the filters to the blob content.
+  QByteArray apply(const Blob &blob) const;
+
 private:
   FilterList(git_filter_list *filter = nullptr);
   operator git_filter_list *() const;
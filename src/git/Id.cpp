@@ -56,6 +56,11 @@ bool Id::operator!=(const Id &rhs) const { return !git_oid_equal(&d, rhs); }
 
 Id Id::invalidId() { return kInvalidId; }
 
-uint qHash(const Id &key) { return qHash(key.toByteArray()); }
+uint qHash(const Id &key, uint seed) {
+  // Object ids are uniformly distributed. Use the leading bytes directly.
+  uint hash;
+  memcpy(&hash, key.d.id, sizeof(hash));
+  return hash ^ seed;
+}
 
 } // namespace git
@@ -16,6 +16,10 @@
 
 namespace git {
 
+class Id;
+
+uint qHash(const Id &key, uint seed = 0);
+
 class Id {
 public:
   Id();
@@ -41,11 +45,12 @@ private:
   git_oid d;
 
   friend class Index;
+  friend class ReferenceCatalog;
   friend class Repository;
+  friend class RevWalk;
+  friend uint qHash(const Id &key, uint seed);
 };
 
-uint qHash(const Id &key);
-
 } // namespace git
 
 Q_DECLARE_METATYPE(git::Id);
@@ -0,0 +1,209 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+// Author: Jason Haslam
+//
+
+#ifndef GIT_IDHASH_H
+#define GIT_IDHASH_H
+
+#include "Id.h"
+#include <QList>
+#include <QVector>
+
+namespace git {
+
+// Flat hash map keyed by object id. Entries are stored densely in
+// insertion order and indexed by an open-addressing table of slots with
+// linear probing. Ids are already uniformly distributed, so the hash is
+// just the leading bytes of the raw oid and lookups never allocate.
+template <typename T> class IdMap {
+public:
+  struct Entry {
+    Id key;
+    T value;
+  };
+
+  typedef typename QVector<Entry>::const_iterator const_iterator;
+
+  IdMap() {}
+  explicit IdMap(int size) { reserve(size); }
+
+  int size() const { return mEntries.size(); }
+  bool isEmpty() const { return mEntries.isEmpty(); }
+
+  const_iterator begin() const { return mEntries.constBegin(); }
+  const_iterator end() const { return mEntries.constEnd(); }
+
+  void clear() {
+    mEntries.clear();
+    mSlots.clear();
+  }
+
+  void reserve(int size) {
+    mEntries.reserve(size);
+    if (size * 2 > mSlots.size())
+      rehash(size * 2);
+  }
+
+  bool contains(const Id &key) const { return slot(key) >= 0; }
+
+  // Returns a pointer to the value or nullptr if the key is missing.
+  // The pointer is invalidated by the next insertion or removal.
+  const T *find(const Id &key) const {
+    int index = slot(key);
+    return (index >= 0) ? &mEntries.at(mSlots.at(index) - 1).value : nullptr;
+  }
+
+  T value(const Id &key, const T &defaultValue = T()) const {
+    const T *value = find(key);
+    return value ? *value : defaultValue;
+  }
+
+  T &operator[](const Id &key) {
+    int index = slot(key);
+    if (index < 0)
+      index = add(key, T());
+    return mEntries[mSlots.at(index) - 1].value;
+  }
+
+  // Insert or replace the value. Returns true if the key is new.
+  bool insert(const Id &key, const T &value) {
+    int index = slot(key);
+    if (index >= 0) {
+      mEntries[mSlots.at(index) - 1].value = value;
+      return false;
+    }
+
+    add(key, value);
+    return true;
+  }
+
+  bool remove(const Id &key) {
+    int index = slot(key);
+    if (index < 0)
+      return false;
+
+    int entry = mSlots.at(index) - 1;
+    unlink(index);
+
+    // Move the last entry into the hole.
+    int last = mEntries.size() - 1;
+    if (entry != last) {
+      mSlots[slot(mEntries.at(last).key)] = entry + 1;
+      mEntries[entry] = mEntries.at(last);
+    }
+
+    mEntries.removeLast();
+    return true;
+  }
+
+  QList<Id> keys() const {
+    QList<Id> keys;
+    keys.reserve(mEntries.size());
+    foreach (const Entry &entry, mEntries)
+      keys.append(entry.key);
+    return keys;
+  }
+
+private:
+  int home(const Id &key) const { return qHash(key) & (mSlots.size() - 1); }
+
+  // Returns the slot that holds the key or -1.
+  int slot(const Id &key) const {
+    if (mSlots.isEmpty())
+      return -1;
+
+    int mask = mSlots.size() - 1;
+    for (int i = home(key);; i = (i + 1) & mask) {
+      int entry = mSlots.at(i);
+      if (!entry)
+        return -1;
+      if (mEntries.at(entry - 1).key == key)
+        return i;
+    }
+  }
+
+  // Append a new entry and return its slot.
+  int add(const Id &key, const T &value) {
+    // Keep the load factor at or below one half.
+    if ((mEntries.size() + 1) * 2 > mSlots.size())
+      rehash((mEntries.size() + 1) * 2);
+
+    mEntries.append({key, value});
+
+    int mask = mSlots.size() - 1;
+    int i = home(key);
+    while (mSlots.at(i))
+      i = (i + 1) & mask;
+
+    mSlots[i] = mEntries.size();
+    return i;
+  }
+
+  // Clear a slot and shift later members of its probe run back.
+  void unlink(int index) {
+    int mask = mSlots.size() - 1;
+    int hole = index;
+    for (int i = (index + 1) & mask; mSlots.at(i); i = (i + 1) & mask) {
+      int target = home(mEntries.at(mSlots.at(i) - 1).key);
+      bool movable = (hole <= i) ? (target <= hole || target > i)
+                                 : (target <= hole && target > i);
+      if (movable) {
+        mSlots[hole] = mSlots.at(i);
+        hole = i;
+      }
+    }
+
+    mSlots[hole] = 0;
+  }
+
+  void rehash(int size) {
+    int capacity = 16;
+    while (capacity < size)
+      capacity *= 2;
+
+    mSlots.fill(0, capacity);
+
+    int mask = capacity - 1;
+    for (int entry = 0; entry < mEntries.size(); ++entry) {
+      int i = home(mEntries.at(entry).key);
+      while (mSlots.at(i))
+        i = (i + 1) & mask;
+      mSlots[i] = entry + 1;
+    }
+  }
+
+  QVector<Entry> mEntries;
+  QVector<int> mSlots;
+};
+
+class IdSet {
+public:
+  IdSet() {}
+  explicit IdSet(int size) : mMap(size) {}
+
+  int size() const { return mMap.size(); }
+  bool isEmpty() const { return mMap.isEmpty(); }
+
+  void clear() { mMap.clear(); }
+  void reserve(int size) { mMap.reserve(size); }
+
+  bool contains(const Id &id) const { return mMap.contains(id); }
+
+  // Returns true if the id wasn't already in the set.
+  bool insert(const Id &id) { return mMap.insert(id, true); }
+  bool remove(const Id &id) { return mMap.remove(id); }
+
+  QList<Id> values() const { return mMap.keys(); }
+
+private:
+  IdMap<bool> mMap;
+};
+
+} // namespace git
+
+#endif
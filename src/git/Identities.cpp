@@ -0,0 +1,99 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Identities.h"
+#include "Commit.h"
+#include "Signature.h"
+#include "git2/commit.h"
+#include <QRegularExpression>
+#include <cstring>
+
+namespace git {
+
+namespace {
+
+const QRegularExpression kWsRe("\\s+");
+
+QByteArray rawData(const char *str) {
+  return QByteArray::fromRawData(str, str ? strlen(str) : 0);
+}
+
+} // namespace
+
+Identities::Identities(git_repository *repo) {
+  git_mailmap_from_repository(&mMailmap, repo);
+  mIdentities.append(Identity());
+}
+
+Identities::~Identities() { git_mailmap_free(mMailmap); }
+
+int Identities::count() const {
+  QReadLocker locker(&mLock);
+  return mIdentities.size();
+}
+
+quint32 Identities::intern(const Signature &signature) {
+  return intern(static_cast<const git_signature *>(signature));
+}
+
+quint32 Identities::author(const Commit &commit) {
+  return intern(git_commit_author(commit));
+}
+
+quint32 Identities::committer(const Commit &commit) {
+  return intern(git_commit_committer(commit));
+}
+
+Identities::Identity Identities::identity(quint32 id) const {
+  QReadLocker locker(&mLock);
+  return (id < static_cast<quint32>(mIdentities.size())) ? mIdentities.at(id)
+                                                          : Identity();
+}
+
+quint32 Identities::intern(const git_signature *signature) {
+  if (!signature)
+    return 0;
+
+  // Look up without copying the strings.
+  Key raw(rawData(signature->name), rawData(signature->email));
+  {
+    QReadLocker locker(&mLock);
+    auto it = mRaw.constFind(raw);
+    if (it != mRaw.constEnd())
+      return it.value();
+  }
+
+  QWriteLocker locker(&mLock);
+  auto it = mRaw.constFind(raw);
+  if (it != mRaw.constEnd())
+    return it.value();
+
+  const char *name = signature->name;
+  const char *email = signature->email;
+  if (mMailmap)
+    git_mailmap_resolve(&name, &email, mMailmap, name, email);
+
+  Key resolved(name, email);
+  quint32 id = mResolved.value(resolved, mIdentities.size());
+  if (id == static_cast<quint32>(mIdentities.size())) {
+    Identity identity;
+    identity.name = QString::fromUtf8(resolved.first);
+    identity.email = QString::fromUtf8(resolved.second);
+    identity.initials = Signature::initials(identity.name);
+    identity.emailTerm = resolved.second.toLower();
+    foreach (const QString &part, identity.name.split(kWsRe))
+      identity.nameTerms.append(part.toUtf8().toLower());
+
+    mIdentities.append(identity);
+    mResolved.insert(resolved, id);
+  }
+
+  mRaw.insert(Key(signature->name, signature->email), id);
+  return id;
+}
+
+} // namespace git
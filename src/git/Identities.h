@@ -0,0 +1,69 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef IDENTITIES_H
+#define IDENTITIES_H
+
+#include "git2/mailmap.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+struct git_signature;
+
+namespace git {
+
+class Commit;
+class Signature;
+
+// A per-repository table of author and committer identities. Signatures
+// are resolved through the mailmap and interned into small integer ids,
+// so display strings and search terms are decoded once per identity
+// instead of once per commit. Id 0 is the empty identity.
+class Identities {
+public:
+  struct Identity {
+    QString name;
+    QString email;
+    QString initials;
+
+    // search index terms
+    QByteArray emailTerm;
+    QList<QByteArray> nameTerms;
+  };
+
+  Identities(git_repository *repo);
+  ~Identities();
+
+  int count() const;
+
+  quint32 intern(const Signature &signature);
+  quint32 author(const Commit &commit);
+  quint32 committer(const Commit &commit);
+
+  Identity identity(quint32 id) const;
+
+private:
+  using Key = QPair<QByteArray, QByteArray>;
+
+  quint32 intern(const git_signature *signature);
+
+  git_mailmap *mMailmap = nullptr;
+
+  mutable QReadWriteLock mLock;
+  QHash<Key, quint32> mRaw;
+  QHash<Key, quint32> mResolved;
+  QVector<Identity> mIdentities;
+};
+
+} // namespace git
+
+#endif
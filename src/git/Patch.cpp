@@ -13,9 +13,14 @@
 #include "Repository.h"
 #include "git2/filter.h"
 #include "git2/index.h"
+#include <QCache>
 #include <QDataStream>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
 #include <QMap>
+#include <QMutex>
+#include <cstring>
 
 namespace git {
 
@@ -23,6 +28,21 @@ namespace {
 
 const QString kConflictResolutionFile = "conflicts";
 
+// Maximum number of bytes of conflict text kept in the cache.
+const int kConflictCacheSize = 32 * 1024 * 1024;
+
+bool isMarker(const char *line, qint64 len, char ch) {
+  if (len < 7)
+    return false;
+
+  for (int i = 0; i < 7; ++i) {
+    if (line[i] != ch)
+      return false;
+  }
+
+  return true;
+}
+
 QMap<QString, QMap<int, int>> readConflictResolutions(const Repository &repo) {
   QFile file(repo.appDir().filePath(kConflictResolutionFile));
   if (file.open(QFile::ReadOnly)) {
@@ -57,48 +77,135 @@ Patch::Patch(git_patch *patch) : d(patch, git_patch_free) {
   if (!repo.isValid())
     return;
 
-  QFile file(repo.workdir().filePath(name(Diff::OldFile)));
-  if (!file.open(QFile::ReadOnly))
-    return;
+  QString path = repo.workdir().filePath(name(Diff::OldFile));
+  mConflicts = conflicts(path, git_patch_context_lines(patch));
+}
 
-  QList<QByteArray> lines;
-  QByteArray line = file.readLine();
-  while (!line.isEmpty()) {
-    lines.append(line);
-    line = file.readLine();
+QList<Patch::ConflictHunk> Patch::conflicts(const QString &path,
+                                            int context) {
+  struct Entry {
+    qint64 mtime;
+    qint64 size;
+    int context;
+    QList<ConflictHunk> hunks;
+  };
+
+  static QMutex lock;
+  static QCache<QString, Entry> cache(kConflictCacheSize);
+
+  QFileInfo info(path);
+  qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+  qint64 size = info.size();
+
+  QMutexLocker locker(&lock);
+  if (Entry *entry = cache.object(path)) {
+    if (entry->mtime == mtime && entry->size == size &&
+        entry->context == context)
+      return entry->hunks;
   }
 
-  int lineCount = lines.size();
-  int context = git_patch_context_lines(patch);
-  for (int i = 0; i < lineCount; ++i) {
-    if (!lines.at(i).startsWith("<<<<<<<"))
-      continue;
+  locker.unlock();
 
-    int mid = -1;
-    for (int j = i + 1; j < lineCount; ++j) {
-      if (!lines.at(j).startsWith("======="))
-        continue;
+  QFile file(path);
+  if (!file.open(QFile::ReadOnly))
+    return QList<ConflictHunk>();
+
+  // Map the file. Fall back to reading it if that isn't possible.
+  QByteArray buffer;
+  const char *data = nullptr;
+  if (uchar *map = file.map(0, file.size())) {
+    data = reinterpret_cast<const char *>(map);
+  } else {
+    buffer = file.readAll();
+    data = buffer.constData();
+  }
 
-      mid = j;
-      break;
+  struct Region {
+    ConflictHunk hunk;
+    qint64 begin;
+    qint64 end;
+    int remaining;
+  };
+
+  // Remember where the last few lines start so that
+  // leading context can be included without a rescan.
+  QVector<qint64> starts(context + 1);
+
+  QList<Region> regions;
+  Region current;
+  enum { Start, Ours, Theirs } state = Start;
+
+  qint64 len = file.size();
+  qint64 pos = 0;
+  for (int ln = 0; pos < len; ++ln) {
+    const char *line = data + pos;
+    const void *nl = memchr(line, '\n', len - pos);
+    qint64 end = nl ? static_cast<const char *>(nl) - data + 1 : len;
+
+    starts[ln % starts.size()] = pos;
+
+    // Extend trailing context of finished regions.
+    for (int i = regions.size() - 1; i >= 0 && regions.at(i).remaining; --i) {
+      regions[i].end = end;
+      --regions[i].remaining;
     }
 
-    if (mid < 0)
-      break;
+    switch (state) {
+      case Start:
+        if (isMarker(line, end - pos, '<')) {
+          int first = qMax(0, ln - context);
+          current.hunk.line = first;
+          current.hunk.min = ln;
+          current.begin = starts.at(first % starts.size());
+          state = Ours;
+        }
+        break;
 
-    for (int j = mid + 1; j < lineCount; ++j) {
-      if (!lines.at(j).startsWith(">>>>>>>"))
-        continue;
+      case Ours:
+        if (isMarker(line, end - pos, '=')) {
+          current.hunk.mid = ln;
+          state = Theirs;
+        }
+        break;
+
+      case Theirs:
+        if (isMarker(line, end - pos, '>')) {
+          current.hunk.max = ln;
+          current.end = end;
+          current.remaining = context;
+          regions.append(current);
+          state = Start;
+        }
+        break;
+    }
 
-      // Add conflict.
-      int line = qMax(0, i - context);
-      int count = qMin(lineCount, j + context + 1) - line;
-      mConflicts.append({line, i, mid, j, lines.mid(line, count)});
+    pos = end;
+  }
 
-      i = j + 1;
-      break;
+  // Copy out the regions and index their lines.
+  int cost = 0;
+  QList<ConflictHunk> hunks;
+  foreach (const Region &region, regions) {
+    ConflictHunk hunk = region.hunk;
+    hunk.text = QByteArray(data + region.begin, region.end - region.begin);
+
+    const char *text = hunk.text.constData();
+    int textLen = hunk.text.size();
+    for (int offset = 0; offset < textLen;) {
+      hunk.offsets.append(offset);
+      const void *nl = memchr(text + offset, '\n', textLen - offset);
+      offset = nl ? static_cast<const char *>(nl) - text + 1 : textLen;
     }
+
+    hunk.offsets.append(textLen);
+    cost += textLen;
+    hunks.append(hunk);
   }
+
+  locker.relock();
+  cache.insert(path, new Entry{mtime, size, context, hunks}, cost);
+
+  return hunks;
 }
 
 Repository Patch::repo() const { return git_patch_owner(d.data()); }
@@ -209,7 +316,7 @@ const git_diff_hunk *Patch::header_struct(int hidx) const {
 
 int Patch::lineCount(int hidx) const {
   if (isConflicted())
-    return mConflicts.at(hidx).lines.size();
+    return mConflicts.at(hidx).offsets.size() - 1;
 
   return git_patch_num_lines_in_hunk(d.data(), hidx);
 }
@@ -260,8 +367,11 @@ git_off_t Patch::contentOffset(int hidx) const {
 }
 
 QByteArray Patch::lineContent(int hidx, int ln) const {
-  if (isConflicted())
-    return mConflicts.at(hidx).lines.at(ln);
+  if (isConflicted()) {
+    const ConflictHunk &conflict = mConflicts.at(hidx);
+    int offset = conflict.offsets.at(ln);
+    return conflict.text.mid(offset, conflict.offsets.at(ln + 1) - offset);
+  }
 
   const git_diff_line *line = nullptr;
   int result = git_patch_get_line_in_hunk(&line, d.data(), hidx, ln);
@@ -16,6 +16,7 @@
 #include "git2/patch.h"
 #include <QBitArray>
 #include <QSharedPointer>
+#include <QVector>
 
 namespace git {
 
@@ -147,6 +148,22 @@ public:
 
   static void clearConflictResolutions(const Repository &repo);
 
+  struct ConflictHunk {
+    int line; // start line
+    int min;  // <<<<<<< line
+    int mid;  // ======= line
+    int max;  // >>>>>>> line
+
+    // Text of the conflict and its context. Line n spans
+    // offsets[n] up to offsets[n + 1].
+    QByteArray text;
+    QVector<int> offsets;
+  };
+
+  // Find conflict regions in a single pass over the mapped file.
+  // Results are cached by path until the file's mtime or size changes.
+  static QList<ConflictHunk> conflicts(const QString &path, int context);
+
 private:
   /*!
    * Applies changes to hunk and store result in image
@@ -159,14 +176,6 @@ private:
   void apply(QList<QList<QByteArray>> &image, int hidx, int start_line,
              int end_line) const;
 
-  struct ConflictHunk {
-    int line; // start line
-    int min;  // <<<<<<< line
-    int mid;  // ======= line
-    int max;  // >>>>>>> line
-    QList<QByteArray> lines;
-  };
-
   Patch(git_patch *patch);
 
   QSharedPointer<git_patch> d;
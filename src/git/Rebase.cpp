@@ -21,9 +21,10 @@ namespace git {
 Rebase::Rebase() : d(nullptr) {}
 
 Rebase::Rebase(git_repository *repo, git_rebase *rebase,
-               const QString &overrideUser, const QString &overrideEmail)
-    : mRepo(repo), d(rebase, git_rebase_free), mOverrideUser(overrideUser),
-      mOverrideEmail(overrideEmail) {}
+               const QString &overrideUser, const QString &overrideEmail,
+               bool inMemory)
+    : mRepo(repo), d(rebase, git_rebase_free), mInMemory(inMemory),
+      mOverrideUser(overrideUser), mOverrideEmail(overrideEmail) {}
 
 int Rebase::count() const { return git_rebase_operation_entrycount(d.data()); }
 
@@ -10,6 +10,7 @@
 #ifndef REBASE_H
 #define REBASE_H
 
+#include <QMetaType>
 #include <QSharedPointer>
 
 // TODO: move to cpp again, forward declaration should be enough
@@ -24,8 +25,13 @@ class Commit;
 
 class Rebase {
 public:
+  Rebase();
+
   bool isValid() const { return !d.isNull(); }
 
+  // In-memory rebases never touch the index or workdir.
+  bool isInMemory() const { return mInMemory; }
+
   int count() const;
   size_t currentIndex() const;
   const git_rebase_operation *operation(size_t index);
@@ -38,13 +44,13 @@ public:
   bool finish();
 
 private:
-  Rebase();
   Rebase(git_repository *repo, git_rebase *rebase = nullptr,
          const QString &overrideUser = QString(),
-         const QString &overrideEmail = QString());
+         const QString &overrideEmail = QString(), bool inMemory = false);
 
-  git_repository *mRepo;
+  git_repository *mRepo = nullptr;
   QSharedPointer<git_rebase> d;
+  bool mInMemory = false;
   QString mOverrideUser;
   QString mOverrideEmail;
 
@@ -53,4 +59,6 @@ private:
 
 } // namespace git
 
+Q_DECLARE_METATYPE(git::Rebase);
+
 #endif
@@ -0,0 +1,307 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "RefSnapshot.h"
+#include "git2/object.h"
+#include "git2/oid.h"
+#include "git2/repository.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <algorithm>
+#include <cstring>
+
+namespace git {
+
+namespace {
+
+const QString kPackedRefsFile = "packed-refs";
+const QString kRefsDir = "refs";
+
+const QByteArray kSymbolicPrefix = "ref: ";
+const int kMaxSymbolicDepth = 5;
+
+const char *const kShorthandPrefixes[] = {"refs/heads/", "refs/tags/",
+                                          "refs/remotes/", "refs/"};
+
+bool parseId(const char *data, int len, git_oid &id) {
+  return (len >= GIT_OID_HEXSZ && !git_oid_fromstrn(&id, data, GIT_OID_HEXSZ));
+}
+
+// Branches always point to commits, so only other references have to be
+// looked up to find out what they peel to.
+bool isBranch(const QByteArray &name) {
+  return (name.startsWith("refs/heads/") || name.startsWith("refs/remotes/"));
+}
+
+Id peel(git_repository *repo, const git_oid &id) {
+  git_object *obj = nullptr;
+  if (git_object_lookup(&obj, repo, &id, GIT_OBJECT_ANY))
+    return Id();
+
+  git_object *commit = nullptr;
+  int error = git_object_peel(&commit, obj, GIT_OBJECT_COMMIT);
+  git_object_free(obj);
+  if (error)
+    return Id();
+
+  Id result(git_object_id(commit));
+  git_object_free(commit);
+  return result;
+}
+
+bool lessThan(const RefSnapshot::Entry &lhs, const RefSnapshot::Entry &rhs) {
+  return (lhs.name < rhs.name);
+}
+
+} // namespace
+
+RefSnapshot::RefSnapshot() {}
+
+RefSnapshot::Range RefSnapshot::entries(const QByteArray &prefix) const {
+  static const QVector<Entry> empty;
+  if (!d)
+    return Range(empty.begin(), empty.end());
+
+  const QVector<Entry> &entries = d->entries;
+  auto begin = std::lower_bound(
+      entries.begin(), entries.end(), prefix,
+      [](const Entry &entry, const QByteArray &prefix) {
+        return (entry.name < prefix);
+      });
+
+  auto end = begin;
+  while (end != entries.end() && end->name.startsWith(prefix))
+    ++end;
+
+  return Range(begin, end);
+}
+
+QVector<RefSnapshot::Entry> RefSnapshot::entries(const Id &commit) const {
+  QVector<Entry> entries;
+  if (!d)
+    return entries;
+
+  if (const QVector<int> *indexes = d->commits.find(commit)) {
+    foreach (int index, *indexes)
+      entries.append(d->entries.at(index));
+  }
+
+  return entries;
+}
+
+bool RefSnapshot::contains(const QByteArray &name, const Id &commit) const {
+  Range range = entries(name);
+  for (const Entry &entry : range) {
+    if (entry.name == name)
+      return (entry.commit == commit);
+  }
+
+  return false;
+}
+
+bool RefSnapshot::isCurrent() const {
+  return (d && stamps(d->paths) == d->stamps);
+}
+
+QString RefSnapshot::shorthand(const QByteArray &name) {
+  for (const char *prefix : kShorthandPrefixes) {
+    if (name.startsWith(prefix))
+      return QString::fromUtf8(name.mid(strlen(prefix)));
+  }
+
+  return QString::fromUtf8(name);
+}
+
+RefSnapshot RefSnapshot::read(git_repository *repo) {
+  QSharedPointer<Data> data(new Data);
+
+  // Take stamps first so that changes made while reading invalidate the
+  // snapshot. Adding or replacing a loose ref touches its directory.
+  QDir dir(QString::fromUtf8(git_repository_commondir(repo)));
+  data->paths.append(dir.filePath(kPackedRefsFile));
+  data->paths.append(dir.filePath(kRefsDir));
+  QDirIterator dirs(dir.filePath(kRefsDir), QDir::Dirs | QDir::NoDotAndDotDot,
+                    QDirIterator::Subdirectories);
+  while (dirs.hasNext())
+    data->paths.append(dirs.next());
+  data->stamps = stamps(data->paths);
+
+  // Read packed refs. The file is sorted by name unless the header says
+  // otherwise, and records the commit that annotated tags peel to.
+  QVector<Entry> packed;
+  QFile file(data->paths.first());
+  if (file.open(QFile::ReadOnly) && file.size() > 0) {
+    QByteArray buffer;
+    qint64 size = file.size();
+    const char *begin = reinterpret_cast<const char *>(file.map(0, size));
+    if (!begin) {
+      buffer = file.readAll();
+      begin = buffer.constData();
+      size = buffer.size();
+    }
+
+    bool sorted = false;
+    bool peeled = false;
+    bool fullyPeeled = false;
+    const char *end = begin + size;
+    for (const char *line = begin; line < end;) {
+      const char *eol =
+          static_cast<const char *>(memchr(line, '\n', end - line));
+      if (!eol)
+        eol = end;
+
+      git_oid id;
+      int len = eol - line;
+      if (*line == '#') {
+        QByteArray header(line, len);
+        sorted = header.contains(" sorted");
+        peeled = header.contains(" peeled");
+        fullyPeeled = header.contains(" fully-peeled");
+      } else if (*line == '^') {
+        if (!packed.isEmpty() && parseId(line + 1, len - 1, id))
+          packed.last().commit = id;
+      } else if (len > GIT_OID_HEXSZ + 1 && line[GIT_OID_HEXSZ] == ' ' &&
+                 parseId(line, len, id)) {
+        Entry entry;
+        entry.name = QByteArray(line + GIT_OID_HEXSZ + 1,
+                                len - GIT_OID_HEXSZ - 1);
+        if (entry.name.endsWith('\r'))
+          entry.name.chop(1);
+
+        // A reference without a peeled line peels to itself if the file
+        // records peeled values for it.
+        entry.id = id;
+        if (fullyPeeled || isBranch(entry.name) ||
+            (peeled && entry.name.startsWith("refs/tags/"))) {
+          entry.commit = id;
+        } else {
+          entry.commit = peel(repo, id);
+        }
+
+        packed.append(entry);
+      }
+
+      line = eol + 1;
+    }
+
+    if (!sorted)
+      std::sort(packed.begin(), packed.end(), lessThan);
+  }
+
+  // Read loose refs. They take precedence over packed refs.
+  QMap<QByteArray, Entry> loose;
+  QHash<QByteArray, QByteArray> symbolic;
+  int prefixLen = dir.path().length() + 1;
+  QDirIterator files(dir.filePath(kRefsDir), QDir::Files,
+                     QDirIterator::Subdirectories);
+  while (files.hasNext()) {
+    QString path = files.next();
+    if (path.endsWith(".lock"))
+      continue;
+
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+      continue;
+
+    Entry entry;
+    entry.name = path.mid(prefixLen).toUtf8();
+    QByteArray content = file.readAll().trimmed();
+    if (content.startsWith(kSymbolicPrefix)) {
+      symbolic.insert(entry.name, content.mid(kSymbolicPrefix.length()));
+    } else {
+      git_oid id;
+      if (!parseId(content.constData(), content.length(), id))
+        continue;
+
+      entry.id = id;
+      entry.commit = isBranch(entry.name) ? Id(id) : peel(repo, id);
+    }
+
+    loose.insert(entry.name, entry);
+  }
+
+  // Merge both sorted lists.
+  QVector<Entry> &entries = data->entries;
+  entries.reserve(packed.size() + loose.size());
+  auto it = loose.constBegin();
+  foreach (const Entry &entry, packed) {
+    while (it != loose.constEnd() && it.key() < entry.name)
+      entries.append(*it++);
+
+    if (it != loose.constEnd() && it.key() == entry.name) {
+      entries.append(*it++);
+    } else {
+      entries.append(entry);
+    }
+  }
+
+  while (it != loose.constEnd())
+    entries.append(*it++);
+
+  // Resolve symbolic refs to the entry that they point to.
+  auto find = [&entries](const QByteArray &name) -> const Entry * {
+    Entry key;
+    key.name = name;
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, lessThan);
+    return (it != entries.end() && it->name == name) ? &*it : nullptr;
+  };
+
+  for (int i = 0; i < entries.size(); ++i) {
+    Entry &entry = entries[i];
+    QByteArray target = symbolic.value(entry.name);
+    for (int depth = 0; !target.isEmpty() && depth < kMaxSymbolicDepth;
+         ++depth) {
+      const Entry *resolved = find(target);
+      if (!resolved)
+        break;
+
+      if (!resolved->id.isNull()) {
+        entry.id = resolved->id;
+        entry.commit = resolved->commit;
+        break;
+      }
+
+      target = symbolic.value(resolved->name);
+    }
+  }
+
+  // Drop dangling symbolic refs and index the rest by commit.
+  auto dangling = [](const Entry &entry) { return entry.id.isNull(); };
+  entries.erase(std::remove_if(entries.begin(), entries.end(), dangling),
+                entries.end());
+
+  for (int i = 0; i < entries.size(); ++i) {
+    const Id &commit = entries.at(i).commit;
+    if (!commit.isNull())
+      data->commits[commit].append(i);
+  }
+
+  RefSnapshot snapshot;
+  snapshot.d = data;
+  return snapshot;
+}
+
+QList<qint64> RefSnapshot::stamps(const QStringList &paths) {
+  QList<qint64> stamps;
+  foreach (const QString &path, paths) {
+    QFileInfo info(path);
+    if (!info.exists()) {
+      stamps << -1 << -1;
+    } else {
+      stamps << info.lastModified().toMSecsSinceEpoch() << info.size();
+    }
+  }
+
+  return stamps;
+}
+
+} // namespace git
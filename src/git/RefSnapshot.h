@@ -0,0 +1,97 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef REFSNAPSHOT_H
+#define REFSNAPSHOT_H
+
+#include "Id.h"
+#include "IdHash.h"
+#include <QByteArray>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+struct git_repository;
+
+namespace git {
+
+// An immutable, name-ordered list of the references under refs/. The
+// snapshot is read by mapping packed-refs and merging the loose refs over
+// it in one pass, so enumerating references or selecting a prefix range
+// doesn't go back to the ref database. Snapshots are cheap to copy and can
+// be shared between threads.
+class RefSnapshot {
+public:
+  struct Entry {
+    QByteArray name; // qualified name
+    Id id;           // direct target, resolved for symbolic references
+    Id commit;       // peeled commit or null
+  };
+
+  typedef QVector<Entry>::const_iterator const_iterator;
+
+  // A range of entries that can be used in a range-based for loop.
+  class Range {
+  public:
+    Range(const_iterator begin, const_iterator end)
+        : mBegin(begin), mEnd(end) {}
+
+    const_iterator begin() const { return mBegin; }
+    const_iterator end() const { return mEnd; }
+    int size() const { return mEnd - mBegin; }
+
+  private:
+    const_iterator mBegin;
+    const_iterator mEnd;
+  };
+
+  RefSnapshot();
+
+  bool isValid() const { return !d.isNull(); }
+  explicit operator bool() const { return isValid(); }
+
+  int count() const { return d ? d->entries.size() : 0; }
+
+  // Get the entries whose name starts with the given prefix. The range
+  // is only valid as long as this snapshot.
+  Range entries(const QByteArray &prefix = QByteArray()) const;
+
+  // Get the entries that peel to the given commit.
+  QVector<Entry> entries(const Id &commit) const;
+
+  // Check whether the named reference peels to the given commit.
+  bool contains(const QByteArray &name, const Id &commit) const;
+
+  // Check whether the files that the snapshot was read from are
+  // unchanged. An invalid snapshot is never current.
+  bool isCurrent() const;
+
+  // Get the short name of a qualified reference name.
+  static QString shorthand(const QByteArray &name);
+
+  static RefSnapshot read(git_repository *repo);
+
+private:
+  struct Data {
+    QVector<Entry> entries;
+    IdMap<QVector<int>> commits;
+
+    // modification stamps of packed-refs and of each loose ref directory
+    QStringList paths;
+    QList<qint64> stamps;
+  };
+
+  static QList<qint64> stamps(const QStringList &paths);
+
+  QSharedPointer<const Data> d;
+};
+
+} // namespace git
+
+#endif
@@ -10,6 +10,7 @@
 #include "Reference.h"
 #include "Commit.h"
 #include "Object.h"
+#include "Reflog.h"
 #include "RevWalk.h"
 #include "Repository.h"
 #include "TagRef.h"
@@ -78,6 +79,16 @@ RevWalk Reference::walker(int sort, bool firstCommitOnly) const {
   return commit.isValid() ? commit.walker(sort, firstCommitOnly) : RevWalk();
 }
 
+Reflog Reference::reflog() const {
+  if (!isValid())
+    return Reflog();
+
+  git_reflog *reflog = nullptr;
+  git_reflog_read(&reflog, git_reference_owner(d.data()),
+                  git_reference_name(d.data()));
+  return Reflog(reflog);
+}
+
 int Reference::difference(const Reference &ref) const {
   Commit lhs = target();
   Commit rhs = ref.target();
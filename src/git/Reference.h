@@ -21,6 +21,7 @@ namespace git {
 class AnnotatedCommit;
 class Commit;
 class Object;
+class Reflog;
 class RevWalk;
 
 class Reference {
@@ -49,6 +50,9 @@ public:
   // Create a walker over the referenced commit.
   RevWalk walker(int sort = GIT_SORT_NONE, bool firstCommitOnly = false) const;
 
+  // Read the reflog of this reference.
+  Reflog reflog() const;
+
   // Calculate difference in commits between this and the given reference.
   // References that have diverged calculate the distance to a common base.
   int difference(const Reference &ref) const;
@@ -71,6 +75,7 @@ protected:
   QSharedPointer<git_reference> d;
 
   friend class Commit;
+  friend class ReferenceCatalog;
   friend class Repository;
   friend class RevWalk;
 };
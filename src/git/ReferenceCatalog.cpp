@@ -0,0 +1,238 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "ReferenceCatalog.h"
+#include "RefSnapshot.h"
+#include "Reference.h"
+#include "Repository.h"
+#include "git2/commit.h"
+#include "git2/refs.h"
+#include <QHash>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace git {
+
+namespace {
+
+const QString kPrefixes[] = {"refs/heads/", "refs/remotes/", "refs/tags/"};
+
+} // namespace
+
+ReferenceCatalog::ReferenceCatalog(const Repository &repo, QObject *parent)
+    : QObject(parent), mRepo(repo) {
+  connect(&mWatcher, &QFutureWatcher<Data>::finished, this, [this] {
+    if (finish())
+      emit updated();
+
+    if (mPending) {
+      mPending = false;
+      update();
+    }
+  });
+
+  RepositoryNotifier *notifier = repo.notifier();
+  connect(notifier, &RepositoryNotifier::referenceAdded, this,
+          &ReferenceCatalog::add);
+  connect(notifier, &RepositoryNotifier::referenceUpdated, this,
+          &ReferenceCatalog::add);
+  connect(notifier, &RepositoryNotifier::referenceRemoved, this,
+          &ReferenceCatalog::remove);
+
+  update();
+}
+
+ReferenceCatalog::~ReferenceCatalog() { mWatcher.waitForFinished(); }
+
+const ReferenceCatalog::Entries &ReferenceCatalog::entries(Kind kind) const {
+  return mData.entries[kind];
+}
+
+void ReferenceCatalog::update() {
+  if (mWatcher.isRunning()) {
+    mPending = true;
+    return;
+  }
+
+  // The repository outlives the catalog, so it's safe to use the
+  // underlying pointer without holding a reference on the worker.
+  git_repository *repo = mRepo;
+  Data data = mData;
+  mWatcher.setFuture(
+      QtConcurrent::run([repo, data] { return load(repo, data); }));
+}
+
+QString ReferenceCatalog::qualifiedName(Kind kind, const QString &name) {
+  return kPrefixes[kind] + name;
+}
+
+ReferenceCatalog::Data ReferenceCatalog::load(git_repository *repo,
+                                              const Data &previous) {
+  Data data;
+  RefSnapshot snapshot = RefSnapshot::read(repo);
+  for (int i = 0; i < KindCount; ++i) {
+    QHash<QString, Entry> known;
+    foreach (const Entry &entry, previous.entries[i])
+      known.insert(entry.name, entry);
+
+    QByteArray prefix = kPrefixes[i].toUtf8();
+    Entries &entries = data.entries[i];
+    for (const RefSnapshot::Entry &ref : snapshot.entries(prefix)) {
+      Entry entry;
+      entry.name = QString::fromUtf8(ref.name.mid(prefix.length()));
+      entry.target = ref.commit;
+
+      // Only look up commits of new or moved references.
+      auto it = known.constFind(entry.name);
+      if (it != known.constEnd() && it->target == entry.target) {
+        entry.time = it->time;
+      } else {
+        git_commit *commit = nullptr;
+        if (!git_commit_lookup(&commit, repo, ref.commit)) {
+          entry.time = git_commit_time(commit);
+          git_commit_free(commit);
+        }
+      }
+
+      entries.append(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(), &ReferenceCatalog::lessThan);
+  }
+
+  return data;
+}
+
+bool ReferenceCatalog::finish() {
+  Data data = mWatcher.result();
+  bool loaded = mLoaded;
+  mLoaded = true;
+
+  // Reapply changes that the load may have missed.
+  std::swap(mData, data);
+  foreach (const Reference &ref, mAdded)
+    apply(ref);
+  foreach (const QString &name, mRemoved)
+    apply(name);
+
+  mAdded.clear();
+  mRemoved.clear();
+
+  // Check if anything changed.
+  if (!loaded)
+    return true;
+
+  for (int i = 0; i < KindCount; ++i) {
+    const Entries &lhs = mData.entries[i];
+    const Entries &rhs = data.entries[i];
+    if (lhs.size() != rhs.size())
+      return true;
+
+    for (int j = 0; j < lhs.size(); ++j) {
+      if (lhs.at(j).name != rhs.at(j).name ||
+          lhs.at(j).target != rhs.at(j).target)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+void ReferenceCatalog::add(const Reference &ref) {
+  // A change that can't be attributed to a reference, like a remote
+  // branch that was pruned by a fetch, requires a reload.
+  if (!ref.isValid()) {
+    update();
+    return;
+  }
+
+  apply(ref);
+  if (mWatcher.isRunning())
+    mAdded.append(ref);
+
+  emit updated();
+}
+
+void ReferenceCatalog::remove(const QString &name) {
+  apply(name);
+  if (mWatcher.isRunning())
+    mRemoved.append(name);
+
+  emit updated();
+}
+
+void ReferenceCatalog::apply(const Reference &ref) {
+  Kind kind;
+  Entry entry;
+  if (!ReferenceCatalog::entry(ref, kind, entry))
+    return;
+
+  Repository repo(mRepo);
+  Entries &entries = mData.entries[kind];
+  for (int i = entries.size() - 1; i >= 0; --i) {
+    // Drop the old entry of this reference. Other entries that pointed
+    // to the same commit may have been renamed away.
+    const Entry &tmp = entries.at(i);
+    if (tmp.name == entry.name ||
+        (tmp.target == entry.target &&
+         !repo.lookupRef(qualifiedName(kind, tmp.name))))
+      entries.remove(i);
+  }
+
+  // The reference may have been removed since it was reported.
+  if (!repo.lookupRef(qualifiedName(kind, entry.name)))
+    return;
+
+  auto it = std::upper_bound(entries.begin(), entries.end(), entry,
+                             &ReferenceCatalog::lessThan);
+  entries.insert(it, entry);
+}
+
+void ReferenceCatalog::apply(const QString &name) {
+  // The notifier only reports the short name, so check each kind for a
+  // reference with that name that no longer exists.
+  Repository repo(mRepo);
+  for (int i = 0; i < KindCount; ++i) {
+    Kind kind = static_cast<Kind>(i);
+    Entries &entries = mData.entries[kind];
+    for (int j = entries.size() - 1; j >= 0; --j) {
+      if (entries.at(j).name == name &&
+          !repo.lookupRef(qualifiedName(kind, name)))
+        entries.remove(j);
+    }
+  }
+}
+
+bool ReferenceCatalog::entry(git_reference *ref, Kind &kind, Entry &entry) {
+  QString name = QString::fromUtf8(git_reference_name(ref));
+  for (int i = 0; i < KindCount; ++i) {
+    if (!name.startsWith(kPrefixes[i]))
+      continue;
+
+    kind = static_cast<Kind>(i);
+    entry.name = name.mid(kPrefixes[i].length());
+
+    git_object *obj = nullptr;
+    if (!git_reference_peel(&obj, ref, GIT_OBJECT_COMMIT)) {
+      entry.target = git_object_id(obj);
+      entry.time = git_commit_time(reinterpret_cast<git_commit *>(obj));
+      git_object_free(obj);
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+bool ReferenceCatalog::lessThan(const Entry &lhs, const Entry &rhs) {
+  if (lhs.time != rhs.time)
+    return (lhs.time > rhs.time);
+  return (lhs.name < rhs.name);
+}
+
+} // namespace git
@@ -0,0 +1,102 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef REFERENCECATALOG_H
+#define REFERENCECATALOG_H
+
+#include "Id.h"
+#include "Reference.h"
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+struct git_reference;
+struct git_repository;
+
+namespace git {
+
+// A sorted list of the branches, remote branches and tags of a repository.
+// The catalog is loaded on a worker and then kept up to date by applying
+// the changes announced by the repository notifier, so views don't have to
+// enumerate and peel every reference each time one of them changes. Entries
+// are ordered from the newest target commit to the oldest. Nothing blocks
+// on the first load. Views fill in when updated is emitted.
+//
+// The catalog belongs to the repository and must only be used from the
+// main thread.
+class ReferenceCatalog : public QObject {
+  Q_OBJECT
+
+public:
+  enum Kind { LocalBranch, RemoteBranch, Tag, KindCount };
+
+  struct Entry {
+    QString name; // short name
+    Id target;
+    qint64 time = 0;
+  };
+
+  typedef QVector<Entry> Entries;
+
+  struct Data {
+    Entries entries[KindCount];
+  };
+
+  ReferenceCatalog(const Repository &repo, QObject *parent = nullptr);
+  ~ReferenceCatalog() override;
+
+  // Get the entries of the given kind. The entries are empty until the
+  // first load finishes. Updated is emitted when they change.
+  bool isLoaded() const { return mLoaded; }
+  const Entries &entries(Kind kind) const;
+
+  // Compare all references to the catalog in the background. Use this to
+  // pick up changes that weren't made through the repository notifier.
+  // Only changed references are peeled again and updated is only emitted
+  // if something changed.
+  void update();
+
+  // Get the qualified name of an entry.
+  static QString qualifiedName(Kind kind, const QString &name);
+
+  // Enumerate and sort all references of the repository. Commit times of
+  // references that still point to the same target are taken from the
+  // previous data.
+  static Data load(git_repository *repo, const Data &previous = Data());
+
+signals:
+  void updated();
+
+private:
+  bool finish();
+
+  // Notifier handlers. Changes that arrive while a load is running
+  // are applied now and again when the load finishes.
+  void add(const Reference &ref);
+  void remove(const QString &name);
+
+  void apply(const Reference &ref);
+  void apply(const QString &name);
+
+  static bool entry(git_reference *ref, Kind &kind, Entry &entry);
+  static bool lessThan(const Entry &lhs, const Entry &rhs);
+
+  git_repository *mRepo;
+  Data mData;
+  bool mLoaded = false;
+  bool mPending = false;
+  QList<Reference> mAdded;
+  QStringList mRemoved;
+  QFutureWatcher<Data> mWatcher;
+};
+
+} // namespace git
+
+#endif
@@ -0,0 +1,39 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Reflog.h"
+#include "Id.h"
+
+namespace git {
+
+Reflog::Reflog() {}
+
+Reflog::Reflog(git_reflog *reflog) : d(reflog, git_reflog_free) {}
+
+int Reflog::count() const { return d ? git_reflog_entrycount(d.data()) : 0; }
+
+Id Reflog::id(int index) const {
+  const git_reflog_entry *entry = this->entry(index);
+  return entry ? Id(git_reflog_entry_id_new(entry)) : Id();
+}
+
+Id Reflog::previousId(int index) const {
+  const git_reflog_entry *entry = this->entry(index);
+  return entry ? Id(git_reflog_entry_id_old(entry)) : Id();
+}
+
+QString Reflog::message(int index) const {
+  const git_reflog_entry *entry = this->entry(index);
+  return entry ? QString::fromUtf8(git_reflog_entry_message(entry))
+               : QString();
+}
+
+const git_reflog_entry *Reflog::entry(int index) const {
+  return d ? git_reflog_entry_byindex(d.data(), index) : nullptr;
+}
+
+} // namespace git
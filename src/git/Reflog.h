@@ -0,0 +1,48 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef REFLOG_H
+#define REFLOG_H
+
+#include "git2/reflog.h"
+#include <QSharedPointer>
+#include <QString>
+
+namespace git {
+
+class Id;
+
+// Entries are ordered from newest to oldest. Entry n of the stash reflog
+// is stash@{n}. Entries are decoded when they're accessed, so callers can
+// page through a long reflog without looking up every commit.
+class Reflog {
+public:
+  Reflog();
+
+  bool isValid() const { return !d.isNull(); }
+  explicit operator bool() const { return isValid(); }
+
+  int count() const;
+
+  Id id(int index) const;
+  Id previousId(int index) const;
+  QString message(int index) const;
+
+private:
+  Reflog(git_reflog *reflog);
+
+  const git_reflog_entry *entry(int index) const;
+
+  QSharedPointer<git_reflog> d;
+
+  friend class Reference;
+  friend class Repository;
+};
+
+} // namespace git
+
+#endif
@@ -576,6 +576,13 @@ Result Remote::push(Callbacks *callbacks, const QStringList &refspecs) {
   QByteArray proxy = proxyUrl(url(), opts.proxy_opts.type);
   opts.proxy_opts.url = proxy;
 
+  // Keep the single threaded packbuilder unless pack.threads is set. Zero
+  // means autodetect like in git. Delta cache limits are read by libgit2
+  // from pack.* keys.
+  Repository repo(git_remote_owner(d.data()));
+  int threads = repo.gitConfig().value<int>("pack.threads", 1);
+  opts.pb_parallelism = qMax(0, threads);
+
   QVector<char *> raw;
   QVector<QByteArray> storage;
   foreach (const QString &refspec, refspecs) {
@@ -21,6 +21,7 @@
 #include "qtsupport.h"
 #include "Rebase.h"
 #include "Reference.h"
+#include "ReferenceCatalog.h"
 #include "Remote.h"
 #include "RevWalk.h"
 #include "Signature.h"
@@ -53,10 +54,12 @@
 #include <QStandardPaths>
 #include <QTextCodec>
 #include <QVector>
+#include <QtConcurrent>
 
 #ifdef Q_OS_UNIX
 #include <pwd.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #endif
 
 namespace git {
@@ -67,6 +70,67 @@ const QString kConfigDir = "gittyup";
 const QString kConfigFile = "config";
 const QString kStarFile = "starred";
 
+// Rewrite the star log once it has this many entries and most of
+// them are redundant.
+const int kStarLogCompactThreshold = 256;
+
+// Maximum number of cached merge previews.
+const int kMergePreviewCacheSize = 64;
+
+// Tree switches with at least this many changed paths are written in
+// parallel. Smaller ones go through libgit2 directly.
+const int kParallelCheckoutThreshold = 512;
+
+struct CheckoutJob {
+  git_delta_t status;
+  QString path;
+  QByteArray rawPath;
+  git_oid id;
+  uint32_t mode;
+  git_index_entry entry;
+  bool ok = true;
+};
+
+// Fill the stat fields of an index entry from the file that was written.
+void stat_entry(const QString &path, git_index_entry &entry) {
+#ifdef Q_OS_UNIX
+  struct stat st;
+  if (lstat(QFile::encodeName(path).constData(), &st))
+    return;
+
+  entry.ctime.seconds = st.st_ctime;
+  entry.mtime.seconds = st.st_mtime;
+#ifdef Q_OS_MAC
+  entry.ctime.nanoseconds = st.st_ctimespec.tv_nsec;
+  entry.mtime.nanoseconds = st.st_mtimespec.tv_nsec;
+#else
+  entry.ctime.nanoseconds = st.st_ctim.tv_nsec;
+  entry.mtime.nanoseconds = st.st_mtim.tv_nsec;
+#endif
+  entry.dev = st.st_dev;
+  entry.ino = st.st_ino;
+  entry.uid = st.st_uid;
+  entry.gid = st.st_gid;
+  entry.file_size = st.st_size;
+#else
+  QFileInfo info(path);
+  qint64 msecs = info.lastModified().toMSecsSinceEpoch();
+  entry.mtime.seconds = msecs / 1000;
+  entry.mtime.nanoseconds = (msecs % 1000) * 1000000;
+  entry.ctime = entry.mtime;
+  entry.file_size = info.size();
+#endif
+}
+
+// Identify the revision of a file on disk by its modification time and size.
+QList<qint64> file_stamp(const QString &path) {
+  QFileInfo info(path);
+  if (!info.exists())
+    return {-1, -1};
+
+  return {info.lastModified().toMSecsSinceEpoch(), info.size()};
+}
+
 int blame_progress(const git_oid *suspect, void *payload) {
   return reinterpret_cast<Blame::Callbacks *>(payload)->progress() ? 0 : -1;
 }
@@ -108,18 +172,53 @@ QMap<git_repository *, QWeakPointer<Repository::Data>> Repository::registry;
 
 Repository::Data::Data(git_repository *repo)
     : repo(repo), notifier(new RepositoryNotifier) {
+  // Changes made through the app can happen within the resolution of
+  // the file stamps, so drop the ref snapshot when it's out of date.
+  auto update = [this](const Reference &ref) {
+    QMutexLocker locker(&refSnapshotLock);
+    if (!ref.isValid()) {
+      refSnapshot = RefSnapshot();
+      return;
+    }
+
+    QString name = ref.qualifiedName();
+    Commit target = ref.target();
+    Id id = target.isValid() ? target.id() : Id();
+    if (name.startsWith("refs/") && !refSnapshot.contains(name.toUtf8(), id))
+      refSnapshot = RefSnapshot();
+  };
+
+  auto remove = [this] {
+    QMutexLocker locker(&refSnapshotLock);
+    refSnapshot = RefSnapshot();
+  };
+
+  QObject::connect(notifier, &RepositoryNotifier::referenceAdded, update);
+  QObject::connect(notifier, &RepositoryNotifier::referenceUpdated, update);
+  QObject::connect(notifier, &RepositoryNotifier::referenceRemoved, remove);
+
   // Load starred commits.
   QDir dir(git_repository_path(repo));
   QFile file(appDir(dir).filePath(kStarFile));
   if (!file.open(QIODevice::ReadOnly))
     return;
 
+  // The star file is a log of +<id> and -<id> entries. Lines without
+  // a prefix are stars written by compaction or by older versions.
   QByteArray ids = file.readAll();
-  if (ids.isEmpty())
-    return;
-
-  foreach (const QByteArray &id, ids.split('\n'))
-    starredCommits.insert(QByteArray::fromHex(id));
+  foreach (const QByteArray &line, ids.split('\n')) {
+    if (line.isEmpty())
+      continue;
+
+    ++starredLogEntries;
+    if (line.startsWith('-')) {
+      starredCommits.remove(QByteArray::fromHex(line.mid(1)));
+    } else if (line.startsWith('+')) {
+      starredCommits.insert(QByteArray::fromHex(line.mid(1)));
+    } else {
+      starredCommits.insert(QByteArray::fromHex(line));
+    }
+  }
 }
 
 Repository::Data::~Data() {
@@ -195,10 +294,34 @@ Config Repository::gitConfig() const {
 // Config file used for app specific configs
 // config file in <Repository>/.git/gittyup/config
 Config Repository::appConfig() const {
-  Config config = Config::appGlobal();
+  QMutexLocker locker(&d->appConfigLock);
+  ensureAppConfigCached();
+  return *d->appConfig;
+}
+
+bool Repository::isUntrackedHidden() const {
+  QMutexLocker locker(&d->appConfigLock);
+  ensureAppConfigCached();
+  return d->untrackedHidden;
+}
+
+void Repository::ensureAppConfigCached() const {
   QString path = appDir().filePath(kConfigFile);
-  config.addFile(path, GIT_CONFIG_LEVEL_LOCAL, d->repo);
-  return config;
+  QList<qint64> stamp =
+      file_stamp(Config::appGlobalPath()) + file_stamp(path);
+  if (d->appConfig && stamp == d->appConfigStamp)
+    return;
+
+  if (!d->appConfig) {
+    Config config = Config::appGlobal();
+    config.addFile(path, GIT_CONFIG_LEVEL_LOCAL, d->repo);
+    config.setShared();
+    d->appConfig.reset(new Config(config));
+  }
+
+  // The config backends refresh themselves from disk on the next read.
+  d->untrackedHidden = d->appConfig->value<bool>("untracked.hide", false);
+  d->appConfigStamp = stamp;
 }
 
 bool Repository::isBare() const { return git_repository_is_bare(d->repo); }
@@ -212,6 +335,19 @@ Signature Repository::signature(const QString &name, const QString &email,
   return Signature(name, email, date);
 }
 
+Identities *Repository::identities() const {
+  QMutexLocker locker(&d->identitiesLock);
+  if (!d->identities)
+    d->identities.reset(new Identities(d->repo));
+  return d->identities.data();
+}
+
+ReferenceCatalog *Repository::referenceCatalog() const {
+  if (!d->referenceCatalog)
+    d->referenceCatalog = new ReferenceCatalog(*this, d->notifier);
+  return d->referenceCatalog;
+}
+
 Signature Repository::defaultSignature(bool *fake, const QString &overrideUser,
                                        const QString &overrideEmail) const {
   QString name, email;
@@ -322,7 +458,7 @@ Diff Repository::diffTreeToIndex(const Tree &tree, const Index &index,
   git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
   opts.flags |= GIT_DIFF_INCLUDE_TYPECHANGE;
 
-  if (!appConfig().value<bool>("untracked.hide", false))
+  if (!isUntrackedHidden())
     opts.flags |= GIT_DIFF_INCLUDE_UNTRACKED | GIT_DIFF_RECURSE_UNTRACKED_DIRS;
 
   if (ignoreWhitespace)
@@ -339,7 +475,7 @@ Diff Repository::diffIndexToWorkdir(const Index &index,
   git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
   opts.flags |= (GIT_DIFF_DISABLE_MMAP | GIT_DIFF_INCLUDE_TYPECHANGE);
 
-  if (!appConfig().value<bool>("untracked.hide", false))
+  if (!isUntrackedHidden())
     opts.flags |= GIT_DIFF_INCLUDE_UNTRACKED | GIT_DIFF_RECURSE_UNTRACKED_DIRS;
 
   if (ignoreWhitespace)
@@ -355,6 +491,16 @@ Diff Repository::diffIndexToWorkdir(const Index &index,
   return Diff(diff);
 }
 
+Diff Repository::diffTreeToTree(const Tree &oldTree,
+                                const Tree &newTree) const {
+  git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+  opts.flags |= GIT_DIFF_INCLUDE_TYPECHANGE;
+
+  git_diff *diff = nullptr;
+  git_diff_tree_to_tree(&diff, d->repo, oldTree, newTree, &opts);
+  return Diff(diff);
+}
+
 Reference Repository::head() const {
   git_reference *ref = nullptr;
   git_repository_head(&ref, d->repo);
@@ -407,6 +553,13 @@ QList<Reference> Repository::refs() const {
   return refs;
 }
 
+RefSnapshot Repository::refSnapshot() const {
+  QMutexLocker locker(&d->refSnapshotLock);
+  if (!d->refSnapshot.isCurrent())
+    d->refSnapshot = RefSnapshot::read(d->repo);
+  return d->refSnapshot;
+}
+
 Reference Repository::lookupRef(const QString &name) const {
   if (name.isEmpty())
     return Reference();
@@ -540,6 +693,12 @@ Blob Repository::lookupBlob(const Id &id) const {
   return Blob(reinterpret_cast<git_blob *>(obj));
 }
 
+Tree Repository::lookupTree(const Id &id) const {
+  git_object *obj = nullptr;
+  git_object_lookup(&obj, d->repo, id, GIT_OBJECT_TREE);
+  return Tree(reinterpret_cast<git_tree *>(obj));
+}
+
 RevWalk Repository::walker(int sort) const {
   git_revwalk *revwalk = nullptr;
   if (git_revwalk_new(&revwalk, d->repo))
@@ -547,8 +706,26 @@ RevWalk Repository::walker(int sort) const {
 
   RevWalk walker(revwalk);
   git_revwalk_sorting(revwalk, sort);
-  foreach (const Reference &ref, refs())
-    git_revwalk_push_ref(revwalk, ref.qualifiedName().toUtf8());
+
+  RefSnapshot snapshot = refSnapshot();
+  for (const RefSnapshot::Entry &entry : snapshot.entries()) {
+    if (!entry.commit.isNull())
+      git_revwalk_push(revwalk, entry.commit);
+  }
+
+  return walker;
+}
+
+RevWalk Repository::walker(const QList<Id> &tips, int sort) const {
+  git_revwalk *revwalk = nullptr;
+  if (git_revwalk_new(&revwalk, d->repo))
+    return RevWalk();
+
+  RevWalk walker(revwalk);
+  git_revwalk_sorting(revwalk, sort);
+
+  foreach (const Id &id, tips)
+    git_revwalk_push(revwalk, id);
 
   return walker;
 }
@@ -651,7 +828,7 @@ Commit Repository::commit(const Signature &author, const Signature &committer,
 
 QList<Commit> Repository::starredCommits() const {
   QList<Commit> commits;
-  foreach (const Id &id, d->starredCommits) {
+  foreach (const Id &id, d->starredCommits.values()) {
     if (Commit commit = lookupCommit(id))
       commits.append(commit);
   }
@@ -664,23 +841,42 @@ bool Repository::isCommitStarred(const Id &commit) const {
 }
 
 void Repository::setCommitStarred(const Id &commit, bool starred) {
-  if (starred) {
-    d->starredCommits.insert(commit);
-  } else {
-    d->starredCommits.remove(commit);
-  }
+  bool changed = starred ? d->starredCommits.insert(commit)
+                         : d->starredCommits.remove(commit);
+  if (!changed)
+    return;
+
+  if (d->starredLogEntries >= kStarLogCompactThreshold &&
+      d->starredLogEntries > 2 * d->starredCommits.size() &&
+      compactStarredCommits())
+    return;
 
-  // Write to disk.
+  // Append to the log. Start with a separator in case
+  // the file was written without a trailing newline.
+  QFile file(appDir().filePath(kStarFile));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    return;
+
+  QByteArray entry = commit.toByteArray().toHex();
+  file.write('\n' + QByteArray(starred ? "+" : "-") + entry);
+  ++d->starredLogEntries;
+}
+
+bool Repository::compactStarredCommits() {
   QSaveFile file(appDir().filePath(kStarFile));
   if (!file.open(QIODevice::WriteOnly))
-    return;
+    return false;
 
   QByteArrayList ids;
-  foreach (const Id &id, d->starredCommits)
+  foreach (const Id &id, d->starredCommits.values())
     ids.append(id.toByteArray().toHex());
 
   file.write(ids.join('\n'));
-  file.commit();
+  if (!file.commit())
+    return false;
+
+  d->starredLogEntries = ids.size();
+  return true;
 }
 
 void Repository::invalidateSubmoduleCache() {
@@ -778,6 +974,12 @@ Remote Repository::anonymousRemote(const QString &url) const {
   return Remote(remote);
 }
 
+Reflog Repository::reflog(const QString &name) const {
+  git_reflog *reflog = nullptr;
+  git_reflog_read(&reflog, d->repo, name.toUtf8());
+  return Reflog(reflog);
+}
+
 Reference Repository::stashRef() const { return lookupRef("refs/stash"); }
 
 QList<Commit> Repository::stashes() const {
@@ -794,6 +996,12 @@ QList<Commit> Repository::stashes() const {
   return commits;
 }
 
+Commit Repository::lookupStash(int index) const {
+  return lookupCommit(reflog("refs/stash").id(index));
+}
+
+int Repository::stashCount() const { return reflog("refs/stash").count(); }
+
 Commit Repository::stash(const QString &message) {
   Signature signature = defaultSignature();
   if (!signature.isValid())
@@ -868,6 +1076,71 @@ Commit Repository::mergeBase(const Commit &lhs, const Commit &rhs) const {
   return Commit(commit);
 }
 
+Repository::MergePreview Repository::mergePreview(const Commit &ours,
+                                                  const Commit &theirs) const {
+  QPair<Id, Id> key(ours.id(), theirs.id());
+  QMutexLocker locker(&d->mergePreviewLock);
+  auto it = d->mergePreviews.constFind(key);
+  if (it != d->mergePreviews.constEnd())
+    return it.value();
+
+  locker.unlock();
+
+  MergePreview preview;
+  if (!ours.isValid() || !theirs.isValid())
+    return preview;
+
+  Commit base = mergeBase(ours, theirs);
+  if (base.isValid() && base.id() == theirs.id()) {
+    preview.valid = true;
+    preview.upToDate = true;
+  } else {
+    // Merge the trees in memory.
+    git_index *index = nullptr;
+    git_merge_options opts = GIT_MERGE_OPTIONS_INIT;
+    Tree ancestor = base.isValid() ? base.tree() : Tree();
+    if (git_merge_trees(&index, d->repo, ancestor, ours.tree(), theirs.tree(),
+                        &opts))
+      return preview;
+
+    preview.valid = true;
+    preview.fastForward = (base.isValid() && base.id() == ours.id());
+
+    git_index_conflict_iterator *iter = nullptr;
+    if (!git_index_conflict_iterator_new(&iter, index)) {
+      const git_index_entry *anc, *our, *their;
+      while (!git_index_conflict_next(&anc, &our, &their, iter)) {
+        const git_index_entry *entry = our ? our : their ? their : anc;
+        preview.conflicts.append(entry->path);
+      }
+
+      git_index_conflict_iterator_free(iter);
+    }
+
+    git_diff *diff = nullptr;
+    if (!git_diff_tree_to_index(&diff, d->repo, ours.tree(), index, nullptr)) {
+      git_diff_stats *stats = nullptr;
+      if (!git_diff_get_stats(&stats, diff)) {
+        preview.files = git_diff_stats_files_changed(stats);
+        preview.additions = git_diff_stats_insertions(stats);
+        preview.deletions = git_diff_stats_deletions(stats);
+        git_diff_stats_free(stats);
+      }
+
+      git_diff_free(diff);
+    }
+
+    git_index_free(index);
+  }
+
+  locker.relock();
+  if (d->mergePreviews.size() >= kMergePreviewCacheSize)
+    d->mergePreviews.clear();
+  d->mergePreviews.insert(key, preview);
+
+  return preview;
+}
+
 bool Repository::merge(const AnnotatedCommit &mergeHead) {
   int current = state();
   const git_annotated_commit *head = mergeHead;
@@ -920,6 +1193,97 @@ void Repository::rebase(const AnnotatedCommit &mergeHead,
   rebaseContinue(QStringLiteral(""));
 }
 
+/*!
+ * \brief Repository::rebaseInMemory
+ * Replay all rebase operations onto an in-memory index. Only objects are
+ * written while replaying. The workdir is materialized once, either by
+ * checking out the result or by switching to an on-disk rebase at the
+ * first conflict. Safe to call from a worker thread; progress is reported
+ * through the same notifier signals as an on-disk rebase.
+ */
+void Repository::rebaseInMemory(const AnnotatedCommit &mergeHead,
+                                RebaseCallbacks *callbacks,
+                                const QString &overrideUser,
+                                const QString &overrideEmail) {
+  // The in-memory mode doesn't check for local changes. Refuse the same
+  // way that an on-disk rebase would before anything is replayed.
+  Tree tree;
+  if (Reference ref = head()) {
+    if (Commit commit = ref.target())
+      tree = commit.tree();
+  }
+
+  git_diff *staged = nullptr;
+  git_diff_tree_to_index(&staged, d->repo, tree, nullptr, nullptr);
+  git_diff *unstaged = nullptr;
+  git_diff_index_to_workdir(&unstaged, d->repo, nullptr, nullptr);
+  if (Diff(staged).count() || Diff(unstaged).count()) {
+    git_error_set_str(GIT_ERROR_REBASE, "uncommitted changes exist in workdir");
+    emit d->notifier->rebaseInitError();
+    return;
+  }
+
+  git_rebase *r = nullptr;
+  git_rebase_options opts = GIT_REBASE_OPTIONS_INIT;
+  opts.inmemory = 1;
+  git_rebase_init(&r, d->repo, nullptr, mergeHead, nullptr, &opts);
+  Rebase rebase(d->repo, r, overrideUser, overrideEmail, true);
+  if (!rebase.isValid()) {
+    emit d->notifier->rebaseInitError();
+    return;
+  }
+
+  // Pass the count along. The rebase isn't safe to read from other threads.
+  int total = rebase.count();
+  Commit onto = mergeHead.commit();
+  while (rebase.hasNext()) {
+    // Nothing outside of the object database has been written yet.
+    if (callbacks && callbacks->isCanceled()) {
+      emit d->notifier->rebaseCanceled(rebase);
+      return;
+    }
+
+    git::Commit before = rebase.next();
+    if (!before.isValid()) {
+      emit d->notifier->rebaseCommitInvalid(rebase);
+      return;
+    }
+
+    int currCommit = rebase.currentIndex() + 1;
+    emit d->notifier->rebaseAboutToRebase(rebase, before, currCommit, total);
+
+    git::Commit after = rebase.commit(before.message());
+    if (!after.isValid()) {
+      rebaseMaterializeConflict(rebase, onto, mergeHead, overrideUser,
+                                overrideEmail);
+      return;
+    }
+
+    // Already applied patches don't move the tip.
+    if (after != before)
+      onto = after;
+
+    emit d->notifier->rebaseCommitSuccess(rebase, after, before, currCommit,
+                                          total);
+  }
+
+  // Write the final tree to the workdir once, then move HEAD.
+  if (!checkout(onto)) {
+    emit d->notifier->rebaseCommitInvalid(rebase);
+    return;
+  }
+
+  QString msg = QString("rebase (finish): %1").arg(onto.id().toString());
+  if (isHeadDetached()) {
+    setHeadDetached(onto);
+  } else {
+    head().setTarget(onto, msg);
+  }
+
+  if (rebase.finish())
+    emit d->notifier->rebaseFinished(rebase);
+}
+
 void Repository::rebaseContinue(const QString &commitMessage) {
 
   Rebase r = rebaseOpen();
@@ -928,6 +1292,7 @@ void Repository::rebaseContinue(const QString &commitMessage) {
     return;
   }
 
+  int total = r.count();
   if (r.currentIndex() != GIT_REBASE_NO_OPERATION) {
     // Rebase::next() was already called at leas once
     // externally or by a previous call of rebaseContinue
@@ -939,7 +1304,7 @@ void Repository::rebaseContinue(const QString &commitMessage) {
       return;
     } else {
       emit d->notifier->rebaseCommitSuccess(r, c, r.commitToRebase(),
-                                            r.currentIndex() + 1);
+                                            r.currentIndex() + 1, total);
       // Go on with the next rebase operation below
     }
   }
@@ -954,7 +1319,7 @@ void Repository::rebaseContinue(const QString &commitMessage) {
     int currCommit =
         r.currentIndex() +
         1; // for showing to user it makes more sense starting from 1
-    emit d->notifier->rebaseAboutToRebase(r, before, currCommit);
+    emit d->notifier->rebaseAboutToRebase(r, before, currCommit, total);
 
     QString message = before.message(); // use original message
     git::Commit after = r.commit(message);
@@ -963,7 +1328,7 @@ void Repository::rebaseContinue(const QString &commitMessage) {
       return; // before ongoing, the user has to fix the conflicts.
     }
 
-    emit d->notifier->rebaseCommitSuccess(r, after, before, currCommit);
+    emit d->notifier->rebaseCommitSuccess(r, after, before, currCommit, total);
   }
 
   if (r.finish())
@@ -1196,6 +1561,324 @@ void Repository::shutdown() { git_libgit2_shutdown(); }
 
 RepositoryNotifier::RepositoryNotifier(QObject *parent) : QObject(parent) {}
 
+Diff Repository::checkoutDiff(const Commit &commit) const {
+  Reference ref = head();
+  Commit base = ref.isValid() ? ref.target() : Commit();
+  if (!base.isValid() || !commit.isValid())
+    return Diff();
+
+  return commit.diff(base);
+}
+
+bool Repository::isParallelCheckout(const Diff &diff) {
+  return diff.isValid() && diff.count() >= kParallelCheckoutThreshold;
+}
+
+/*!
+ * \brief Repository::checkoutParallel
+ * Update the workdir and index from HEAD to the new side of the given tree
+ * diff. Blobs are inflated, filtered and written on the global thread pool
+ * and the index is updated in a single batch at the end. With
+ * GIT_CHECKOUT_SAFE, local changes to any affected path abort the checkout
+ * and other dirty files are reported with GIT_CHECKOUT_NOTIFY_DIRTY. With
+ * GIT_CHECKOUT_FORCE, dirty files are restored to HEAD as well. If any file
+ * can't be written, the affected paths are restored to HEAD.
+ */
+bool Repository::checkoutParallel(const Commit &commit, const Diff &diff,
+                                  CheckoutCallbacks *callbacks,
+                                  int strategy) {
+  Reference ref = head();
+  Commit base = ref.isValid() ? ref.target() : Commit();
+  if (!base.isValid() || !diff.isValid()) {
+    git_error_set_str(GIT_ERROR_CHECKOUT, "no commit to check out from");
+    return false;
+  }
+
+  bool force = (strategy & GIT_CHECKOUT_FORCE);
+  int flags = callbacks ? callbacks->flags() : GIT_CHECKOUT_NOTIFY_NONE;
+
+  QDir dir = workdir();
+  QSet<QByteArray> affected;
+  QVector<CheckoutJob> removals;
+  QVector<CheckoutJob> writes;
+  auto add = [&affected, &removals, &writes](git_delta_t status,
+                                             const git_diff_file &file) {
+    CheckoutJob job;
+    job.status = status;
+    job.rawPath = file.path;
+    job.path = QString::fromUtf8(job.rawPath);
+    job.id = file.id;
+    job.mode = file.mode;
+    memset(&job.entry, 0, sizeof(job.entry));
+    affected.insert(job.rawPath);
+
+    bool removed = (status == GIT_DELTA_DELETED);
+    (removed ? removals : writes).append(job);
+  };
+
+  int count = diff.count();
+  for (int i = 0; i < count; ++i) {
+    const git_diff_delta *delta = git_diff_get_delta(diff, i);
+    bool removed = (delta->status == GIT_DELTA_DELETED);
+    add(delta->status, removed ? delta->old_file : delta->new_file);
+  }
+
+  QVector<char *> rawPaths;
+  QVector<QByteArray> storage;
+  auto pathspec = [&storage, &rawPaths, &removals, &writes] {
+    storage.clear();
+    rawPaths.clear();
+    foreach (const CheckoutJob &job, removals + writes)
+      storage.append(job.rawPath);
+    for (QByteArray &path : storage)
+      rawPaths.append(path.data());
+  };
+
+  pathspec();
+
+  Tree baseTree = base.tree();
+  git_tree *tree = baseTree;
+  git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+  opts.flags |= GIT_DIFF_INCLUDE_TYPECHANGE;
+
+  // Refuse to overwrite local changes, including untracked files that
+  // are in the way of new ones.
+  if (!force) {
+    git_diff_options pathOpts = opts;
+    pathOpts.flags |= GIT_DIFF_INCLUDE_UNTRACKED |
+                      GIT_DIFF_RECURSE_UNTRACKED_DIRS |
+                      GIT_DIFF_DISABLE_PATHSPEC_MATCH;
+    pathOpts.pathspec.count = rawPaths.size();
+    pathOpts.pathspec.strings = rawPaths.data();
+
+    git_diff *dirty = nullptr;
+    if (git_diff_tree_to_workdir_with_index(&dirty, d->repo, tree, &pathOpts))
+      return false;
+
+    int conflicts = git_diff_num_deltas(dirty);
+    for (int i = 0; i < conflicts; ++i) {
+      const git_diff_delta *delta = git_diff_get_delta(dirty, i);
+      if (callbacks && (flags & GIT_CHECKOUT_NOTIFY_CONFLICT))
+        callbacks->notify('!', delta->new_file.path);
+    }
+
+    git_diff_free(dirty);
+
+    if (conflicts) {
+      QString msg = QString("%1 conflicts prevent checkout").arg(conflicts);
+      git_error_set_str(GIT_ERROR_CHECKOUT, msg.toUtf8());
+      return false;
+    }
+  }
+
+  // Report dirty files that are left alone or restore them.
+  if (force || (flags & GIT_CHECKOUT_NOTIFY_DIRTY)) {
+    git_diff *dirty = nullptr;
+    if (git_diff_tree_to_workdir_with_index(&dirty, d->repo, tree, &opts))
+      return false;
+
+    bool canceled = false;
+    int dirtyCount = git_diff_num_deltas(dirty);
+    for (int i = 0; i < dirtyCount && !canceled; ++i) {
+      const git_diff_delta *delta = git_diff_get_delta(dirty, i);
+      if (affected.contains(delta->new_file.path))
+        continue;
+
+      if (!force) {
+        canceled = callbacks && !callbacks->notify('M', delta->new_file.path);
+      } else if (delta->status == GIT_DELTA_ADDED) {
+        add(GIT_DELTA_DELETED, delta->new_file);
+      } else {
+        add(delta->status, delta->old_file);
+      }
+    }
+
+    git_diff_free(dirty);
+
+    if (canceled) {
+      git_error_set_str(GIT_ERROR_CHECKOUT, "checkout was canceled");
+      return false;
+    }
+  }
+
+  // Restore the same set of paths if writing fails.
+  pathspec();
+
+  // The last progress call is made after the updated files are reported.
+  QMutex mutex;
+  QAtomicInt current = 0;
+  int total = removals.size() + writes.size();
+  auto progress = [callbacks, total, &mutex, &current](const QString &path) {
+    int value = ++current;
+    if (!callbacks || value % 64 || value == total)
+      return;
+
+    QMutexLocker locker(&mutex);
+    callbacks->progress(path, value, total);
+  };
+
+  // Remove deleted files first so that new directories can replace them.
+  QtConcurrent::blockingMap(removals, [&dir, &progress](CheckoutJob &job) {
+    if (job.mode != GIT_FILEMODE_COMMIT)
+      job.ok = QFile::remove(dir.filePath(job.path)) ||
+               !QFileInfo::exists(dir.filePath(job.path));
+    progress(job.path);
+  });
+
+  // Prune directories that became empty.
+  foreach (const CheckoutJob &job, removals) {
+    QString parent = QFileInfo(job.path).path();
+    while (parent != "." && dir.rmdir(parent))
+      parent = QFileInfo(parent).path();
+  }
+
+  QtConcurrent::blockingMap(writes, [this, &dir,
+                                     &progress](CheckoutJob &job) {
+    QString path = dir.filePath(job.path);
+    QDir().mkpath(QFileInfo(path).path());
+
+    switch (job.mode) {
+      case GIT_FILEMODE_COMMIT:
+        // Submodules are only created as empty directories.
+        QDir().mkpath(path);
+        break;
+
+      case GIT_FILEMODE_LINK: {
+        QFile::remove(path);
+        QByteArray target = lookupBlob(job.id).content();
+#ifdef Q_OS_WIN
+        QFile file(path);
+        job.ok = file.open(QIODevice::WriteOnly) &&
+                 file.write(target) == target.size();
+#else
+        job.ok = QFile::link(QString::fromUtf8(target), path);
+#endif
+        break;
+      }
+
+      default: {
+        if (job.status == GIT_DELTA_TYPECHANGE)
+          QFile::remove(path);
+
+        Blob blob = lookupBlob(job.id);
+        QByteArray content = filters(job.path, blob).apply(blob);
+
+        QFile file(path);
+        job.ok = blob.isValid() &&
+                 file.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+                 file.write(content) == content.size();
+        file.close();
+
+        QFileDevice::Permissions exec = QFileDevice::ExeOwner |
+                                        QFileDevice::ExeGroup |
+                                        QFileDevice::ExeOther;
+        QFileDevice::Permissions perms = file.permissions();
+        if (job.mode == GIT_FILEMODE_BLOB_EXECUTABLE) {
+          file.setPermissions(perms | exec);
+        } else if (perms & exec) {
+          file.setPermissions(perms & ~exec);
+        }
+        break;
+      }
+    }
+
+    if (job.mode != GIT_FILEMODE_COMMIT)
+      stat_entry(path, job.entry);
+    progress(job.path);
+  });
+
+  QStringList failed;
+  foreach (const CheckoutJob &job, removals + writes) {
+    if (!job.ok)
+      failed.append(job.path);
+  }
+
+  // Update the index in one batch.
+  Index idx = index();
+  if (!failed.isEmpty() || !idx.isValid()) {
+    // Put the affected paths back the way they were at HEAD. The index
+    // hasn't been touched. Paths that only exist on the new side are
+    // untracked now and are removed.
+    git_checkout_options restore = GIT_CHECKOUT_OPTIONS_INIT;
+    restore.checkout_strategy = GIT_CHECKOUT_FORCE |
+                                GIT_CHECKOUT_REMOVE_UNTRACKED |
+                                GIT_CHECKOUT_DISABLE_PATHSPEC_MATCH;
+    restore.paths.count = rawPaths.size();
+    restore.paths.strings = rawPaths.data();
+
+    git_object *obj = reinterpret_cast<git_object *>(tree);
+    bool restored = !git_checkout_tree(d->repo, obj, &restore);
+
+    QString path = failed.isEmpty() ? QString() : failed.first();
+    QString msg = restored ? "failed to write '%1', the workdir was restored"
+                           : "failed to write '%1' and restore the workdir";
+    git_error_set_str(GIT_ERROR_CHECKOUT, msg.arg(path).toUtf8());
+    return false;
+  }
+
+  foreach (const CheckoutJob &job, removals)
+    git_index_remove(idx, job.rawPath, 0);
+
+  for (CheckoutJob &job : writes) {
+    job.entry.id = job.id;
+    job.entry.mode = job.mode;
+    job.entry.path = job.rawPath.constData();
+    git_index_add(idx, &job.entry);
+  }
+
+  if (git_index_write(idx))
+    return false;
+
+  if (callbacks) {
+    QVector<CheckoutJob> jobs = removals + writes;
+    if (flags & GIT_CHECKOUT_NOTIFY_UPDATED) {
+      foreach (const CheckoutJob &job, jobs)
+        callbacks->notify(Diff::statusChar(job.status), job.path);
+    }
+
+    if (!jobs.isEmpty())
+      callbacks->progress(jobs.last().path, total, total);
+  }
+
+  return true;
+}
+
+// Hand a conflicting in-memory operation over to an on-disk rebase of the
+// remaining operations so that the user can resolve it in the workdir.
+void Repository::rebaseMaterializeConflict(const Rebase &rebase,
+                                           const Commit &onto,
+                                           const AnnotatedCommit &mergeHead,
+                                           const QString &overrideUser,
+                                           const QString &overrideEmail) {
+  // Replay everything after the last applied operation onto its result.
+  AnnotatedCommit upstream = mergeHead;
+  AnnotatedCommit target;
+  size_t index = rebase.currentIndex();
+  if (index > 0) {
+    git_rebase *ptr = rebase.d.data();
+    git_rebase_operation *op = git_rebase_operation_byindex(ptr, index - 1);
+    upstream = lookupCommit(op->id).annotatedCommit();
+    target = onto.annotatedCommit();
+  }
+
+  git_rebase *r = nullptr;
+  git_rebase_options opts = GIT_REBASE_OPTIONS_INIT;
+  git_rebase_init(&r, d->repo, nullptr, upstream, target, &opts);
+  Rebase disk(d->repo, r, overrideUser, overrideEmail);
+  if (!disk.isValid()) {
+    emit d->notifier->rebaseInitError();
+    return;
+  }
+
+  if (!disk.next().isValid()) {
+    emit d->notifier->rebaseCommitInvalid(disk);
+    rebaseAbort();
+    return;
+  }
+
+  emit d->notifier->rebaseConflict(disk);
+}
+
 void Repository::ensureSubmodulesCached() const {
   if (!d->submodulesCached) {
     d->submodulesCached = true;
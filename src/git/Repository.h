@@ -15,14 +15,20 @@
 #include "Blob.h"
 #include "Commit.h"
 #include "Diff.h"
+#include "IdHash.h"
+#include "Identities.h"
 #include "Index.h"
 #include "Rebase.h"
+#include "RefSnapshot.h"
+#include "Reflog.h"
 #include "git2/checkout.h"
 #include "git2/errors.h"
 #include "git2/revwalk.h"
 #include "git2/types.h"
 #include <QCoreApplication>
 #include <QDir>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QSet>
 #include <QSharedPointer>
@@ -39,6 +45,7 @@ class FilterList;
 class Id;
 class Rebase;
 class Reference;
+class ReferenceCatalog;
 class Remote;
 class RepositoryNotifier;
 class RevWalk;
@@ -59,6 +66,24 @@ public:
     virtual void progress(const QString &path, int current, int total) {}
   };
 
+  class RebaseCallbacks {
+  public:
+    // Checked before each operation of an in-memory rebase.
+    virtual bool isCanceled() const { return false; }
+  };
+
+  // Outcome of merging two commits, computed without touching
+  // the index or the working directory.
+  struct MergePreview {
+    bool valid = false;
+    bool upToDate = false;
+    bool fastForward = false;
+    QStringList conflicts;
+    int files = 0;
+    int additions = 0;
+    int deletions = 0;
+  };
+
   struct LfsTracking {
     QStringList included;
     QStringList excluded;
@@ -84,6 +109,10 @@ public:
   Config gitConfig() const;
   Config appConfig() const;
 
+  // Typed app config values that are read on hot paths. They come from
+  // the same cached snapshot as appConfig().
+  bool isUntrackedHidden() const;
+
   // bare
   bool isBare() const;
 
@@ -96,6 +125,13 @@ public:
   Signature signature(const QString &name, const QString &email,
                       const QDateTime &date);
 
+  // The identity table is created on first use and shared by all handles.
+  Identities *identities() const;
+
+  // The reference catalog is created on first use and shared by all
+  // handles. It must only be used from the main thread.
+  ReferenceCatalog *referenceCatalog() const;
+
   // ignore
   bool isIgnored(const QString &path) const;
 
@@ -111,9 +147,14 @@ public:
   Diff diffIndexToWorkdir(const Index &index = Index(),
                           Diff::Callbacks *callbacks = nullptr,
                           bool ignoreWhitespace = false) const;
+  Diff diffTreeToTree(const Tree &oldTree, const Tree &newTree) const;
 
   // refs
   QList<Reference> refs() const;
+
+  // The snapshot is shared by all handles and reread when the ref files
+  // change or the notifier reports a reference change.
+  RefSnapshot refSnapshot() const;
   Reference lookupRef(const QString &name) const;
 
   Reference head() const;
@@ -142,8 +183,15 @@ public:
   // blob
   Blob lookupBlob(const Id &id) const;
 
+  // tree
+  Tree lookupTree(const Id &id) const;
+
+  // reflog
+  Reflog reflog(const QString &name) const;
+
   // commit
   RevWalk walker(int sort = GIT_SORT_NONE) const;
+  RevWalk walker(const QList<Id> &tips, int sort = GIT_SORT_NONE) const;
   Commit lookupCommit(const QString &prefix) const;
   Commit lookupCommit(const Id &id) const;
   Commit commit(const QString &message,
@@ -178,6 +226,8 @@ public:
   // stash
   Reference stashRef() const;
   QList<Commit> stashes() const;
+  Commit lookupStash(int index) const;
+  int stashCount() const;
   Commit stash(const QString &message = QString());
   bool applyStash(int index = 0);
   bool dropStash(int index = 0);
@@ -192,6 +242,7 @@ public:
 
   // merge/rebase
   Commit mergeBase(const Commit &lhs, const Commit &rhs) const;
+  MergePreview mergePreview(const Commit &ours, const Commit &theirs) const;
   bool merge(const AnnotatedCommit &mergeHead);
   enum class RebaseStatus {
     Init,
@@ -207,6 +258,10 @@ public:
   void rebase(const AnnotatedCommit &mergeHead,
               const QString &overrideUser = QString(),
               const QString &overrideEmail = QString());
+  void rebaseInMemory(const AnnotatedCommit &mergeHead,
+                      RebaseCallbacks *callbacks = nullptr,
+                      const QString &overrideUser = QString(),
+                      const QString &overrideEmail = QString());
   Rebase rebaseOpen();
   void rebaseAbort();
   void rebaseContinue(const QString &commitMessage);
@@ -220,6 +275,19 @@ public:
                 const QStringList &paths = QStringList(),
                 int strategy = GIT_CHECKOUT_SAFE);
 
+  // The diff from HEAD to the given commit. Whole-tree checkouts and hard
+  // resets of large diffs should go through the parallel writer and be
+  // run off the GUI thread. The diff is computed once and handed to it.
+  Diff checkoutDiff(const Commit &commit) const;
+  static bool isParallelCheckout(const Diff &diff);
+
+  // Write the given diff from HEAD to the commit into the workdir and
+  // index in parallel. The strategy is GIT_CHECKOUT_SAFE or
+  // GIT_CHECKOUT_FORCE. The workdir is restored if any file fails.
+  bool checkoutParallel(const Commit &commit, const Diff &diff,
+                        CheckoutCallbacks *callbacks = nullptr,
+                        int strategy = GIT_CHECKOUT_SAFE);
+
   // Clean up after merge/rebase/cherry-pick/etc.
   int state() const;
   void cleanupState();
@@ -274,13 +342,41 @@ private:
     QSet<QString> lfsLocks;
     bool lfsLocksCached = false;
 
-    QSet<Id> starredCommits;
+    IdSet starredCommits;
+    int starredLogEntries = 0;
+
+    // The app config is parsed once and shared by all handles. It's
+    // revalidated against the modification stamps of its backing files.
+    QMutex appConfigLock;
+    QSharedPointer<Config> appConfig;
+    QList<qint64> appConfigStamp;
+    bool untrackedHidden = false;
+
+    QMutex identitiesLock;
+    QSharedPointer<Identities> identities;
+
+    // owned by the notifier
+    ReferenceCatalog *referenceCatalog = nullptr;
+
+    QMutex refSnapshotLock;
+    RefSnapshot refSnapshot;
+
+    // Merge previews keyed by (ours, theirs).
+    QMutex mergePreviewLock;
+    QHash<QPair<Id, Id>, MergePreview> mergePreviews;
   };
 
   Repository(git_repository *repo);
   operator git_repository *() const;
 
   void ensureSubmodulesCached() const;
+  void ensureAppConfigCached() const;
+  bool compactStarredCommits();
+
+  void rebaseMaterializeConflict(const Rebase &rebase, const Commit &onto,
+                                 const AnnotatedCommit &mergeHead,
+                                 const QString &overrideUser,
+                                 const QString &overrideEmail);
 
   QByteArray lfsExecute(const QStringList &args,
                         const QByteArray &input = QByteArray()) const;
@@ -300,6 +396,7 @@ private:
   friend class Patch;
   friend class Rebase;
   friend class Reference;
+  friend class ReferenceCatalog;
   friend class Remote;
   friend class Submodule;
   friend class TagRef;
@@ -334,11 +431,13 @@ signals:
 
   void rebaseInitError();
   void rebaseCommitInvalid(const Rebase rebase);
-  void rebaseAboutToRebase(const Rebase rebase, const Commit before, int count);
+  void rebaseAboutToRebase(const Rebase rebase, const Commit before, int count,
+                           int total);
   void rebaseFinished(const Rebase rebase);
   void rebaseCommitSuccess(const Rebase rebase, const Commit before,
-                           const Commit after, int counter);
+                           const Commit after, int counter, int total);
   void rebaseConflict(const Rebase rebase);
+  void rebaseCanceled(const Rebase rebase);
 
   void lfsNotFound();
   void lfsLocksChanged();
@@ -30,6 +30,8 @@ RevWalk::RevWalk() {}
 
 RevWalk::RevWalk(git_revwalk *walker) : d(walker, git_revwalk_free) {}
 
+bool RevWalk::hide(const Id &id) { return !git_revwalk_hide(d.data(), id); }
+
 bool RevWalk::hide(const Commit &commit) {
   return !git_revwalk_hide(d.data(), commit);
 }
@@ -39,6 +41,8 @@ bool RevWalk::hide(const Reference &ref) {
   return commit.isValid() ? hide(commit) : false;
 }
 
+bool RevWalk::push(const Id &id) { return !git_revwalk_push(d.data(), id); }
+
 bool RevWalk::push(const Commit &commit) {
   return !git_revwalk_push(d.data(), commit);
 }
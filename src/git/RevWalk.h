@@ -17,6 +17,7 @@ struct git_revwalk;
 namespace git {
 
 class Commit;
+class Id;
 class Reference;
 
 class RevWalk {
@@ -25,9 +26,11 @@ public:
 
   bool isValid() const { return !d.isNull(); }
 
+  bool hide(const Id &id);
   bool hide(const Commit &commit);
   bool hide(const Reference &ref);
 
+  bool push(const Id &id);
   bool push(const Commit &commit);
   bool push(const Reference &ref);
 
@@ -40,6 +40,16 @@ Object Tree::object(int index) const {
   return Object(obj);
 }
 
+Id Tree::id(int index) const {
+  const git_tree_entry *entry = git_tree_entry_byindex(*this, index);
+  return git_tree_entry_id(entry);
+}
+
+git_object_t Tree::type(int index) const {
+  const git_tree_entry *entry = git_tree_entry_byindex(*this, index);
+  return git_tree_entry_type(entry);
+}
+
 Id Tree::id(const QString &path) const {
   git_tree_entry *entry = nullptr;
   if (git_tree_entry_bypath(&entry, *this, path.toUtf8()))
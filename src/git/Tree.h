@@ -24,6 +24,10 @@ public:
   QString name(int index) const;
   Object object(int index) const;
 
+  // entry attributes that don't require a lookup
+  Id id(int index) const;
+  git_object_t type(int index) const;
+
   Id id(const QString &path) const;
 
 private:
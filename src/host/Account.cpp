@@ -31,7 +31,8 @@ const QString kThemeIconFmt = ":/%1_%2.png";
 
 Account::Account(const QString &username)
     : mUsername(username), mError(new AccountError(this)),
-      mProgress(new AccountProgress(this)), mMgr(new QNetworkAccessManager()) {
+      mProgress(new AccountProgress(this)), mMgr(new QNetworkAccessManager()),
+      mClient(new ApiClient(mMgr, this)) {
   QObject::connect(
       mMgr, &QNetworkAccessManager::sslErrors,
       [this](QNetworkReply *reply, const QList<QSslError> &errors) {
@@ -272,6 +273,7 @@ void Account::startProgress() {
 }
 
 void Account::clearRepos() {
+  mClient->abort();
   qDeleteAll(mRepos);
   mRepos.clear();
   mRepoPaths.clear();
@@ -303,6 +305,17 @@ bool Account::setHeaders(QNetworkRequest &request,
   return true;
 }
 
+void Account::requestPages(const QNetworkRequest &request,
+                           const ApiClient::PageCallback &callback) {
+  mClient->get(request, callback, [this](const QNetworkReply *reply) {
+    if (reply)
+      setErrorReply(*reply);
+    mProgress->finish();
+  });
+
+  startProgress();
+}
+
 AccountError::AccountError(Account *parent) : QObject(parent) {}
 
 Account *AccountError::account() const {
@@ -10,6 +10,7 @@
 #ifndef ACCOUNT_H
 #define ACCOUNT_H
 
+#include "ApiClient.h"
 #include "Repository.h"
 #include <QNetworkAccessManager>
 #include <QObject>
@@ -105,6 +106,10 @@ protected:
   void startProgress();
   bool setHeaders(QNetworkRequest &request, const QString &defaultPassword);
 
+  // Request every page of a repository list.
+  void requestPages(const QNetworkRequest &request,
+                    const ApiClient::PageCallback &callback);
+
   QString mUrl;
   QString mUsername;
   QString mAccessToken;
@@ -115,6 +120,7 @@ protected:
   AccountError *mError;
   AccountProgress *mProgress;
   QNetworkAccessManager *mMgr;
+  ApiClient *mClient;
 
 private:
   QList<QSslError> sslErrors;
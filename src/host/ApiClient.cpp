@@ -0,0 +1,239 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "ApiClient.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrlQuery>
+
+namespace {
+
+const QString kPageKey = "page";
+
+// Don't flood the host when it reports an absurd page count.
+const int kMaxParallelPages = 500;
+
+QMap<QString, QString> parseLinks(const QByteArray &link) {
+  QMap<QString, QString> map;
+  QRegularExpression re("<(.*)>; rel=\"(\\w+)\"");
+  foreach (const QString &record, QString::fromUtf8(link).split(", ")) {
+    QRegularExpressionMatch match = re.match(record);
+    if (match.isValid() && match.hasMatch())
+      map.insert(match.captured(2), match.captured(1));
+  }
+
+  return map;
+}
+
+QUrl pageUrl(const QUrl &url, int page) {
+  QUrlQuery query(url);
+  query.removeAllQueryItems(kPageKey);
+  query.addQueryItem(kPageKey, QString::number(page));
+
+  QUrl result = url;
+  result.setQuery(query);
+  return result;
+}
+
+} // namespace
+
+ApiClient::ApiClient(QNetworkAccessManager *mgr, QObject *parent)
+    : QObject(parent), mMgr(mgr), mCacheDir(defaultCacheDir()) {}
+
+void ApiClient::get(const QNetworkRequest &request,
+                    const PageCallback &callback,
+                    const FinishedCallback &finished) {
+  abort();
+
+  mRequest = request;
+  mCallback = callback;
+  mFinished = finished;
+  this->request(1, request.url());
+}
+
+void ApiClient::abort() {
+  // Ignore replies that are still in flight.
+  ++mGeneration;
+
+  QList<QNetworkReply *> replies = mReplies;
+  mReplies.clear();
+  foreach (QNetworkReply *reply, replies)
+    reply->abort();
+
+  mNextPage = 1;
+  mPageCountKnown = false;
+  mPages.clear();
+  mCallback = PageCallback();
+  mFinished = FinishedCallback();
+}
+
+QString ApiClient::defaultCacheDir() {
+  QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+  return dir.filePath("host");
+}
+
+void ApiClient::request(int page, const QUrl &url) {
+  QNetworkRequest request = mRequest;
+  request.setUrl(url);
+
+  // Revalidate cached pages.
+  QString path = cachePath(request);
+  Entry entry = readCache(path);
+  if (!entry.etag.isEmpty())
+    request.setRawHeader("If-None-Match", entry.etag);
+
+  QNetworkReply *reply = mMgr->get(request);
+  mReplies.append(reply);
+
+  int generation = mGeneration;
+  connect(reply, &QNetworkReply::finished, this,
+          [this, reply, page, url, generation] {
+            reply->deleteLater();
+            if (generation == mGeneration)
+              handle(reply, page, url);
+          });
+}
+
+void ApiClient::handle(QNetworkReply *reply, int page, const QUrl &url) {
+  mReplies.removeOne(reply);
+
+  if (reply->error() != QNetworkReply::NoError) {
+    finish(reply);
+    return;
+  }
+
+  QString path = cachePath(reply->request());
+  int status =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+  Entry entry;
+  if (status == 304) {
+    entry = readCache(path);
+    if (entry.etag.isEmpty()) {
+      // The cache entry vanished. Request it again unconditionally.
+      request(page, url);
+      return;
+    }
+  } else {
+    entry.etag = reply->rawHeader("ETag");
+    entry.link = reply->rawHeader("Link");
+    entry.body = reply->readAll();
+    if (!entry.etag.isEmpty())
+      writeCache(path, entry);
+  }
+
+  // Parse each page as it arrives.
+  QJsonDocument doc = QJsonDocument::fromJson(entry.body);
+  if (!mPageCountKnown)
+    requestRemaining(page, doc, entry.link);
+
+  mPages.insert(page, doc);
+  deliver();
+}
+
+void ApiClient::requestRemaining(int page, const QJsonDocument &doc,
+                                 const QByteArray &link) {
+  QMap<QString, QString> links = parseLinks(link);
+  QUrl next(links.value("next"));
+  QUrl last(links.value("last"));
+
+  int count = 0;
+  if (last.isValid()) {
+    count = QUrlQuery(last).queryItemValue(kPageKey).toInt();
+  } else if (doc.isObject()) {
+    // Bitbucket reports the total size and the next page in the body.
+    QJsonObject obj = doc.object();
+    if (!next.isValid())
+      next = QUrl(obj.value("next").toString());
+    int size = obj.value("size").toInt();
+    int pagelen = obj.value("pagelen").toInt();
+    if (next.isValid() && size > 0 && pagelen > 0) {
+      last = next;
+      count = (size + pagelen - 1) / pagelen;
+    }
+  }
+
+  if (page == 1 && count > 1 && count <= kMaxParallelPages) {
+    mPageCountKnown = true;
+    for (int i = 2; i <= count; ++i)
+      request(i, pageUrl(last, i));
+    return;
+  }
+
+  // Fall back to following one page after another.
+  if (next.isValid())
+    request(page + 1, next);
+}
+
+void ApiClient::deliver() {
+  while (mPages.contains(mNextPage)) {
+    QJsonDocument doc = mPages.take(mNextPage++);
+    int generation = mGeneration;
+    mCallback(doc);
+
+    // The callback may have started a new request.
+    if (generation != mGeneration)
+      return;
+  }
+
+  if (mReplies.isEmpty() && mPages.isEmpty())
+    finish(nullptr);
+}
+
+void ApiClient::finish(const QNetworkReply *error) {
+  FinishedCallback finished = mFinished;
+  abort();
+
+  if (finished)
+    finished(error);
+}
+
+QString ApiClient::cachePath(const QNetworkRequest &request) const {
+  if (mCacheDir.isEmpty())
+    return QString();
+
+  // Credentials are part of the key. Different users see different lists.
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(request.url().toEncoded());
+  hash.addData(request.rawHeader("Authorization"));
+  return QDir(mCacheDir).filePath(hash.result().toHex());
+}
+
+ApiClient::Entry ApiClient::readCache(const QString &path) const {
+  Entry entry;
+  QFile file(path);
+  if (path.isEmpty() || !file.open(QIODevice::ReadOnly))
+    return entry;
+
+  QDataStream in(&file);
+  in >> entry.etag >> entry.link >> entry.body;
+  if (in.status() != QDataStream::Ok)
+    return Entry();
+
+  return entry;
+}
+
+void ApiClient::writeCache(const QString &path, const Entry &entry) const {
+  if (path.isEmpty() || !QDir().mkpath(mCacheDir))
+    return;
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return;
+
+  QDataStream out(&file);
+  out << entry.etag << entry.link << entry.body;
+  file.commit();
+}
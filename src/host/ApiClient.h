@@ -0,0 +1,81 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef APICLIENT_H
+#define APICLIENT_H
+
+#include <QJsonDocument>
+#include <QList>
+#include <QMap>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QUrl>
+#include <functional>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Fetches paginated JSON lists from hosting provider APIs. Responses are
+// cached on disk and revalidated with If-None-Match. Once the number of
+// pages is known, the remaining pages are requested all at once.
+class ApiClient : public QObject {
+  Q_OBJECT
+
+public:
+  using PageCallback = std::function<void(const QJsonDocument &)>;
+
+  // The reply is null on success.
+  using FinishedCallback = std::function<void(const QNetworkReply *)>;
+
+  ApiClient(QNetworkAccessManager *mgr, QObject *parent = nullptr);
+
+  // An empty directory disables the cache.
+  QString cacheDir() const { return mCacheDir; }
+  void setCacheDir(const QString &dir) { mCacheDir = dir; }
+
+  // Request every page starting at the given request. Pages are passed to
+  // the callback in order as soon as all preceding pages are parsed. Any
+  // previous request is aborted.
+  void get(const QNetworkRequest &request, const PageCallback &callback,
+           const FinishedCallback &finished);
+  void abort();
+
+  static QString defaultCacheDir();
+
+private:
+  struct Entry {
+    QByteArray etag;
+    QByteArray link;
+    QByteArray body;
+  };
+
+  void request(int page, const QUrl &url);
+  void handle(QNetworkReply *reply, int page, const QUrl &url);
+  void requestRemaining(int page, const QJsonDocument &doc,
+                        const QByteArray &link);
+  void deliver();
+  void finish(const QNetworkReply *error);
+
+  QString cachePath(const QNetworkRequest &request) const;
+  Entry readCache(const QString &path) const;
+  void writeCache(const QString &path, const Entry &entry) const;
+
+  QNetworkAccessManager *mMgr;
+  QString mCacheDir;
+
+  // state of the current request
+  int mGeneration = 0;
+  int mNextPage = 1;
+  bool mPageCountKnown = false;
+  QNetworkRequest mRequest;
+  PageCallback mCallback;
+  FinishedCallback mFinished;
+  QMap<int, QJsonDocument> mPages;
+  QList<QNetworkReply *> mReplies;
+};
+
+#endif
@@ -17,36 +17,7 @@
 #include <QNetworkRequest>
 #include <QUrl>
 
-Beanstalk::Beanstalk(const QString &username) : Account(username) {
-  QObject::connect(
-      mMgr, &QNetworkAccessManager::finished, this,
-      [this](QNetworkReply *reply) {
-        reply->deleteLater();
-
-        if (reply->error() == QNetworkReply::NoError) {
-          QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-          QJsonArray array = doc.array();
-          for (int i = 0; i < array.size(); ++i) {
-            QJsonObject obj = array.at(i).toObject();
-            obj = obj.value("repository").toObject();
-            if (obj.value("vcs").toString() != "git")
-              continue;
-
-            QString name = obj.value("name").toString();
-            QString httpsUrl = obj.value("repository_url_https").toString();
-            QString sshUrl = obj.value("repository_url").toString();
-
-            Repository *repo = addRepository(name, name);
-            repo->setUrl(Repository::Https, httpsUrl);
-            repo->setUrl(Repository::Ssh, sshUrl);
-          }
-        } else {
-          setErrorReply(*reply);
-        }
-
-        mProgress->finish();
-      });
-}
+Beanstalk::Beanstalk(const QString &username) : Account(username) {}
 
 Account::Kind Beanstalk::kind() const { return Account::Beanstalk; }
 
@@ -61,8 +32,23 @@ void Beanstalk::connect(const QString &password) {
 
   QNetworkRequest request(url() + "/api/repositories.json");
   if (setHeaders(request, password)) {
-    mMgr->get(request);
-    startProgress();
+    requestPages(request, [this](const QJsonDocument &doc) {
+      QJsonArray array = doc.array();
+      for (int i = 0; i < array.size(); ++i) {
+        QJsonObject obj = array.at(i).toObject();
+        obj = obj.value("repository").toObject();
+        if (obj.value("vcs").toString() != "git")
+          continue;
+
+        QString name = obj.value("name").toString();
+        QString httpsUrl = obj.value("repository_url_https").toString();
+        QString sshUrl = obj.value("repository_url").toString();
+
+        Repository *repo = addRepository(name, name);
+        repo->setUrl(Repository::Https, httpsUrl);
+        repo->setUrl(Repository::Ssh, sshUrl);
+      }
+    });
   }
 }
 
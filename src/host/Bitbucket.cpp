@@ -21,62 +21,10 @@ namespace {
 
 const QString kSshFmt = "git@bitbucket.org:%1";
 const QString kContentType = "application/json";
-const char *kPasswordProperty = "password";
 
 } // namespace
 
-Bitbucket::Bitbucket(const QString &username) : Account(username) {
-  QObject::connect(
-      mMgr, &QNetworkAccessManager::finished, this,
-      [this](QNetworkReply *reply) {
-        QString password = reply->property(kPasswordProperty).toString();
-        if (password.isEmpty())
-          return;
-
-        reply->deleteLater();
-
-        if (reply->error() != QNetworkReply::NoError) {
-          setErrorReply(*reply);
-          mProgress->finish();
-          return;
-        }
-
-        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = doc.object();
-        QJsonArray array = jsonObject["values"].toArray();
-        for (int i = 0; i < array.size(); ++i) {
-          QJsonObject obj = array.at(i).toObject();
-          QJsonObject repository = obj.value("repository").toObject();
-
-          QString name = repository.value("name").toString();
-          QString fullName = repository.value("full_name").toString();
-
-          QUrl httpsUrl;
-          httpsUrl.setHost(host());
-          httpsUrl.setScheme("https");
-          httpsUrl.setUserName(this->username());
-          httpsUrl.setPath(QString("/%1").arg(fullName));
-
-          Repository *repo = addRepository(name, fullName);
-          repo->setUrl(Repository::Https, httpsUrl.toString());
-          repo->setUrl(Repository::Ssh, kSshFmt.arg(fullName));
-        }
-
-        QString next = jsonObject["next"].toString();
-        if (next.isEmpty()) {
-          mProgress->finish();
-          return;
-        }
-
-        // Request next page.
-        QNetworkRequest request(next);
-        if (setHeaders(request, password)) {
-          QNetworkReply *reply = mMgr->get(request);
-          reply->setProperty(kPasswordProperty, password);
-          startProgress();
-        }
-      });
-}
+Bitbucket::Bitbucket(const QString &username) : Account(username) {}
 
 Account::Kind Bitbucket::kind() const { return Account::Bitbucket; }
 
@@ -93,10 +41,26 @@ void Bitbucket::connect(const QString &password) {
   request.setHeader(QNetworkRequest::ContentTypeHeader, kContentType);
 
   if (setHeaders(request, password)) {
-    QNetworkReply *reply = mMgr->get(request);
-    reply->setProperty(kPasswordProperty,
-                       !password.isEmpty() ? password : this->password());
-    startProgress();
+    requestPages(request, [this](const QJsonDocument &doc) {
+      QJsonArray array = doc.object().value("values").toArray();
+      for (int i = 0; i < array.size(); ++i) {
+        QJsonObject obj = array.at(i).toObject();
+        QJsonObject repository = obj.value("repository").toObject();
+
+        QString name = repository.value("name").toString();
+        QString fullName = repository.value("full_name").toString();
+
+        QUrl httpsUrl;
+        httpsUrl.setHost(host());
+        httpsUrl.setScheme("https");
+        httpsUrl.setUserName(this->username());
+        httpsUrl.setPath(QString("/%1").arg(fullName));
+
+        Repository *repo = addRepository(name, fullName);
+        repo->setUrl(Repository::Https, httpsUrl.toString());
+        repo->setUrl(Repository::Ssh, kSshFmt.arg(fullName));
+      }
+    });
   }
 }
 
@@ -19,14 +19,11 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QRandomGenerator>
-#include <QRegularExpression>
 #include <QUrl>
 #include <QUrlQuery>
 
 namespace {
 
-const char *kPasswordProperty = "password";
-
 const QString kScope = "repo";
 
 const QString kAuthUrl =
@@ -37,69 +34,7 @@ const QString kGraphQlUrl = QStringLiteral("https://try.gitea.io/graphql");
 
 } // namespace
 
-Gitea::Gitea(const QString &username) : Account(username) {
-  QObject::connect(
-      mMgr, &QNetworkAccessManager::finished, this,
-      [this](QNetworkReply *reply) {
-        QString password = reply->property(kPasswordProperty).toString();
-        if (password.isEmpty())
-          return;
-
-        reply->deleteLater();
-
-        if (reply->error() != QNetworkReply::NoError) {
-          setErrorReply(*reply);
-          mProgress->finish();
-          return;
-        }
-
-        // Handle repositories.
-        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-        QJsonArray array = doc.array();
-        for (int i = 0; i < array.size(); ++i) {
-          QJsonObject obj = array.at(i).toObject();
-
-          // Add username to HTTPS URL.
-          QUrl httpsUrl(obj.value("clone_url").toString());
-          httpsUrl.setUserName(this->username());
-
-          QString name = obj.value("name").toString();
-          QString fullName = obj.value("full_name").toString();
-          Repository *repo = addRepository(name, fullName);
-          repo->setUrl(Repository::Https, httpsUrl.toString());
-          repo->setUrl(Repository::Ssh, obj.value("ssh_url").toString());
-        }
-
-        // Check for additional pages.
-        QString link = reply->rawHeader("Link");
-        if (link.isEmpty()) {
-          mProgress->finish();
-          return;
-        }
-
-        QMap<QString, QString> map;
-        QRegularExpression re("<(.*)>; rel=\"(\\w+)\"");
-        foreach (const QString &record, link.split(", ")) {
-          QRegularExpressionMatch match = re.match(record);
-          if (match.isValid() && match.hasMatch())
-            map.insert(match.captured(2), match.captured(1));
-        }
-
-        QString next = map.value("next");
-        if (next.isEmpty()) {
-          mProgress->finish();
-          return;
-        }
-
-        // Request next page.
-        QNetworkRequest request(next);
-        if (setHeaders(request, password)) {
-          QNetworkReply *reply = mMgr->get(request);
-          reply->setProperty(kPasswordProperty, password);
-          startProgress();
-        }
-      });
-}
+Gitea::Gitea(const QString &username) : Account(username) {}
 
 Account::Kind Gitea::kind() const { return Account::Gitea; }
 
@@ -113,10 +48,23 @@ void Gitea::connect(const QString &password) {
   QString suffix = hasCustomUrl() ? "/api/v1" : QString();
   QNetworkRequest request(url() + suffix + "/user/repos");
   if (setHeaders(request, password)) {
-    QNetworkReply *reply = mMgr->get(request);
-    reply->setProperty(kPasswordProperty,
-                       !password.isEmpty() ? password : this->password());
-    startProgress();
+    requestPages(request, [this](const QJsonDocument &doc) {
+      // Handle repositories.
+      QJsonArray array = doc.array();
+      for (int i = 0; i < array.size(); ++i) {
+        QJsonObject obj = array.at(i).toObject();
+
+        // Add username to HTTPS URL.
+        QUrl httpsUrl(obj.value("clone_url").toString());
+        httpsUrl.setUserName(this->username());
+
+        QString name = obj.value("name").toString();
+        QString fullName = obj.value("full_name").toString();
+        Repository *repo = addRepository(name, fullName);
+        repo->setUrl(Repository::Https, httpsUrl.toString());
+        repo->setUrl(Repository::Ssh, obj.value("ssh_url").toString());
+      }
+    });
   }
 }
 
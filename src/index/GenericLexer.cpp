@@ -49,7 +49,7 @@ Lexer::Lexeme GenericLexer::next() {
       case Nothing:
         if (kOperators.contains(ch)) {
           ++mIndex; // advance
-          return {Operator, QByteArray(1, ch)};
+          return {Operator, QByteArray(1, ch), mIndex - 1};
         } else if (ch == '_' || alpha) {
           startPos = mIndex;
           state = alpha ? Identifier : Whitespace;
@@ -76,20 +76,21 @@ Lexer::Lexeme GenericLexer::next() {
         bool compound = ((ch == '\'' && isAlpha(nextCh)) ||
                          (ch == '-' && (isAlpha(nextCh) || isDigit(nextCh))));
         if (ch != '_' && !alpha && !digit && !compound)
-          return {Identifier, mBuffer.mid(startPos, mIndex - startPos)};
+          return {Identifier, mBuffer.mid(startPos, mIndex - startPos),
+                  startPos};
         break;
       }
 
       case Number:
         // FIXME: Support .?
         if (!alpha && !digit)
-          return {Number, mBuffer.mid(startPos, mIndex - startPos)};
+          return {Number, mBuffer.mid(startPos, mIndex - startPos), startPos};
         break;
 
       case String:
         if (ch == '"') {
           ++mIndex; // advance
-          return {String, mBuffer.mid(startPos, mIndex - startPos)};
+          return {String, mBuffer.mid(startPos, mIndex - startPos), startPos};
         }
         break;
 
@@ -0,0 +1,385 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Grep.h"
+#include "GenericLexer.h"
+#include "TrigramIndex.h"
+#include "git/Blob.h"
+#include "git/Repository.h"
+#include <QRegularExpression>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Stop reporting after this many matches.
+const int kMaxMatches = 10000;
+
+const int kMaxLineLength = 500;
+
+struct Line {
+  int number;
+  int start;
+  int end;
+};
+
+// Maps increasing offsets to lines. Newlines are counted lazily between
+// consecutive hits, so buffers without matches are never split into lines.
+template <typename T> class LineIndex {
+public:
+  LineIndex(const T *data, int size) : mData(data), mSize(size) {}
+
+  Line at(int offset) {
+    int start = offset;
+    while (start > mPos && mData[start - 1] != '\n')
+      --start;
+
+    if (start > mPos) {
+      mNumber += std::count(mData + mPos, mData + start, T('\n'));
+      mStart = start;
+      mPos = start;
+    }
+
+    const T *end = std::find(mData + offset, mData + mSize, T('\n'));
+    return {mNumber, mStart, static_cast<int>(end - mData)};
+  }
+
+private:
+  const T *mData;
+  int mSize;
+
+  int mPos = 0;
+  int mStart = 0;
+  int mNumber = 1;
+};
+
+struct Hit {
+  int line; // one-based
+  QString text;
+  int start;
+  int end;
+};
+
+// Maps increasing offsets into a string to offsets into its UTF-8
+// encoding, so that hits of an expression can be compared to lexemes.
+class Utf8Offsets {
+public:
+  Utf8Offsets(const QString &text) : mText(text) {}
+
+  int at(int offset) {
+    for (; mPos < offset; ++mPos) {
+      ushort ch = mText.at(mPos).unicode();
+      if (ch < 0x80) {
+        mBytes += 1;
+      } else if (ch < 0x800) {
+        mBytes += 2;
+      } else if (QChar::isHighSurrogate(ch)) {
+        mBytes += 4;
+        ++mPos;
+      } else {
+        mBytes += 3;
+      }
+    }
+
+    return mBytes;
+  }
+
+private:
+  const QString &mText;
+
+  int mPos = 0;
+  int mBytes = 0;
+};
+
+QString lineText(QString text) {
+  if (text.endsWith('\r'))
+    text.chop(1);
+  if (text.length() > kMaxLineLength)
+    text.truncate(kMaxLineLength);
+  return text;
+}
+
+bool acceptToken(Lexer::Token token, Grep::Field field) {
+  switch (token) {
+    case Lexer::Nothing:
+    case Lexer::Whitespace:
+      return false;
+
+    case Lexer::Comment:
+      return (field == Grep::Comments);
+
+    case Lexer::String:
+      return (field == Grep::Strings);
+
+    default:
+      return (field == Grep::Code);
+  }
+}
+
+void walk(const git::Tree &tree, const QString &prefix,
+          Grep::Entries &entries) {
+  int count = tree.count();
+  for (int i = 0; i < count; ++i) {
+    QString path = prefix + tree.name(i);
+    switch (tree.type(i)) {
+      case GIT_OBJECT_TREE:
+        walk(git::Tree(tree.object(i)), path + '/', entries);
+        break;
+
+      case GIT_OBJECT_BLOB:
+        entries.append({path, tree.id(i)});
+        break;
+
+      default: // Skip submodules.
+        break;
+    }
+  }
+}
+
+class SearchBlob {
+public:
+  typedef QList<Grep::Match> result_type;
+
+  SearchBlob(const git::Repository &repo, const Grep::Options &options,
+             LexerPool *lexers)
+      : mRepo(repo), mOptions(options), mLexers(lexers) {}
+
+  QList<Grep::Match> operator()(const Grep::Entry &entry) {
+    git::Blob blob = mRepo.lookupBlob(entry.id);
+    if (!blob.isValid() || blob.isBinary())
+      return QList<Grep::Match>();
+
+    return Grep::search(blob.content(), entry.path, mOptions, mLexers);
+  }
+
+private:
+  git::Repository mRepo;
+  Grep::Options mOptions;
+  LexerPool *mLexers;
+};
+
+} // namespace
+
+Grep::Grep(QObject *parent) : QObject(parent) {}
+
+Grep::~Grep() { cancel(); }
+
+bool Grep::isRunning() const { return (mWalk || mSearch); }
+
+void Grep::start(const git::Tree &tree, const Options &options,
+                 const TrigramIndex *index) {
+  cancel();
+
+  mOptions = options;
+  mMatches = 0;
+
+  Entries candidates;
+  if (index && index->tree() == tree.id() &&
+      index->candidates(options, candidates)) {
+    search(tree, candidates);
+    return;
+  }
+
+  // Walk the tree without blocking the UI.
+  int generation = mGeneration;
+  QFutureWatcher<Entries> *watcher = new QFutureWatcher<Entries>(this);
+  connect(watcher, &QFutureWatcher<Entries>::finished, this,
+          [this, watcher, tree, generation] {
+            watcher->deleteLater();
+            if (generation == mGeneration)
+              search(tree, watcher->result());
+          });
+
+  mWalk = watcher;
+  watcher->setFuture(QtConcurrent::run(&Grep::entries, tree));
+}
+
+void Grep::cancel() {
+  ++mGeneration;
+  mWalk = nullptr;
+
+  if (mSearch) {
+    mSearch->cancel();
+    mSearch->waitForFinished();
+    mSearch = nullptr;
+  }
+}
+
+QList<Grep::Match> Grep::search(const QByteArray &content,
+                                const QString &path, const Options &options,
+                                LexerPool *lexers) {
+  QList<Match> matches;
+  if (options.pattern.isEmpty())
+    return matches;
+
+  // Look up lexer.
+  Lexer *lexer = nullptr;
+  GenericLexer generic;
+  if (options.field != AnyField && lexers) {
+    QByteArray name = Settings::instance()->lexer(path).toUtf8();
+    lexer = (name == "null") ? &generic : lexers->acquire(name);
+  }
+
+  // Without a field filter only the first hit of each line is needed.
+  // Otherwise every hit is kept until it's checked against the lexemes.
+  QList<Hit> hits;
+  QByteArray buffer;
+
+  if (options.regex) {
+    QRegularExpression::PatternOptions flags =
+        QRegularExpression::MultilineOption;
+    if (!options.caseSensitive)
+      flags |= QRegularExpression::CaseInsensitiveOption;
+
+    QRegularExpression re(options.pattern, flags);
+    if (re.isValid()) {
+      // Run the expression over the whole buffer instead of line by line.
+      QString text = QString::fromUtf8(content);
+      const ushort *data = text.utf16();
+      LineIndex<ushort> index(data, text.length());
+      Utf8Offsets offsets(text);
+      if (lexer)
+        buffer = text.toUtf8();
+
+      int pos = 0;
+      while (pos <= text.length()) {
+        QRegularExpressionMatch match = re.match(text, pos);
+        if (!match.hasMatch())
+          break;
+
+        int start = match.capturedStart();
+        int end = match.capturedEnd();
+        Line line = index.at(start);
+        QString lineContent = text.mid(line.start, line.end - line.start);
+        if (lexer) {
+          hits.append({line.number, lineContent, offsets.at(start),
+                       offsets.at(end)});
+          pos = qMax(end, start + 1);
+        } else {
+          hits.append({line.number, lineContent, start, end});
+          pos = line.end + 1;
+        }
+      }
+    }
+  } else {
+    // Scan for the first byte of the needle. The C library vectorizes
+    // memchr, so most of the buffer is skipped without a comparison.
+    QByteArray needle = options.pattern.toUtf8();
+    QByteArray haystack = options.caseSensitive ? content : content.toLower();
+    if (!options.caseSensitive)
+      needle = needle.toLower();
+
+    const char *data = haystack.constData();
+    int size = haystack.size();
+    int length = needle.size();
+    LineIndex<char> index(data, size);
+    if (lexer)
+      buffer = content;
+
+    int pos = 0;
+    while (pos <= size - length) {
+      int remaining = size - length - pos + 1;
+      const void *hit = memchr(data + pos, needle.at(0), remaining);
+      if (!hit)
+        break;
+
+      int offset = static_cast<const char *>(hit) - data;
+      if (memcmp(data + offset + 1, needle.constData() + 1, length - 1)) {
+        pos = offset + 1;
+        continue;
+      }
+
+      Line line = index.at(offset);
+      const char *start = content.constData() + line.start;
+      QString lineContent = QString::fromUtf8(start, line.end - line.start);
+      hits.append({line.number, lineContent, offset, offset + length});
+      pos = lexer ? offset + 1 : line.end + 1;
+    }
+  }
+
+  if (!lexer) {
+    foreach (const Hit &hit, hits)
+      matches.append({path, hit.line, lineText(hit.text)});
+    return matches;
+  }
+
+  // Lex the whole buffer so that lexemes which span several lines, like
+  // block comments, keep their kind on every line. Accept a hit when it
+  // lies inside a lexeme of the right kind.
+  if (!hits.isEmpty() && lexer->lex(buffer)) {
+    int previous = 0;
+    Lexer::Lexeme lexeme = {Lexer::Nothing, QByteArray(), 0};
+    foreach (const Hit &hit, hits) {
+      if (hit.line == previous)
+        continue;
+
+      while (lexeme.pos + lexeme.text.length() <= hit.start &&
+             lexer->hasNext())
+        lexeme = lexer->next();
+
+      if (lexeme.pos < 0 || lexeme.pos > hit.start ||
+          lexeme.pos + lexeme.text.length() < hit.end ||
+          !acceptToken(lexeme.token, options.field))
+        continue;
+
+      matches.append({path, hit.line, lineText(hit.text)});
+      previous = hit.line;
+    }
+  }
+
+  // Return lexer to the pool.
+  if (lexer != &generic)
+    lexers->release(lexer);
+
+  return matches;
+}
+
+Grep::Entries Grep::entries(const git::Tree &tree) {
+  Entries entries;
+  walk(tree, QString(), entries);
+  return entries;
+}
+
+void Grep::search(const git::Tree &tree, const Entries &entries) {
+  mWalk = nullptr;
+
+  QFutureWatcher<QList<Match>> *watcher =
+      new QFutureWatcher<QList<Match>>(this);
+  connect(watcher, &QFutureWatcher<QList<Match>>::resultsReadyAt, this,
+          [this, watcher](int begin, int end) {
+            if (watcher != mSearch)
+              return;
+
+            QList<Match> matches;
+            for (int i = begin; i < end; ++i)
+              matches.append(watcher->resultAt(i));
+
+            if (matches.isEmpty())
+              return;
+
+            mMatches += matches.size();
+            emit matchesFound(matches);
+
+            if (mMatches >= kMaxMatches)
+              watcher->cancel();
+          });
+
+  connect(watcher, &QFutureWatcher<QList<Match>>::finished, this,
+          [this, watcher] {
+            watcher->deleteLater();
+            if (watcher != mSearch)
+              return;
+
+            mSearch = nullptr;
+            emit finished();
+          });
+
+  mSearch = watcher;
+  SearchBlob map(tree.repo(), mOptions, &mLexers);
+  watcher->setFuture(QtConcurrent::mapped(entries, map));
+}
@@ -0,0 +1,84 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef GREP_H
+#define GREP_H
+
+#include "LexerPool.h"
+#include "git/Id.h"
+#include "git/Tree.h"
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QVector>
+
+class TrigramIndex;
+
+// Searches the full content of a tree. Blobs are decompressed and matched
+// on the global thread pool and matches are reported as they are found.
+class Grep : public QObject {
+  Q_OBJECT
+
+public:
+  // Restrict matches to lexemes of a certain kind.
+  enum Field { AnyField, Code, Comments, Strings };
+
+  struct Options {
+    QString pattern;
+    bool regex = false;
+    bool caseSensitive = false;
+    Field field = AnyField;
+  };
+
+  struct Match {
+    QString path;
+    int line; // one-based
+    QString text;
+  };
+
+  struct Entry {
+    QString path;
+    git::Id id;
+  };
+
+  using Entries = QVector<Entry>;
+
+  Grep(QObject *parent = nullptr);
+  ~Grep() override;
+
+  bool isRunning() const;
+
+  // Cancel any previous search and start a new one. If the index is
+  // up to date with the tree, only its candidate files are searched.
+  void start(const git::Tree &tree, const Options &options,
+             const TrigramIndex *index = nullptr);
+  void cancel();
+
+  // Search a single buffer. A null lexer pool disables field filtering.
+  // Otherwise the whole buffer is lexed and a line matches if one of its
+  // hits lies inside a lexeme of the requested kind.
+  static QList<Match> search(const QByteArray &content, const QString &path,
+                             const Options &options,
+                             LexerPool *lexers = nullptr);
+
+signals:
+  void matchesFound(const QList<Grep::Match> &matches);
+  void finished();
+
+private:
+  static Entries entries(const git::Tree &tree);
+  void search(const git::Tree &tree, const Entries &entries);
+
+  Options mOptions;
+  int mMatches = 0;
+  int mGeneration = 0;
+  LexerPool mLexers;
+  QFutureWatcher<Entries> *mWalk = nullptr;
+  QFutureWatcher<QList<Match>> *mSearch = nullptr;
+};
+
+#endif
@@ -14,6 +14,7 @@
 #include "git/Commit.h"
 #include "git/Config.h"
 #include "git/Diff.h"
+#include "git/IdHash.h"
 #include "git/Patch.h"
 #include "git/Reference.h"
 #include "git/RevWalk.h"
@@ -31,17 +32,33 @@ const QString kIdFile = "ids";
 const QString kDictFile = "dict";
 const QString kPostFile = "post";
 const QString kProxFile = "prox";
+const QString kDeletedFile = "deleted";
+const QString kFrontierFile = "frontier";
 const QString kLockFile = "lock";
 const QString kVersionFile = "version";
 
 const QStringList kIndexFiles = {kIdFile, kDictFile, kPostFile, kProxFile};
 
+// Compact when at least this fraction of docs is deleted.
+const double kCompactRatio = 0.25;
+
 } // namespace
 
 bool Index::sLoggingEnabled = false;
 
 Index::Index(const git::Repository &repo, QObject *parent)
     : QObject(parent), mRepo(repo) {
+  connect(&mWatcher, &QFutureWatcher<SnapshotRef>::finished, this, [this] {
+    // The files changed again while loading. Discard the stale result.
+    if (mPending) {
+      mPending = false;
+      reload();
+      return;
+    }
+
+    swap(mWatcher.result());
+  });
+
   // Read log setting.
   sLoggingEnabled = QSettings().value(kLogKey).toBool();
 
@@ -56,39 +73,38 @@ Index::Index(const git::Repository &repo, QObject *parent)
   reset();
 }
 
+Index::~Index() { mWatcher.waitForFinished(); }
+
 bool Index::isValid() const { return indexDir().exists(kIdFile); }
 
+Index::SnapshotRef Index::snapshot() const {
+  QMutexLocker locker(&mLock);
+  return mSnapshot;
+}
+
 void Index::reset() {
-  mIds.clear();
-  mDict.clear();
+  // Make sure that a load already in flight doesn't clobber this one.
+  if (mWatcher.isRunning())
+    mPending = true;
 
-  // Read already indexed ids.
-  QDir dir = indexDir();
-  QFile idFile(dir.filePath(kIdFile));
-  if (idFile.open(QIODevice::ReadOnly)) {
-    while (idFile.bytesAvailable() > 0)
-      mIds.append(idFile.read(GIT_OID_RAWSZ));
-  }
+  swap(load(mRepo));
+}
 
-  // Read dictionary.
-  QFile dictFile(dir.filePath(kDictFile));
-  if (dictFile.open(QIODevice::ReadOnly)) {
-    QDataStream dictIn(&dictFile);
-    while (!dictIn.atEnd()) {
-      quint32 pos;
-      QByteArray word;
-      dictIn >> word >> pos;
-      mDict.append(Word(word, pos));
-    }
+void Index::reload() {
+  if (mWatcher.isRunning()) {
+    mPending = true;
+    return;
   }
 
-  emit indexReset();
+  mWatcher.setFuture(QtConcurrent::run(&Index::load, mRepo));
 }
 
 void Index::clean() {
   QStringList filters;
   foreach (const QString &file, kIndexFiles)
     filters.append(file + ".*");
+  filters.append(kDeletedFile + ".*");
+  filters.append(kFrontierFile + ".*");
 
   QDir dir = indexDir();
   QStringList files = dir.entryList(filters, QDir::Files);
@@ -118,6 +134,10 @@ bool Index::remove() {
       return false;
   }
 
+  // The deleted docs bitmap and frontier only exist after a sweep.
+  dir.remove(kDeletedFile);
+  dir.remove(kFrontierFile);
+
   reset();
   return true;
 }
@@ -126,6 +146,95 @@ bool Index::write(PostingMap map) {
   if (map.isEmpty())
     return false;
 
+  return write(map, snapshot());
+}
+
+bool Index::sweep(const git::IdSet &unreachable,
+                  const git::IdSet &reachable) {
+  // Tombstone unreachable docs. Restore docs that became reachable again.
+  bool changed = false;
+  SnapshotRef snapshot = this->snapshot();
+  QBitArray deleted = snapshot->mDeleted;
+  deleted.resize(snapshot->mIds.size());
+  for (int i = 0; i < snapshot->mIds.size(); ++i) {
+    const git::Id &id = snapshot->mIds.at(i);
+    if (deleted.testBit(i) ? reachable.contains(id)
+                           : unreachable.contains(id)) {
+      deleted.toggleBit(i);
+      changed = true;
+    }
+  }
+
+  if (!changed)
+    return false;
+
+  // Drop them from the files once enough have accumulated.
+  if (deleted.count(true) >= kCompactRatio * deleted.size()) {
+    QSharedPointer<Snapshot> copy(new Snapshot(*snapshot));
+    copy->mDeleted = deleted;
+    return write(PostingMap(), copy);
+  }
+
+  if (!writeDeleted(deleted))
+    return false;
+
+  reset();
+  return true;
+}
+
+Index::IdList Index::frontier(int *count) const {
+  IdList tips;
+  if (count)
+    *count = 0;
+
+  // The doc count comes first. Ignore files without it.
+  QFile file(indexDir().filePath(kFrontierFile));
+  if (!file.open(QIODevice::ReadOnly) ||
+      file.size() % GIT_OID_RAWSZ != static_cast<int>(sizeof(quint32)))
+    return tips;
+
+  QDataStream in(&file);
+  quint32 docs;
+  in >> docs;
+  if (count)
+    *count = docs;
+
+  QByteArray data = file.readAll();
+  for (int i = 0; i + GIT_OID_RAWSZ <= data.size(); i += GIT_OID_RAWSZ) {
+    const char *raw = data.constData() + i;
+    tips.append(reinterpret_cast<const git_oid *>(raw));
+  }
+
+  return tips;
+}
+
+bool Index::writeFrontier(const IdList &tips, int count) const {
+  QSaveFile file(indexDir().filePath(kFrontierFile));
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream out(&file);
+  out << static_cast<quint32>(count);
+  foreach (const git::Id &id, tips)
+    file.write(id.toByteArray(), GIT_OID_RAWSZ);
+  return file.commit();
+}
+
+bool Index::compact() {
+  SnapshotRef snapshot = this->snapshot();
+  if (snapshot->mDeleted.count(true) == 0)
+    return false;
+
+  return write(PostingMap(), snapshot);
+}
+
+bool Index::write(const PostingMap &map, const SnapshotRef &snapshot) {
+  // Renumber docs to skip deleted ones.
+  quint32 next = 0;
+  QVector<qint64> remap(mIds.size());
+  for (int i = 0; i < mIds.size(); ++i)
+    remap[i] = snapshot->isDeleted(i) ? -1 : next++;
+
   // Open files for writing.
   QDir dir = indexDir();
   QSaveFile idFile(dir.filePath(kIdFile));
@@ -139,8 +248,10 @@ bool Index::write(PostingMap map) {
     return false;
 
   // Write id file.
-  foreach (const git::Id &id, mIds)
-    idFile.write(id.toByteArray(), GIT_OID_RAWSZ);
+  for (int i = 0; i < mIds.size(); ++i) {
+    if (remap.at(i) >= 0)
+      idFile.write(mIds.at(i).toByteArray(), GIT_OID_RAWSZ);
+  }
 
   // Merge new entries into existing postings file.
   // Write dictionary and postings files in lockstep.
@@ -148,20 +259,11 @@ bool Index::write(PostingMap map) {
   QDataStream proxOut(&proxFile);
   QDataStream dictOut(&dictFile);
 
-  // Open existing postings file.
-  QDataStream postIn;
-  QFile postInFile(dir.filePath(kPostFile));
-  if (postInFile.open(QIODevice::ReadOnly))
-    postIn.setDevice(&postInFile);
-
-  QDataStream proxIn;
-  QFile proxInFile(dir.filePath(kProxFile));
-  if (proxInFile.open(QIODevice::ReadOnly))
-    proxIn.setDevice(&proxInFile);
+  // Merge from the snapshot that the new ids were appended to.
+  QDataStream postIn(snapshot->mPost);
+  QDataStream proxIn(snapshot->mProx);
 
-  // Create a copy of the existing dictionary.
-  Dictionary dict = mDict;
-  mDict.clear();
+  const Dictionary &dict = snapshot->mDict;
 
   // Iterate over new and existing entries simultaneously.
   PostingMap::const_iterator newEnd = map.end();
@@ -200,9 +302,27 @@ bool Index::write(PostingMap map) {
       ++it;
     }
 
+    // Renumber postings and drop deleted docs.
+    int count = 0;
+    for (int i = 0; i < postings.size(); ++i) {
+      quint32 id = postings.at(i).id;
+      bool valid = (id < static_cast<quint32>(remap.size()));
+      qint64 newId = valid ? remap.at(id) : -1;
+      if (newId < 0)
+        continue;
+
+      if (count != i)
+        postings[count] = postings.at(i);
+      postings[count++].id = newId;
+    }
+
+    // Drop terms that only occurred in deleted docs.
+    postings.resize(count);
+    if (postings.isEmpty())
+      continue;
+
     // Write dictionary.
     quint32 postPos = postFile.pos(); // truncate
-    mDict.append(Word(key, postPos));
     dictOut << key << postPos;
 
     // Write postings.
@@ -215,9 +335,9 @@ bool Index::write(PostingMap map) {
     }
   }
 
-  // Close in files.
-  postInFile.close();
-  proxInFile.close();
+  // Clear tombstones first. They refer to the old doc ids.
+  if (!dir.remove(kDeletedFile) && dir.exists(kDeletedFile))
+    return false;
 
   // Write out files.
   postFile.commit();
@@ -228,6 +348,9 @@ bool Index::write(PostingMap map) {
   // Write version last.
   writeVersion();
 
+  // Pick up the merged dictionary.
+  reset();
+
   return true;
 }
 
@@ -241,7 +364,8 @@ QList<git::Commit> Index::commits(const QString &filter) const {
     return QList<git::Commit>();
 
   // Sort by commit date.
-  QList<git::Commit> commits = query->commits(this);
+  SnapshotRef snapshot = this->snapshot();
+  QList<git::Commit> commits = query->commits(snapshot.data());
   std::sort(commits.begin(), commits.end(),
             [](const git::Commit &lhs, const git::Commit &rhs) {
               return (lhs.committer().date() > rhs.committer().date());
@@ -250,40 +374,80 @@ QList<git::Commit> Index::commits(const QString &filter) const {
   return commits;
 }
 
-QList<git::Commit> Index::commits(const QList<Posting> &postings) const {
-  // Look up commits.
-  QSet<git::Commit> commits;
+QMap<Index::Field, QStringList> Index::fieldMap(const QString &prefix) const {
+  return snapshot()->fieldMap(prefix);
+}
+
+QList<git::Commit>
+Index::Snapshot::commits(const QList<Posting> &postings) const {
+  // Look up each distinct commit once.
+  git::IdSet ids(postings.size());
+  QList<git::Commit> commits;
+  foreach (const Posting &posting, postings) {
+    if (isDeleted(posting.id))
+      continue;
+
+    const git::Id &id = mIds.at(posting.id);
+    if (!ids.insert(id))
+      continue;
+
+    // Commits can still disappear between sweeps.
+    if (git::Commit commit = mRepo.lookupCommit(id))
+      commits.append(commit);
+  }
+
+  return commits;
+}
+
+QList<git::Commit> Index::Snapshot::commits(const QBitArray &docs) const {
+  QList<git::Commit> commits;
+  for (int i = 0; i < docs.size() && i < mIds.size(); ++i) {
+    if (docs.testBit(i) && !isDeleted(i)) {
+      if (git::Commit commit = mRepo.lookupCommit(mIds.at(i)))
+        commits.append(commit);
+    }
+  }
+
+  return commits;
+}
+
+QBitArray Index::Snapshot::docs(const QList<Posting> &postings) const {
+  QBitArray docs(mIds.size());
   foreach (const Posting &posting, postings) {
-    // FIXME: Remove deleted commits on write.
-    if (git::Commit commit = mRepo.lookupCommit(mIds.at(posting.id)))
-      commits.insert(commit);
+    if (posting.id < static_cast<quint32>(mIds.size()) &&
+        !isDeleted(posting.id))
+      docs.setBit(posting.id);
+  }
+
+  return docs;
+}
+
+QBitArray Index::Snapshot::starredDocs() const {
+  QBitArray docs(mIds.size());
+  for (int i = 0; i < mIds.size(); ++i) {
+    if (!isDeleted(i) && mRepo.isCommitStarred(mIds.at(i)))
+      docs.setBit(i);
   }
 
-  return commits.values();
+  return docs;
 }
 
-QList<Index::Posting> Index::postings(const Term &term, bool positional) const {
+QList<Index::Posting> Index::Snapshot::postings(const Term &term,
+                                                bool positional) const {
   Word word(term.text.toLower().toUtf8());
   Dictionary::const_iterator end = mDict.end();
   Dictionary::const_iterator it = std::lower_bound(mDict.begin(), end, word);
   if (it == end || it->key != word.key)
     return QList<Posting>();
 
-  QDir dir = indexDir();
-  QFile file(dir.filePath(kPostFile));
-  if (!file.open(QIODevice::ReadOnly))
+  if (mPost.isEmpty() || (positional && mProx.isEmpty()))
     return QList<Posting>();
 
-  QFile proxFile;
-  if (positional) {
-    proxFile.setFileName(dir.filePath(kProxFile));
-    if (!proxFile.open(QIODevice::ReadOnly))
-      return QList<Posting>();
-  }
-
   // Skip to the correct entry.
-  file.seek(it->value);
-  QDataStream in(&file);
+  QDataStream in(mPost);
+  in.device()->seek(it->value);
+
+  QDataStream proxIn(mProx);
 
   // Read list.
   QList<Posting> postings;
@@ -300,8 +464,7 @@ QList<Index::Posting> Index::postings(const Term &term, bool positional) const {
     if (term.field == Any || term.field == field || term.field == subfield) {
       // Load positions when needed.
       if (positional) {
-        proxFile.seek(proxPos);
-        QDataStream proxIn(&proxFile);
+        proxIn.device()->seek(proxPos);
         readPositions(proxIn, posting.positions);
       }
 
@@ -312,13 +475,12 @@ QList<Index::Posting> Index::postings(const Term &term, bool positional) const {
   return postings;
 }
 
-QList<Index::Posting> Index::postings(const Predicate &pred,
-                                      Field field) const {
-  QDir dir = indexDir();
-  QFile file(dir.filePath(kPostFile));
-  if (!file.open(QIODevice::ReadOnly))
+QList<Index::Posting> Index::Snapshot::postings(const Predicate &pred,
+                                                Field field) const {
+  if (mPost.isEmpty())
     return QList<Posting>();
 
+  QDataStream in(mPost);
   QList<Posting> postings;
   foreach (const Word &word, mDict) {
     // Test predicate.
@@ -326,8 +488,7 @@ QList<Index::Posting> Index::postings(const Predicate &pred,
       continue;
 
     // Skip to the correct entry.
-    file.seek(word.value);
-    QDataStream in(&file);
+    in.device()->seek(word.value);
 
     // Read list.
     quint32 postCount = readVInt(in);
@@ -348,12 +509,12 @@ QList<Index::Posting> Index::postings(const Predicate &pred,
   return postings;
 }
 
-QMap<Index::Field, QStringList> Index::fieldMap(const QString &prefix) const {
-  QDir dir = indexDir();
-  QFile file(dir.filePath(kPostFile));
-  if (!file.open(QIODevice::ReadOnly))
+QMap<Index::Field, QStringList>
+Index::Snapshot::fieldMap(const QString &prefix) const {
+  if (mPost.isEmpty())
     return QMap<Field, QStringList>();
 
+  QDataStream in(mPost);
   Dictionary::const_iterator it = mDict.constBegin();
   Dictionary::const_iterator end = mDict.constEnd();
   if (!prefix.isEmpty()) {
@@ -367,8 +528,7 @@ QMap<Index::Field, QStringList> Index::fieldMap(const QString &prefix) const {
   QMap<Field, QStringList> map;
   while (it != end) {
     // Skip to the correct entry.
-    file.seek(it->value);
-    QDataStream in(&file);
+    in.device()->seek(it->value);
 
     // Read list.
     QString name = it->key;
@@ -468,6 +628,15 @@ quint8 Index::readVersion() const {
   return version;
 }
 
+bool Index::writeDeleted(const QBitArray &deleted) const {
+  QSaveFile file(indexDir().filePath(kDeletedFile));
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream(&file) << deleted;
+  return file.commit();
+}
+
 void Index::writeVersion() const {
   QFile file(indexDir().filePath(kVersionFile));
   if (file.open(QFile::WriteOnly))
@@ -538,3 +707,71 @@ void Index::setLoggingEnabled(bool enable) {
 }
 
 QDir Index::indexDir() const { return indexDir(mRepo); }
+
+void Index::swap(const SnapshotRef &snapshot) {
+  {
+    QMutexLocker locker(&mLock);
+    mSnapshot = snapshot;
+  }
+
+  mIds = snapshot->mIds;
+  emit indexReset();
+}
+
+Index::SnapshotRef Index::load(const git::Repository &repo) {
+  QSharedPointer<Snapshot> snapshot(new Snapshot(repo));
+
+  // Read already indexed ids in one pass.
+  QDir dir = indexDir(repo);
+  QFile idFile(dir.filePath(kIdFile));
+  if (idFile.open(QIODevice::ReadOnly)) {
+    QByteArray data = idFile.readAll();
+    snapshot->mIds.reserve(data.size() / GIT_OID_RAWSZ);
+    for (int i = 0; i + GIT_OID_RAWSZ <= data.size(); i += GIT_OID_RAWSZ) {
+      const char *raw = data.constData() + i;
+      snapshot->mIds.append(reinterpret_cast<const git_oid *>(raw));
+    }
+  }
+
+  // Read dictionary.
+  QFile dictFile(dir.filePath(kDictFile));
+  if (dictFile.open(QIODevice::ReadOnly)) {
+    QDataStream dictIn(&dictFile);
+    while (!dictIn.atEnd()) {
+      quint32 pos;
+      QByteArray word;
+      dictIn >> word >> pos;
+      snapshot->mDict.append(Word(word, pos));
+    }
+  }
+
+  // Read deleted docs.
+  QFile deletedFile(dir.filePath(kDeletedFile));
+  if (deletedFile.open(QIODevice::ReadOnly))
+    QDataStream(&deletedFile) >> snapshot->mDeleted;
+
+  // Hold on to the postings and positions files. The writer replaces
+  // them by renaming, so an open mapping keeps seeing the old data.
+  QByteArray *data[] = {&snapshot->mPost, &snapshot->mProx};
+  QString names[] = {kPostFile, kProxFile};
+  for (int i = 0; i < 2; ++i) {
+    QSharedPointer<QFile> file(new QFile(dir.filePath(names[i])));
+    if (!file->open(QIODevice::ReadOnly) || !file->size())
+      continue;
+
+#ifdef Q_OS_WIN
+    // Windows can't replace a file that's mapped.
+    *data[i] = file->readAll();
+#else
+    if (uchar *map = file->map(0, file->size())) {
+      const char *raw = reinterpret_cast<const char *>(map);
+      *data[i] = QByteArray::fromRawData(raw, file->size());
+      snapshot->mFiles.append(file);
+    } else {
+      *data[i] = file->readAll();
+    }
+#endif
+  }
+
+  return snapshot;
+}
@@ -12,13 +12,20 @@
 
 #include "git/Id.h"
 #include "git/Repository.h"
+#include <QBitArray>
+#include <QFutureWatcher>
 #include <QList>
+#include <QMutex>
 #include <QObject>
+#include <QSharedPointer>
 #include <QVector>
 #include <functional>
 
+class QFile;
+
 namespace git {
 class Commit;
+class IdSet;
 }
 
 class Index : public QObject {
@@ -79,24 +86,95 @@ public:
   using PostingMap = QMap<QByteArray, QVector<Index::Posting>>;
   using Predicate = std::function<bool(const QByteArray &)>;
 
+  // An immutable view of the index files as of one load. Queries
+  // evaluate against a single snapshot so that a reload can't change
+  // the doc ids or posting offsets out from under them.
+  class Snapshot {
+  public:
+    git::Repository repo() const { return mRepo; }
+    const IdList &ids() const { return mIds; }
+    const Dictionary &dict() const { return mDict; }
+
+    // Docs whose commits are no longer reachable. Their postings stay
+    // in the files until the next write or compaction drops them.
+    const QBitArray &deleted() const { return mDeleted; }
+    bool isDeleted(quint32 id) const {
+      return id < static_cast<quint32>(mDeleted.size()) && mDeleted.testBit(id);
+    }
+
+    QList<git::Commit> commits(const QList<Posting> &postings) const;
+    QList<git::Commit> commits(const QBitArray &docs) const;
+
+    // Bitmaps of doc ids. Bit n corresponds to ids().at(n).
+    QBitArray docs(const QList<Posting> &postings) const;
+    QBitArray starredDocs() const;
+
+    QList<Posting> postings(const Term &term, bool positional = false) const;
+    QList<Posting> postings(const Predicate &pred, Field field = Any) const;
+
+    QMap<Field, QStringList> fieldMap(const QString &prefix = QString()) const;
+
+  private:
+    Snapshot(const git::Repository &repo) : mRepo(repo) {}
+
+    git::Repository mRepo;
+    IdList mIds;
+    Dictionary mDict;
+    QBitArray mDeleted;
+
+    // The postings and positions files. These are mapped where the
+    // platform allows replacing a mapped file and read otherwise.
+    QList<QSharedPointer<QFile>> mFiles;
+    QByteArray mPost;
+    QByteArray mProx;
+
+    friend class Index;
+  };
+
+  using SnapshotRef = QSharedPointer<const Snapshot>;
+
   Index(const git::Repository &repo, QObject *parent = nullptr);
+  ~Index() override;
 
   bool isValid() const;
 
   git::Repository repo() const { return mRepo; }
+
+  // Get the current snapshot. Callers keep the snapshot they
+  // got for as long as they need it, even across a reload.
+  SnapshotRef snapshot() const;
+
+  // The list of indexed ids that the writer appends to.
   IdList &ids() { return mIds; }
-  Dictionary &dict() { return mDict; }
 
+  // Load the index synchronously.
   void reset();
+
+  // Load the index on a worker and swap it in when it's done.
+  void reload();
+
   void clean();
   bool remove();
+
+  // Merge new postings into the files. Deleted docs are dropped
+  // and the remaining docs are renumbered.
   bool write(PostingMap map);
 
-  QList<git::Commit> commits(const QString &filter) const;
-  QList<git::Commit> commits(const QList<Posting> &postings) const;
+  // Tombstone docs in the unreachable set and restore tombstoned docs in
+  // the reachable set. Compacts the files once enough docs are deleted.
+  // Returns true if anything changed.
+  bool sweep(const git::IdSet &unreachable, const git::IdSet &reachable);
+
+  // The tips whose history is completely indexed. The indexer hides
+  // them to walk only new commits. The count is the number of docs
+  // when the frontier was written. Later docs aren't behind it.
+  IdList frontier(int *count = nullptr) const;
+  bool writeFrontier(const IdList &tips, int count) const;
 
-  QList<Posting> postings(const Term &term, bool positional = false) const;
-  QList<Posting> postings(const Predicate &pred, Field field = Any) const;
+  // Drop deleted docs from the files now.
+  bool compact();
+
+  QList<git::Commit> commits(const QString &filter) const;
 
   QMap<Field, QStringList> fieldMap(const QString &prefix = QString()) const;
 
@@ -133,11 +211,23 @@ private:
   quint8 readVersion() const;
   void writeVersion() const;
 
+  bool writeDeleted(const QBitArray &deleted) const;
+  bool write(const PostingMap &map, const SnapshotRef &snapshot);
+
   QDir indexDir() const;
 
+  void swap(const SnapshotRef &snapshot);
+
+  static SnapshotRef load(const git::Repository &repo);
+
   git::Repository mRepo;
   IdList mIds;
-  Dictionary mDict;
+
+  mutable QMutex mLock;
+  SnapshotRef mSnapshot;
+
+  bool mPending = false;
+  QFutureWatcher<SnapshotRef> mWatcher;
 
   static bool sLoggingEnabled;
 };
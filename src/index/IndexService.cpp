@@ -0,0 +1,219 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "IndexService.h"
+#include "Index.h"
+#include "Debug.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+
+const int kConnectInterval = 100;
+const int kConnectAttempts = 50;
+
+} // namespace
+
+IndexService::IndexService(const QString &server, const QString &program,
+                           QObject *parent)
+    : QObject(parent), mServer(server), mProgram(program) {
+  connect(&mSocket, &QLocalSocket::connected, this, &IndexService::connected);
+  connect(&mSocket, &QLocalSocket::readyRead, this, &IndexService::readLines);
+  connect(&mSocket, &QLocalSocket::disconnected, this,
+          &IndexService::disconnected);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+  connect(&mSocket, &QLocalSocket::errorOccurred, this, &IndexService::error);
+#else
+  connect(&mSocket,
+          QOverload<QLocalSocket::LocalSocketError>::of(&QLocalSocket::error),
+          this, &IndexService::error);
+#endif
+}
+
+IndexService *IndexService::instance() {
+  static IndexService *instance = nullptr;
+  if (!instance)
+    instance = new IndexService(serverName(), program(), qApp);
+
+  return instance;
+}
+
+bool IndexService::isIndexing(const git::Repository &repo) const {
+  return mActive.contains(key(repo));
+}
+
+void IndexService::start(const git::Repository &repo) {
+  mCanceling.remove(key(repo));
+  bool log = Index::isLoggingEnabled();
+  send(QString("index %1").arg(log ? 1 : 0), key(repo));
+}
+
+void IndexService::cancel(const git::Repository &repo) {
+  QString path = key(repo);
+  if (mSocket.state() != QLocalSocket::ConnectedState) {
+    // Drop requests that haven't been sent yet.
+    QByteArray suffix = ' ' + path.toUtf8() + '\n';
+    auto end = std::remove_if(
+        mPending.begin(), mPending.end(),
+        [&suffix](const QByteArray &line) { return line.endsWith(suffix); });
+    mPending.erase(end, mPending.end());
+    return;
+  }
+
+  // Always forward the cancel. The server may have accepted
+  // a request that it hasn't confirmed yet. Don't wait for it.
+  // The server releases the index and answers when it's done.
+  mCanceling.insert(path);
+  send("cancel", path);
+  mSocket.flush();
+}
+
+void IndexService::setFocus(const git::Repository &repo) {
+  // Don't start the server just to set focus. It's sent on connect.
+  mFocus = key(repo);
+  if (mSocket.state() == QLocalSocket::ConnectedState)
+    send("focus", mFocus);
+}
+
+void IndexService::send(const QString &command, const QString &path) {
+  QByteArray line = QString("%1 %2\n").arg(command, path).toUtf8();
+  if (mSocket.state() == QLocalSocket::ConnectedState) {
+    mSocket.write(line);
+    return;
+  }
+
+  mPending.append(line);
+  if (!mConnecting)
+    connectToServer();
+}
+
+void IndexService::connectToServer() {
+  // Connect without blocking. The result is reported by signal.
+  mConnecting = true;
+  mSocket.connectToServer(mServer);
+}
+
+void IndexService::connected() {
+  mConnecting = false;
+  mAttempts = 0;
+  if (!mFocus.isEmpty())
+    send("focus", mFocus);
+
+  foreach (const QByteArray &line, mPending)
+    mSocket.write(line);
+  mPending.clear();
+}
+
+void IndexService::error() {
+  // Errors on an established connection end in disconnected().
+  if (!mConnecting)
+    return;
+
+  // Start the server after the first failed attempt. Don't try
+  // again if it couldn't be started. The server isn't coming.
+  if (!mAttempts++) {
+    QStringList args = {"--server", mServer, "--background"};
+    if (mSpawnFailed || !QProcess::startDetached(mProgram, args)) {
+      Debug("Failed to start the indexer: " << mProgram);
+      mSpawnFailed = true;
+      mConnecting = false;
+      mAttempts = 0;
+      mPending.clear();
+      return;
+    }
+  }
+
+  // Give up after a while.
+  if (mAttempts >= kConnectAttempts) {
+    mConnecting = false;
+    mAttempts = 0;
+    mPending.clear();
+    return;
+  }
+
+  QTimer::singleShot(kConnectInterval, this, &IndexService::connectToServer);
+}
+
+void IndexService::readLines() {
+  while (mSocket.canReadLine()) {
+    QString line = QString::fromUtf8(mSocket.readLine()).trimmed();
+    QString command = line.section(' ', 0, 0);
+    QString path = line.section(' ', 1);
+    if (command == "start") {
+      // Ignore requests that were canceled before they were confirmed.
+      if (mCanceling.contains(path))
+        continue;
+      mActive.insert(path);
+      emit started(path);
+    } else if (command == "write") {
+      if (!mCanceling.contains(path))
+        emit written(path);
+    } else if (command == "done") {
+      mActive.remove(path);
+      mCanceling.remove(path);
+      emit finished(path);
+    }
+  }
+}
+
+void IndexService::disconnected() {
+  // The server doesn't exit while it has clients.
+  // Start it again on the next request.
+  mSpawnFailed = false;
+  mCanceling.clear();
+
+  QSet<QString> active = mActive;
+  mActive.clear();
+  foreach (const QString &path, active) {
+    emit crashed(path);
+    emit finished(path);
+  }
+}
+
+QString IndexService::key(const git::Repository &repo) {
+  return repo.dir().path();
+}
+
+QString IndexService::serverName() {
+  // Run one server per user and installation.
+  QByteArray key = QDir::homePath().toUtf8() + '\n' +
+                   QCoreApplication::applicationDirPath().toUtf8();
+  QByteArray hash = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+  QString name = QString("%1-indexer-%2")
+                     .arg(QCoreApplication::applicationName(),
+                          hash.toHex().left(12));
+
+#ifndef Q_OS_WIN
+  // Put the socket in a directory that only the user can reach
+  // instead of the shared temporary directory.
+  QString dir =
+      QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+  if (!dir.isEmpty())
+    return QDir(dir).filePath(name);
+#endif
+
+  return name;
+}
+
+QString IndexService::program() {
+  QDir dir(QCoreApplication::applicationDirPath());
+#ifdef WIN32
+  QString program = dir.filePath("indexer.exe");
+#else
+  QString program = dir.filePath("indexer");
+#endif
+  if (!QFileInfo(program).isFile())
+    Debug("No indexer found: " << program);
+
+  return program;
+}
@@ -0,0 +1,76 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef INDEXSERVICE_H
+#define INDEXSERVICE_H
+
+#include "git/Repository.h"
+#include <QByteArrayList>
+#include <QLocalSocket>
+#include <QObject>
+#include <QSet>
+
+// The connection to the shared indexer process. One indexer serves every
+// open repository and schedules their batches against a global budget.
+// It's started on demand and exits when it's been without connections
+// for a while. Repositories are identified by the path that they were
+// opened with.
+class IndexService : public QObject {
+  Q_OBJECT
+
+public:
+  // Connect to the named server. Start it with the given program.
+  IndexService(const QString &server, const QString &program,
+               QObject *parent = nullptr);
+
+  static IndexService *instance();
+
+  bool isIndexing(const git::Repository &repo) const;
+
+  // Request indexing of new commits.
+  void start(const git::Repository &repo);
+
+  // Stop indexing. Doesn't wait for the server. The finished
+  // signal is emitted after the index lock is released.
+  void cancel(const git::Repository &repo);
+
+  // Give priority to the given repository.
+  void setFocus(const git::Repository &repo);
+
+signals:
+  void started(const QString &path);
+  void written(const QString &path);
+  void finished(const QString &path);
+  void crashed(const QString &path);
+
+private:
+  void send(const QString &command, const QString &path);
+  void connectToServer();
+  void connected();
+  void error();
+  void readLines();
+  void disconnected();
+
+  static QString key(const git::Repository &repo);
+  static QString serverName();
+  static QString program();
+
+  QString mServer;
+  QString mProgram;
+
+  QLocalSocket mSocket;
+  QByteArrayList mPending;
+  QSet<QString> mActive;
+  QSet<QString> mCanceling;
+  QString mFocus;
+
+  bool mConnecting = false;
+  bool mSpawnFailed = false;
+  int mAttempts = 0;
+};
+
+#endif
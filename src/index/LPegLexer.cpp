@@ -92,7 +92,8 @@ Lexer::Lexeme LPegLexer::next() {
 
   lua_rawgeti(L, -2, mIndex + 1); // endPos
   int endPos = lua_tointeger(L, -1) - 1;
-  QByteArray text = mBuffer.mid(mStartPos, endPos - mStartPos);
+  int pos = mStartPos;
+  QByteArray text = mBuffer.mid(pos, endPos - pos);
   lua_pop(L, 1); // endPos
 
   mStartPos = endPos;
@@ -101,5 +102,5 @@ Lexer::Lexeme LPegLexer::next() {
   if (!hasNext())
     lua_pop(L, 2); // _TOKENSTYLES and token table
 
-  return {static_cast<Token>(token), text};
+  return {static_cast<Token>(token), text, pos};
 }
@@ -39,6 +39,7 @@ public:
   struct Lexeme {
     Token token;
     QByteArray text;
+    int pos = -1; // offset of the text in the buffer
   };
 
   Lexer(QObject *parent = nullptr);
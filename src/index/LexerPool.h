@@ -0,0 +1,47 @@
+//
+//          Copyright (c) 2017, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+// Author: Jason Haslam
+//
+
+#ifndef LEXERPOOL_H
+#define LEXERPOOL_H
+
+#include "LPegLexer.h"
+#include "conf/Settings.h"
+#include <QMultiMap>
+#include <QMutex>
+
+// Lexers are expensive to create and not thread-safe. Each worker thread
+// acquires one for the duration of a file and returns it to the pool.
+class LexerPool {
+public:
+  LexerPool() : mHome(Settings::lexerDir().path().toUtf8()) {}
+
+  ~LexerPool() { qDeleteAll(mLexers); }
+
+  Lexer *acquire(const QByteArray &name) {
+    QMutexLocker locker(&mMutex);
+    (void)locker;
+
+    return mLexers.contains(name) ? mLexers.take(name)
+                                  : new LPegLexer(mHome, name);
+  }
+
+  void release(Lexer *lexer) {
+    QMutexLocker locker(&mMutex);
+    (void)locker;
+
+    mLexers.insert(lexer->name(), lexer);
+  }
+
+private:
+  QByteArray mHome;
+  QMutex mMutex;
+  QMultiMap<QByteArray, Lexer *> mLexers;
+};
+
+#endif
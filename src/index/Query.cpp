@@ -9,6 +9,7 @@
 
 #include "Query.h"
 #include "GenericLexer.h"
+#include "git/IdHash.h"
 #include <QDate>
 #include <QMap>
 #include <QSet>
@@ -22,9 +23,16 @@ public:
 
   QList<Index::Term> terms() const override { return QList<Index::Term>(); }
 
-  QList<git::Commit> commits(const Index *index) const override {
+  QList<git::Commit> commits(const Index::Snapshot *index) const override {
     return index->repo().starredCommits();
   }
+
+  QBitArray docs(const Index::Snapshot *index) const override {
+    return index->starredDocs();
+  }
+
+  // Starred commits don't have to be indexed yet.
+  bool isIndexedOnly() const override { return false; }
 };
 
 class TermQuery : public Query {
@@ -37,11 +45,19 @@ public:
 
   QList<Index::Term> terms() const override { return {mTerm}; }
 
-  QList<git::Commit> commits(const Index *index) const override {
-    return index->commits(index->postings(mTerm));
+  QList<git::Commit> commits(const Index::Snapshot *index) const override {
+    return index->commits(postings(index));
+  }
+
+  QBitArray docs(const Index::Snapshot *index) const override {
+    return index->docs(postings(index));
   }
 
 protected:
+  virtual QList<Index::Posting> postings(const Index::Snapshot *index) const {
+    return index->postings(mTerm);
+  }
+
   Index::Term mTerm;
 };
 
@@ -49,14 +65,15 @@ class DateRangeQuery : public TermQuery {
 public:
   DateRangeQuery(const Index::Term &term) : TermQuery(term) {}
 
-  QList<git::Commit> commits(const Index *index) const override {
+protected:
+  QList<Index::Posting> postings(const Index::Snapshot *index) const override {
     Index::Field field = mTerm.field;
     if (field != Index::Before && field != Index::After)
-      return QList<git::Commit>();
+      return QList<Index::Posting>();
 
     QDate date = QDate::fromString(mTerm.text, Index::dateFormat());
     if (!date.isValid())
-      return QList<git::Commit>();
+      return QList<Index::Posting>();
 
     Index::Predicate pred = [field, date](const QByteArray &word) -> bool {
       // Skip words that don't look like dates.
@@ -80,7 +97,7 @@ public:
       }
     };
 
-    return index->commits(index->postings(pred, Index::Date));
+    return index->postings(pred, Index::Date);
   }
 };
 
@@ -88,13 +105,14 @@ class WildcardQuery : public TermQuery {
 public:
   WildcardQuery(const Index::Term &term) : TermQuery(term) {}
 
-  QList<git::Commit> commits(const Index *index) const override {
+protected:
+  QList<Index::Posting> postings(const Index::Snapshot *index) const override {
     QRegExp re(mTerm.text, Qt::CaseInsensitive, QRegExp::Wildcard);
     Index::Predicate pred = [re](const QByteArray &word) {
       return re.exactMatch(word);
     };
 
-    return index->commits(index->postings(pred, mTerm.field));
+    return index->postings(pred, mTerm.field);
   }
 };
 
@@ -112,15 +130,24 @@ public:
 
   QList<Index::Term> terms() const override { return mTerms; }
 
-  QList<git::Commit> commits(const Index *index) const override {
+  QList<git::Commit> commits(const Index::Snapshot *index) const override {
+    return index->commits(postings(index));
+  }
+
+  QBitArray docs(const Index::Snapshot *index) const override {
+    return index->docs(postings(index));
+  }
+
+private:
+  QList<Index::Posting> postings(const Index::Snapshot *index) const {
     if (mTerms.isEmpty())
-      return QList<git::Commit>();
+      return QList<Index::Posting>();
 
-    // Start with the commits that match the first term.
+    // Start with the postings that match the first term.
     bool multiple = (mTerms.size() > 1);
     QList<Index::Posting> postings = index->postings(mTerms.first(), multiple);
     if (!multiple)
-      return index->commits(postings);
+      return postings;
 
     // Remove commits that don't match subsequent terms.
     int offset = 1;
@@ -154,10 +181,9 @@ public:
       ++offset;
     }
 
-    return index->commits(postings);
+    return postings;
   }
 
-private:
   QList<Index::Term> mTerms;
 };
 
@@ -177,31 +203,36 @@ public:
     return mLhs->terms() + mRhs->terms();
   }
 
-  QList<git::Commit> commits(const Index *index) const override {
+  QList<git::Commit> commits(const Index::Snapshot *index) const override {
+    // Combine doc id bitmaps when the result is confined to the index.
+    if (isIndexedOnly()) {
+      QBitArray bits = docs(index);
+      if (!bits.isNull())
+        return index->commits(bits);
+    }
+
     // Start with the commits that match the left hand side.
     QList<git::Commit> rhs = mRhs->commits(index);
     QList<git::Commit> commits = mLhs->commits(index);
     if (mKind == And) {
-// Remove commits that don't match the right hand side.
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-      QSet<git::Commit> set(rhs.begin(), rhs.end());
-#else
-      QSet<git::Commit> set = QSet<git::Commit>::fromList(rhs);
-#endif
+      // Remove commits that don't match the right hand side.
+      git::IdSet set(rhs.size());
+      foreach (const git::Commit &commit, rhs)
+        set.insert(commit.id());
+
       QMutableListIterator<git::Commit> it(commits);
       while (it.hasNext()) {
-        if (!set.contains(it.next()))
+        if (!set.contains(it.next().id()))
           it.remove();
       }
     } else {
-// Add commits that aren't already in the result set.
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-      QSet<git::Commit> set(commits.begin(), commits.end());
-#else
-      QSet<git::Commit> set = QSet<git::Commit>::fromList(commits);
-#endif
+      // Add commits that aren't already in the result set.
+      git::IdSet set(commits.size());
+      foreach (const git::Commit &commit, commits)
+        set.insert(commit.id());
+
       foreach (const git::Commit &commit, rhs) {
-        if (!set.contains(commit))
+        if (set.insert(commit.id()))
           commits.append(commit);
       }
     }
@@ -209,6 +240,24 @@ public:
     return commits;
   }
 
+  QBitArray docs(const Index::Snapshot *index) const override {
+    QBitArray lhs = mLhs->docs(index);
+    if (lhs.isNull())
+      return QBitArray();
+
+    QBitArray rhs = mRhs->docs(index);
+    if (rhs.isNull())
+      return QBitArray();
+
+    return (mKind == And) ? (lhs & rhs) : (lhs | rhs);
+  }
+
+  bool isIndexedOnly() const override {
+    bool lhs = mLhs->isIndexedOnly();
+    bool rhs = mRhs->isIndexedOnly();
+    return (mKind == And) ? (lhs || rhs) : (lhs && rhs);
+  }
+
 private:
   Kind mKind;
   QueryRef mLhs;
@@ -219,7 +268,8 @@ class PathspecQuery : public TermQuery {
 public:
   PathspecQuery(const Index::Term &term) : TermQuery(term) {}
 
-  QList<git::Commit> commits(const Index *index) const override {
+protected:
+  QList<Index::Posting> postings(const Index::Snapshot *index) const override {
     QByteArray term = mTerm.text.toUtf8();
     QByteArray prefix = term.endsWith('/') ? term : term + '/';
     QRegExp re(mTerm.text, Qt::CaseInsensitive, QRegExp::Wildcard);
@@ -227,7 +277,7 @@ public:
       return word.startsWith(prefix) || re.exactMatch(word);
     };
 
-    return index->commits(index->postings(pred, Index::Path));
+    return index->postings(pred, Index::Path);
   }
 };
 
@@ -21,7 +21,16 @@ public:
 
   virtual QString toString() const = 0;
   virtual QList<Index::Term> terms() const = 0;
-  virtual QList<git::Commit> commits(const Index *index) const = 0;
+  virtual QList<git::Commit> commits(const Index::Snapshot *index) const = 0;
+
+  // Get the matching indexed commits as a doc id bitmap. Returns
+  // a null bitmap if the query can't be evaluated that way.
+  virtual QBitArray docs(const Index::Snapshot *index) const {
+    return QBitArray();
+  }
+
+  // Returns true if the query can only match indexed commits.
+  virtual bool isIndexedOnly() const { return true; }
 
   static QueryRef parseQuery(const QString &query);
 };
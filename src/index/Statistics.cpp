@@ -0,0 +1,395 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Statistics.h"
+#include "Index.h"
+#include "git/Commit.h"
+#include "git/Diff.h"
+#include "git/Patch.h"
+#include "git/Reference.h"
+#include "git/RevWalk.h"
+#include "git/Signature.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+const quint8 kVersion = 1;
+const QString kFile = "stats";
+
+qint32 month(const QDate &date) {
+  return date.year() * 12 + date.month() - 1;
+}
+
+void writeAuthors(QDataStream &out, const Statistics::AuthorMap &authors) {
+  out << static_cast<quint32>(authors.size());
+  auto end = authors.constEnd();
+  for (auto it = authors.constBegin(); it != end; ++it) {
+    out << it.key();
+    Index::writeVInt(out, it.value().commits);
+    Index::writeVInt(out, it.value().additions);
+    Index::writeVInt(out, it.value().deletions);
+  }
+}
+
+Statistics::AuthorMap readAuthors(QDataStream &in) {
+  quint32 count;
+  in >> count;
+
+  Statistics::AuthorMap authors;
+  authors.reserve(count);
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    QString email;
+    in >> email;
+
+    Statistics::Counts &counts = authors[email];
+    counts.commits = Index::readVInt(in);
+    counts.additions = Index::readVInt(in);
+    counts.deletions = Index::readVInt(in);
+  }
+
+  return authors;
+}
+
+class Map {
+public:
+  typedef Statistics::Data result_type;
+
+  Map(const git::Repository &repo, QAtomicInt *canceled)
+      : mRepo(repo), mIdentities(repo.identities()), mCanceled(canceled) {}
+
+  Statistics::Data operator()(const git::Id &id) {
+    Statistics::Data result;
+    if (mCanceled->loadAcquire())
+      return result;
+
+    git::Commit commit = mRepo.lookupCommit(id);
+    if (!commit.isValid())
+      return result;
+
+    git::Identities::Identity author =
+        mIdentities->identity(mIdentities->author(commit));
+    QString email = author.email.toLower();
+    result.names.insert(email, author.name);
+
+    // Attribute each file's line counts to all of its parent directories.
+    QHash<QString, Statistics::Counts> dirs;
+    dirs[QString()].commits = 1;
+
+    git::Diff diff = commit.diff(git::Commit(), 0);
+    int count = diff.isValid() ? diff.count() : 0;
+    for (int i = 0; i < count; ++i) {
+      if (diff.isBinary(i))
+        continue;
+
+      git::Patch patch = diff.patch(i);
+      if (!patch.isValid())
+        continue;
+
+      git::Patch::LineStats stats = patch.lineStats();
+      QString dir = diff.name(i);
+      do {
+        int slash = dir.lastIndexOf('/');
+        dir = (slash < 0) ? QString() : dir.left(slash);
+
+        Statistics::Counts &counts = dirs[dir];
+        counts.commits = 1;
+        counts.additions += stats.additions;
+        counts.deletions += stats.deletions;
+      } while (!dir.isEmpty());
+    }
+
+    auto end = dirs.constEnd();
+    for (auto it = dirs.constBegin(); it != end; ++it)
+      result.paths[it.key()].insert(email, it.value());
+
+    QDate date = commit.author().date().date();
+    result.months[month(date)].insert(email, dirs.value(QString()));
+    return result;
+  }
+
+private:
+  git::Repository mRepo;
+  git::Identities *mIdentities;
+  QAtomicInt *mCanceled;
+};
+
+// Check that a counted tip is still in the history of the new tips.
+bool isReachable(const git::Repository &repo, const git::Id &id,
+                 const QList<git::Id> &tips, const QSet<git::Id> &seen) {
+  if (seen.contains(id))
+    return true;
+
+  git::Commit commit = repo.lookupCommit(id);
+  if (!commit.isValid())
+    return false;
+
+  foreach (const git::Id &tip, tips) {
+    git::Commit base = repo.mergeBase(commit, repo.lookupCommit(tip));
+    if (base.isValid() && base.id() == id)
+      return true;
+  }
+
+  return false;
+}
+
+Statistics::Data build(const git::Repository &repo, Statistics::Data data,
+                       QAtomicInt *canceled) {
+  // Collect the tips once. They're walked and then stored as counted.
+  QList<git::Id> tips;
+  QSet<git::Id> seen;
+  git::RefSnapshot snapshot = repo.refSnapshot();
+  for (const git::RefSnapshot::Entry &entry : snapshot.entries()) {
+    if (!entry.commit.isNull() && !seen.contains(entry.commit)) {
+      seen.insert(entry.commit);
+      tips.append(entry.commit);
+    }
+  }
+
+  // Totals can only be added to. Start over when commits that were
+  // counted have been dropped by a rewrite, a deleted branch or gc.
+  foreach (const git::Id &tip, data.tips) {
+    if (!isReachable(repo, tip, tips, seen)) {
+      data = Statistics::Data();
+      break;
+    }
+  }
+
+  // Hide everything that was already counted.
+  git::RevWalk walker = repo.walker(tips);
+  foreach (const git::Id &tip, data.tips)
+    walker.hide(tip);
+
+  QVector<git::Id> ids;
+  git::Commit commit = walker.next();
+  while (commit.isValid() && !canceled->loadAcquire()) {
+    if (!commit.isMerge())
+      ids.append(commit.id());
+    commit = walker.next();
+  }
+
+  Statistics::Data delta = QtConcurrent::blockingMappedReduced(
+      ids, Map(repo, canceled), &Statistics::merge,
+      QtConcurrent::UnorderedReduce);
+
+  Statistics::merge(data, delta);
+  data.tips = tips;
+  return data;
+}
+
+} // namespace
+
+Statistics::Counts &Statistics::Counts::operator+=(const Counts &rhs) {
+  commits += rhs.commits;
+  additions += rhs.additions;
+  deletions += rhs.deletions;
+  return *this;
+}
+
+Statistics::Statistics(const git::Repository &repo, QObject *parent)
+    : QObject(parent), mRepo(repo) {
+  git::RepositoryNotifier *notifier = repo.notifier();
+  connect(notifier, &git::RepositoryNotifier::referenceAdded, this,
+          &Statistics::update);
+  connect(notifier, &git::RepositoryNotifier::referenceUpdated, this,
+          &Statistics::update);
+}
+
+Statistics::~Statistics() {
+  if (mWatcher) {
+    mCanceled.storeRelease(1);
+    mWatcher->waitForFinished();
+  }
+}
+
+void Statistics::update() {
+  if (mWatcher) {
+    mPending = true;
+    return;
+  }
+
+  QFutureWatcher<Data> *watcher = new QFutureWatcher<Data>(this);
+  connect(watcher, &QFutureWatcher<Data>::finished, this, [this, watcher] {
+    watcher->deleteLater();
+    mWatcher = nullptr;
+    if (mCanceled.loadAcquire())
+      return;
+
+    mData = watcher->result();
+    mLoaded = true;
+    emit updated();
+
+    if (mPending) {
+      mPending = false;
+      update();
+    }
+  });
+
+  // Read the stored totals the first time.
+  mWatcher = watcher;
+  bool loaded = mLoaded;
+  QAtomicInt *canceled = &mCanceled;
+  watcher->setFuture(QtConcurrent::run(
+      [repo = mRepo, data = mData, file = file(), loaded, canceled] {
+        Data result = build(repo, loaded ? data : read(file), canceled);
+        if (!canceled->loadAcquire() && result.tips != data.tips)
+          write(file, result);
+        return result;
+      }));
+}
+
+QList<Statistics::Author> Statistics::authors(const QString &path,
+                                              int limit) const {
+  QString dir = path;
+  while (dir.endsWith('/'))
+    dir.chop(1);
+  if (dir == ".")
+    dir.clear();
+
+  QList<Author> authors;
+  AuthorMap map = mData.paths.value(dir);
+  auto end = map.constEnd();
+  for (auto it = map.constBegin(); it != end; ++it)
+    authors.append({mData.names.value(it.key()), it.key(), it.value()});
+
+  std::sort(authors.begin(), authors.end(),
+            [](const Author &lhs, const Author &rhs) {
+              if (lhs.counts.commits != rhs.counts.commits)
+                return lhs.counts.commits > rhs.counts.commits;
+              quint32 lhsLines = lhs.counts.additions + lhs.counts.deletions;
+              quint32 rhsLines = rhs.counts.additions + rhs.counts.deletions;
+              return lhsLines > rhsLines;
+            });
+
+  if (limit >= 0 && authors.size() > limit)
+    authors = authors.mid(0, limit);
+
+  return authors;
+}
+
+QMap<QDate, Statistics::Counts>
+Statistics::timeline(const QString &email) const {
+  QMap<QDate, Counts> timeline;
+  auto end = mData.months.constEnd();
+  for (auto it = mData.months.constBegin(); it != end; ++it) {
+    Counts counts;
+    if (email.isEmpty()) {
+      foreach (const Counts &author, it.value())
+        counts += author;
+    } else {
+      counts = it.value().value(email.toLower());
+    }
+
+    if (counts.commits)
+      timeline.insert(QDate(it.key() / 12, it.key() % 12 + 1, 1), counts);
+  }
+
+  return timeline;
+}
+
+void Statistics::merge(Data &data, const Data &delta) {
+  auto namesEnd = delta.names.constEnd();
+  for (auto it = delta.names.constBegin(); it != namesEnd; ++it)
+    data.names.insert(it.key(), it.value());
+
+  auto pathsEnd = delta.paths.constEnd();
+  for (auto it = delta.paths.constBegin(); it != pathsEnd; ++it) {
+    AuthorMap &authors = data.paths[it.key()];
+    auto end = it.value().constEnd();
+    for (auto author = it.value().constBegin(); author != end; ++author)
+      authors[author.key()] += author.value();
+  }
+
+  auto monthsEnd = delta.months.constEnd();
+  for (auto it = delta.months.constBegin(); it != monthsEnd; ++it) {
+    AuthorMap &authors = data.months[it.key()];
+    auto end = it.value().constEnd();
+    for (auto author = it.value().constBegin(); author != end; ++author)
+      authors[author.key()] += author.value();
+  }
+}
+
+Statistics::Data Statistics::read(const QString &file) {
+  QFile in(file);
+  if (!in.open(QIODevice::ReadOnly))
+    return Data();
+
+  QDataStream stream(&in);
+  quint8 version;
+  stream >> version;
+  if (version != kVersion)
+    return Data();
+
+  Data data;
+  quint32 count;
+  stream >> count;
+  for (quint32 i = 0; i < count; ++i) {
+    QByteArray id;
+    stream >> id;
+    data.tips.append(git::Id(id));
+  }
+
+  stream >> data.names;
+
+  stream >> count;
+  for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+    QString dir;
+    stream >> dir;
+    data.paths.insert(dir, readAuthors(stream));
+  }
+
+  stream >> count;
+  for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+    qint32 month;
+    stream >> month;
+    data.months.insert(month, readAuthors(stream));
+  }
+
+  if (stream.status() != QDataStream::Ok)
+    return Data();
+
+  return data;
+}
+
+bool Statistics::write(const QString &file, const Data &data) {
+  QSaveFile out(file);
+  if (!out.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream stream(&out);
+  stream << kVersion;
+
+  stream << static_cast<quint32>(data.tips.size());
+  foreach (const git::Id &id, data.tips)
+    stream << id.toByteArray();
+
+  stream << data.names;
+
+  stream << static_cast<quint32>(data.paths.size());
+  auto pathsEnd = data.paths.constEnd();
+  for (auto it = data.paths.constBegin(); it != pathsEnd; ++it) {
+    stream << it.key();
+    writeAuthors(stream, it.value());
+  }
+
+  stream << static_cast<quint32>(data.months.size());
+  auto monthsEnd = data.months.constEnd();
+  for (auto it = data.months.constBegin(); it != monthsEnd; ++it) {
+    stream << it.key();
+    writeAuthors(stream, it.value());
+  }
+
+  return out.commit();
+}
+
+QString Statistics::file() const {
+  return Index::indexDir(mRepo).filePath(kFile);
+}
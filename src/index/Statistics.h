@@ -0,0 +1,86 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include "git/Id.h"
+#include "git/Repository.h"
+#include <QAtomicInt>
+#include <QDate>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QMap>
+#include <QObject>
+
+// Contributor statistics aggregated per author, per directory and per
+// month. New commits are diffed in parallel on a worker and merged into
+// the stored totals, so queries never walk history. Authors are keyed by
+// their mailmap-resolved email. Merge commits aren't counted.
+class Statistics : public QObject {
+  Q_OBJECT
+
+public:
+  struct Counts {
+    quint32 commits = 0;
+    quint32 additions = 0;
+    quint32 deletions = 0;
+
+    Counts &operator+=(const Counts &rhs);
+  };
+
+  struct Author {
+    QString name;
+    QString email;
+    Counts counts;
+  };
+
+  using AuthorMap = QHash<QString, Counts>;
+
+  struct Data {
+    QList<git::Id> tips;
+    QHash<QString, QString> names;
+    QHash<QString, AuthorMap> paths; // by directory, the root is empty
+    QMap<qint32, AuthorMap> months;
+  };
+
+  Statistics(const git::Repository &repo, QObject *parent = nullptr);
+  ~Statistics() override;
+
+  bool isRunning() const { return mWatcher; }
+
+  // Count commits that aren't reachable from the last counted tips.
+  void update();
+
+  // Get authors of changes under the given directory ordered by their
+  // number of commits. The empty path is the whole repository.
+  QList<Author> authors(const QString &path = QString(),
+                        int limit = -1) const;
+
+  // Get monthly totals for all authors or a single author.
+  QMap<QDate, Counts> timeline(const QString &email = QString()) const;
+
+  static void merge(Data &data, const Data &delta);
+
+  static Data read(const QString &file);
+  static bool write(const QString &file, const Data &data);
+
+signals:
+  void updated();
+
+private:
+  QString file() const;
+
+  git::Repository mRepo;
+  Data mData;
+  bool mLoaded = false;
+  bool mPending = false;
+  QAtomicInt mCanceled;
+  QFutureWatcher<Data> *mWatcher = nullptr;
+};
+
+#endif
@@ -0,0 +1,461 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "TrigramIndex.h"
+#include "Index.h"
+#include "git/Blob.h"
+#include "git/Reference.h"
+#include "git/Tree.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+const quint8 kVersion = 2;
+const QString kFile = "trigrams";
+
+// Don't index large blobs. They're usually generated or data files,
+// but they still have to be searched.
+const int kMaxFileSize = 1024 * 1024;
+
+uchar fold(uchar ch) { return (ch >= 'A' && ch <= 'Z') ? ch + 32 : ch; }
+
+// Get the sorted set of case-folded trigrams in the text. Trigrams that
+// span lines are skipped because matches never do.
+QVector<quint32> trigrams(const QByteArray &text, bool ascii = false) {
+  QVector<quint32> result;
+  result.reserve(text.size());
+
+  const uchar *data = reinterpret_cast<const uchar *>(text.constData());
+  for (int i = 2; i < text.size(); ++i) {
+    uchar a = data[i - 2], b = data[i - 1], c = data[i];
+    if (a == '\n' || b == '\n' || c == '\n')
+      continue;
+
+    if (ascii && (a >= 0x80 || b >= 0x80 || c >= 0x80))
+      continue;
+
+    result.append((fold(a) << 16) | (fold(b) << 8) | fold(c));
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+QVector<quint32> intersect(const QVector<quint32> &lhs,
+                           const QVector<quint32> &rhs) {
+  QVector<quint32> result;
+  std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                        std::back_inserter(result));
+  return result;
+}
+
+void addFile(const git::Repository &repo, TrigramIndex::Data &data,
+             const QString &path, const git::Id &id) {
+  git::Blob blob = repo.lookupBlob(id);
+  if (!blob.isValid() || blob.isBinary())
+    return;
+
+  QByteArray content = blob.content();
+  if (content.size() > kMaxFileSize) {
+    data.unindexed.insert(path, id);
+    return;
+  }
+
+  // New ids are always larger, so posting lists stay sorted.
+  quint32 file = data.files.size();
+  data.files.append({path, id});
+  data.paths.insert(path, file);
+  foreach (quint32 trigram, trigrams(content))
+    data.postings[trigram].append(file);
+}
+
+void removeFile(TrigramIndex::Data &data, const QString &path) {
+  if (data.unindexed.remove(path))
+    return;
+
+  auto it = data.paths.find(path);
+  if (it == data.paths.end())
+    return;
+
+  // Leave the postings. They're filtered out when querying.
+  data.files[it.value()] = Grep::Entry();
+  data.paths.erase(it);
+  ++data.removed;
+}
+
+void compact(TrigramIndex::Data &data) {
+  QVector<quint32> map(data.files.size());
+  Grep::Entries files;
+  for (int i = 0; i < data.files.size(); ++i) {
+    const Grep::Entry &entry = data.files.at(i);
+    map[i] = files.size();
+    if (!entry.path.isEmpty()) {
+      data.paths[entry.path] = files.size();
+      files.append(entry);
+    }
+  }
+
+  auto it = data.postings.begin();
+  while (it != data.postings.end()) {
+    QVector<quint32> postings;
+    foreach (quint32 file, it.value()) {
+      if (!data.files.at(file).path.isEmpty())
+        postings.append(map.at(file));
+    }
+
+    if (postings.isEmpty()) {
+      it = data.postings.erase(it);
+    } else {
+      it.value() = postings;
+      ++it;
+    }
+  }
+
+  data.files = files;
+  data.removed = 0;
+}
+
+} // namespace
+
+TrigramIndex::TrigramIndex(const git::Repository &repo, QObject *parent)
+    : QObject(parent), mRepo(repo) {
+  git::RepositoryNotifier *notifier = repo.notifier();
+  connect(notifier, &git::RepositoryNotifier::referenceUpdated, this,
+          &TrigramIndex::update);
+  connect(notifier, &git::RepositoryNotifier::workdirChanged, this,
+          &TrigramIndex::update);
+}
+
+TrigramIndex::~TrigramIndex() {
+  if (mWatcher)
+    mWatcher->waitForFinished();
+}
+
+void TrigramIndex::update() {
+  if (mWatcher) {
+    mPending = true;
+    return;
+  }
+
+  git::Commit commit = mRepo.head().target();
+  git::Id tree = commit.isValid() ? commit.tree().id() : git::Id();
+  if (mLoaded && tree == mData.tree)
+    return;
+
+  QFutureWatcher<Data> *watcher = new QFutureWatcher<Data>(this);
+  connect(watcher, &QFutureWatcher<Data>::finished, this, [this, watcher] {
+    watcher->deleteLater();
+    mData = watcher->result();
+    mLoaded = true;
+    mWatcher = nullptr;
+    emit updated();
+
+    if (mPending) {
+      mPending = false;
+      update();
+    }
+  });
+
+  // Read the stored index the first time. Write it back when it changes.
+  mWatcher = watcher;
+  bool loaded = mLoaded;
+  watcher->setFuture(QtConcurrent::run(
+      [repo = mRepo, data = mData, tree, file = file(), loaded] {
+        Data result = loaded ? data : read(file);
+        if (result.tree == tree)
+          return result;
+
+        result = build(repo, result, tree);
+        write(file, result);
+        return result;
+      }));
+}
+
+bool TrigramIndex::candidates(const Grep::Options &options,
+                              Grep::Entries &files) const {
+  // Only ASCII is folded the same way by the index and the matcher.
+  bool narrowed = false;
+  QVector<quint32> ids;
+  foreach (const QByteArray &literal,
+           literals(options.pattern, options.regex)) {
+    foreach (quint32 trigram, trigrams(literal, !options.caseSensitive)) {
+      QVector<quint32> postings = mData.postings.value(trigram);
+      ids = narrowed ? intersect(ids, postings) : postings;
+      narrowed = true;
+
+      if (ids.isEmpty())
+        break;
+    }
+  }
+
+  if (!narrowed)
+    return false;
+
+  files.clear();
+  foreach (quint32 id, ids) {
+    const Grep::Entry &entry = mData.files.at(id);
+    if (!entry.path.isEmpty())
+      files.append(entry);
+  }
+
+  auto end = mData.unindexed.constEnd();
+  for (auto it = mData.unindexed.constBegin(); it != end; ++it)
+    files.append({it.key(), it.value()});
+
+  return true;
+}
+
+QList<QByteArray> TrigramIndex::literals(const QString &pattern,
+                                         bool regex) {
+  if (!regex)
+    return {pattern.toUtf8()};
+
+  // Collect runs of literal characters outside of groups. Anything that
+  // makes a character optional ends the run without it.
+  QList<QByteArray> result;
+  QString run;
+  int depth = 0;
+  auto flush = [&result, &run, &depth] {
+    if (depth == 0 && !run.isEmpty())
+      result.append(run.toUtf8());
+    run.clear();
+  };
+
+  int length = pattern.length();
+  for (int i = 0; i < length; ++i) {
+    QChar ch = pattern.at(i);
+    switch (ch.unicode()) {
+      case '|':
+        // Nothing is required from either side of a top-level alternation.
+        if (depth == 0)
+          return QList<QByteArray>();
+        break;
+
+      case '(':
+        flush();
+        ++depth;
+
+        // Extended mode makes whitespace insignificant.
+        if (i + 1 < length && pattern.at(i + 1) == '?') {
+          for (int j = i + 2; j < length; ++j) {
+            QChar flag = pattern.at(j);
+            if (flag == 'x')
+              return QList<QByteArray>();
+            if (flag == ')' || flag == ':')
+              break;
+          }
+        }
+        break;
+
+      case ')':
+        flush();
+        depth = qMax(0, depth - 1);
+        break;
+
+      case '[':
+        flush();
+        for (++i; i < length; ++i) {
+          if (pattern.at(i) == '\\') {
+            ++i;
+          } else if (pattern.at(i) == ']' && pattern.at(i - 1) != '[' &&
+                     pattern.at(i - 1) != '^') {
+            break;
+          }
+        }
+        break;
+
+      case '{':
+        while (i < length && pattern.at(i) != '}')
+          ++i;
+        // fall through
+
+      case '*':
+      case '?':
+        run.chop(1);
+        flush();
+        break;
+
+      case '+':
+      case '.':
+      case '^':
+      case '$':
+        flush();
+        break;
+
+      case '\\':
+        if (++i < length) {
+          QChar next = pattern.at(i);
+          if (next.isLetterOrNumber()) {
+            flush();
+          } else {
+            run.append(next);
+          }
+        }
+        break;
+
+      default:
+        run.append(ch);
+        break;
+    }
+  }
+
+  flush();
+  return result;
+}
+
+TrigramIndex::Data TrigramIndex::build(const git::Repository &repo,
+                                       const Data &data,
+                                       const git::Id &tree) {
+  Data result = data;
+  git::Tree oldTree;
+  if (data.tree.isValid()) {
+    oldTree = repo.lookupTree(data.tree);
+    if (!oldTree.isValid())
+      result = Data();
+  }
+
+  git::Tree newTree;
+  if (tree.isValid())
+    newTree = repo.lookupTree(tree);
+
+  // Diff against the indexed tree to find changed blobs.
+  git::Diff diff = repo.diffTreeToTree(oldTree, newTree);
+  int count = diff.isValid() ? diff.count() : 0;
+  for (int i = 0; i < count; ++i) {
+    QString path = diff.name(i);
+    switch (diff.status(i)) {
+      case GIT_DELTA_DELETED:
+        removeFile(result, path);
+        break;
+
+      case GIT_DELTA_MODIFIED:
+      case GIT_DELTA_TYPECHANGE:
+        removeFile(result, path);
+        // fall through
+
+      case GIT_DELTA_ADDED:
+        addFile(repo, result, path, diff.id(i, git::Diff::NewFile));
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  if (result.removed > result.files.size() / 2)
+    compact(result);
+
+  result.tree = tree;
+  return result;
+}
+
+TrigramIndex::Data TrigramIndex::read(const QString &file) {
+  QFile in(file);
+  if (!in.open(QIODevice::ReadOnly))
+    return Data();
+
+  QDataStream stream(&in);
+  quint8 version;
+  stream >> version;
+  if (version != kVersion)
+    return Data();
+
+  Data data;
+  QByteArray tree;
+  quint32 count;
+  stream >> tree >> count;
+  data.tree = tree.isEmpty() ? git::Id() : git::Id(tree);
+
+  // Files are compacted before they're written.
+  data.files.reserve(count);
+  for (quint32 i = 0; i < count; ++i) {
+    QString path;
+    QByteArray id;
+    stream >> path >> id;
+    data.paths.insert(path, i);
+    data.files.append({path, git::Id(id)});
+  }
+
+  // Posting lists are delta encoded.
+  stream >> count;
+  data.postings.reserve(count);
+  for (quint32 i = 0; i < count; ++i) {
+    quint32 trigram;
+    stream >> trigram;
+
+    quint32 size = Index::readVInt(stream);
+    QVector<quint32> &postings = data.postings[trigram];
+    postings.reserve(size);
+
+    quint32 file = 0;
+    for (quint32 j = 0; j < size; ++j) {
+      file += Index::readVInt(stream);
+      postings.append(file);
+    }
+  }
+
+  stream >> count;
+  data.unindexed.reserve(count);
+  for (quint32 i = 0; i < count; ++i) {
+    QString path;
+    QByteArray id;
+    stream >> path >> id;
+    data.unindexed.insert(path, git::Id(id));
+  }
+
+  if (stream.status() != QDataStream::Ok)
+    return Data();
+
+  return data;
+}
+
+bool TrigramIndex::write(const QString &file, const Data &data) {
+  Data compacted = data;
+  if (compacted.removed)
+    compact(compacted);
+
+  QSaveFile out(file);
+  if (!out.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream stream(&out);
+  stream << kVersion;
+  stream << (compacted.tree.isValid() ? compacted.tree.toByteArray()
+                                      : QByteArray());
+
+  stream << static_cast<quint32>(compacted.files.size());
+  foreach (const Grep::Entry &entry, compacted.files)
+    stream << entry.path << entry.id.toByteArray();
+
+  stream << static_cast<quint32>(compacted.postings.size());
+  auto end = compacted.postings.constEnd();
+  for (auto it = compacted.postings.constBegin(); it != end; ++it) {
+    stream << it.key();
+    Index::writeVInt(stream, it.value().size());
+
+    quint32 prev = 0;
+    foreach (quint32 file, it.value()) {
+      Index::writeVInt(stream, file - prev);
+      prev = file;
+    }
+  }
+
+  stream << static_cast<quint32>(compacted.unindexed.size());
+  auto unindexedEnd = compacted.unindexed.constEnd();
+  for (auto it = compacted.unindexed.constBegin(); it != unindexedEnd; ++it)
+    stream << it.key() << it.value().toByteArray();
+
+  return out.commit();
+}
+
+QString TrigramIndex::file() const { return mRepo.appDir().filePath(kFile); }
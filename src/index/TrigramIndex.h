@@ -0,0 +1,73 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include "Grep.h"
+#include "git/Id.h"
+#include "git/Repository.h"
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+// A trigram index of the content of the tree at HEAD. It's stored in the
+// repository's app dir and updated incrementally on a worker whenever HEAD
+// moves to a new tree. Queries intersect the posting lists of trigrams that
+// every match must contain to select candidate files for Grep to verify.
+class TrigramIndex : public QObject {
+  Q_OBJECT
+
+public:
+  struct Data {
+    git::Id tree;
+    Grep::Entries files; // removed files have an empty path
+    QHash<QString, quint32> paths;
+    QHash<quint32, QVector<quint32>> postings;
+    QHash<QString, git::Id> unindexed; // text files that are too large
+    int removed = 0;
+  };
+
+  TrigramIndex(const git::Repository &repo, QObject *parent = nullptr);
+  ~TrigramIndex() override;
+
+  // the indexed tree
+  git::Id tree() const { return mData.tree; }
+
+  // Index the current HEAD tree if it has changed.
+  void update();
+
+  // Get files at the indexed tree that may contain a match. Text files
+  // that were too large to index are always included. Returns false if
+  // the query can't be narrowed down by trigrams.
+  bool candidates(const Grep::Options &options, Grep::Entries &files) const;
+
+  // Get the literal strings that every match of the query must contain.
+  static QList<QByteArray> literals(const QString &pattern, bool regex);
+
+  // Bring the data up to date with the given tree.
+  static Data build(const git::Repository &repo, const Data &data,
+                    const git::Id &tree);
+
+  static Data read(const QString &file);
+  static bool write(const QString &file, const Data &data);
+
+signals:
+  void updated();
+
+private:
+  QString file() const;
+
+  git::Repository mRepo;
+  Data mData;
+  bool mLoaded = false;
+  bool mPending = false;
+  QFutureWatcher<Data> *mWatcher = nullptr;
+};
+
+#endif
@@ -9,12 +9,13 @@
 
 #include "Index.h"
 #include "GenericLexer.h"
-#include "LPegLexer.h"
+#include "LexerPool.h"
 #include "qtsupport.h"
 #include "conf/Settings.h"
 #include "git/Config.h"
+#include "git/IdHash.h"
 #include "git/Index.h"
-#include "git/Patch.h"
+#include "git/RefSnapshot.h"
 #include "git/Repository.h"
 #include "git/RevWalk.h"
 #include "git/Signature.h"
@@ -23,10 +24,15 @@
 #include <QDataStream>
 #include <QDateTime>
 #include <QFutureWatcher>
+#include <QLocalServer>
+#include <QLocalSocket>
 #include <QLockFile>
 #include <QMap>
-#include <QRegularExpression>
+#include <QSet>
+#include <QSocketNotifier>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QTimer>
 #include <QtConcurrent>
 
 #ifndef Q_OS_WIN
@@ -87,10 +93,16 @@ namespace {
 
 const QString kLogFile = "log";
 
-const QRegularExpression kWsRe("\\s+");
+// commits per batch
+const int kBatchSize = 8192;
+const int kServerBatchSize = 1024;
 
-// global cancel flag
-bool canceled = false;
+// milliseconds that the server waits for a client before it exits
+const int kIdleTimeout = 30000;
+
+// bytes of diff content per file and per commit
+const qint64 kFileLimit = 1024 * 1024;
+const qint64 kCommitLimit = 16 * 1024 * 1024;
 
 #ifdef Q_OS_UNIX
 // signal handler
@@ -199,50 +211,138 @@ void index(const Lexer::Lexeme &lexeme, Intermediate::FieldMap &fields,
   }
 }
 
-class LexerPool {
+// Lexes diff content as it's generated. Files larger than the file limit
+// are skipped before their content is loaded. Generation stops once the
+// commit exceeds the term limit or the size limit. Every file is indexed
+// by name, including binary files and files after the limits.
+class Tokenizer : public git::Diff::Visitor {
 public:
-  LexerPool() : mHome(Settings::lexerDir().path().toUtf8()) {}
+  Tokenizer(LexerPool &lexers, Intermediate::FieldMap &fields,
+            const QAtomicInt *canceled, quint32 termLimit, qint64 sizeLimit)
+      : mLexers(lexers), mFields(fields), mCanceled(canceled),
+        mTermLimit(termLimit), mSizeLimit(sizeLimit) {}
+
+  ~Tokenizer() { release(); }
+
+  // the number of files that were visited
+  int files() const { return mFiles; }
+
+  // Index file name and path.
+  void path(const QString &path) {
+    QFileInfo info(path.toLower());
+    mFields[Index::Path][info.filePath().toUtf8()].append(mFilePos);
+    mFields[Index::File][info.fileName().toUtf8()].append(mFilePos++);
+  }
+
+  bool file(const QString &path, bool binary) override {
+    release();
+    if (!proceed())
+      return false;
 
-  ~LexerPool() { qDeleteAll(mLexers); }
+    ++mFiles;
+    this->path(path);
 
-  Lexer *acquire(const QByteArray &name) {
-    QMutexLocker locker(&mMutex);
-    (void)locker;
+    // Skip binary deltas.
+    if (binary)
+      return true;
 
-    return mLexers.contains(name) ? mLexers.take(name)
-                                  : new LPegLexer(mHome, name);
+    // Look up lexer.
+    QByteArray name = Settings::instance()->lexer(path).toUtf8();
+    mLexer = (name == "null") ? &mGeneric : mLexers.acquire(name);
+    return true;
   }
 
-  void release(Lexer *lexer) {
-    QMutexLocker locker(&mMutex);
-    (void)locker;
+  bool hunk(const QByteArray &header) override {
+    if (!proceed())
+      return false;
+
+    // Index hunk header.
+    if (mLexer && mLexer->lex(header)) {
+      while (mLexer->hasNext())
+        index(mLexer->next(), mFields, Index::Scope, mHunkPos);
+    }
 
-    mLexers.insert(lexer->name(), lexer);
+    return true;
+  }
+
+  bool line(char origin, const QByteArray &content) override {
+    if (!proceed())
+      return false;
+
+    Index::Field field;
+    switch (origin) {
+      case GIT_DIFF_LINE_CONTEXT:
+        field = Index::Context;
+        break;
+      case GIT_DIFF_LINE_ADDITION:
+        field = Index::Addition;
+        break;
+      case GIT_DIFF_LINE_DELETION:
+        field = Index::Deletion;
+        break;
+      default:
+        return true;
+    }
+
+    // Lex one line at a time.
+    mSize += content.size();
+    if (mLexer && mLexer->lex(content)) {
+      while (!isCanceled() && mLexer->hasNext())
+        index(mLexer->next(), mFields, field, mDiffPos);
+    }
+
+    return true;
   }
 
 private:
-  QByteArray mHome;
-  QMutex mMutex;
-  QMultiMap<QByteArray, Lexer *> mLexers;
+  bool isCanceled() const { return mCanceled->loadAcquire(); }
+
+  // Truncate commits after the term or size limit.
+  bool proceed() const {
+    return !isCanceled() && mDiffPos <= mTermLimit && mSize <= mSizeLimit;
+  }
+
+  // Return lexer to the pool.
+  void release() {
+    if (mLexer && mLexer != &mGeneric)
+      mLexers.release(mLexer);
+    mLexer = nullptr;
+  }
+
+  LexerPool &mLexers;
+  Intermediate::FieldMap &mFields;
+  const QAtomicInt *mCanceled;
+  quint32 mTermLimit;
+  qint64 mSizeLimit;
+
+  GenericLexer mGeneric;
+  Lexer *mLexer = nullptr;
+
+  qint64 mSize = 0;
+  int mFiles = 0;
+  quint32 mFilePos = 0;
+  quint32 mHunkPos = 0;
+  quint32 mDiffPos = 0;
 };
 
 class Map {
 public:
   typedef Intermediate result_type;
 
-  Map(const git::Repository &repo, LexerPool &lexers, QFile *out)
-      : mLexers(lexers), mOut(out) {
+  Map(const git::Repository &repo, LexerPool &lexers, QFile *out,
+      const QAtomicInt *canceled)
+      : mLexers(lexers), mIdentities(repo.identities()), mOut(out),
+        mCanceled(canceled) {
     git::Config config = repo.appConfig();
     mTermLimit = config.value<int>("index.termlimit", mTermLimit);
     mContextLines = config.value<int>("index.contextlines", mContextLines);
+    mFileLimit = config.value<int>("index.filelimit", mFileLimit);
+    mCommitLimit = config.value<int>("index.commitlimit", mCommitLimit);
   }
 
   Intermediate operator()(const git::Commit &commit) {
     log(mOut, "map: %1", commit.id());
 
-    quint32 filePos = 0;
-    quint32 hunkPos = 0;
-
     Intermediate result;
     result.id = commit.id();
 
@@ -254,16 +354,14 @@ public:
     QByteArray date = time.date().toString(Index::dateFormat()).toUtf8();
     result.fields[Index::Date][date].append(0);
 
-    // Index author name and email.
-    git::Signature author = commit.author();
-    QByteArray email = author.email().toUtf8().toLower();
-    result.fields[Index::Email][email].append(0);
+    // Index author name and email. Terms are computed once per identity.
+    git::Identities::Identity author =
+        mIdentities->identity(mIdentities->author(commit));
+    result.fields[Index::Email][author.emailTerm].append(0);
 
     quint32 namePos = 0;
-    foreach (const QString &name, author.name().split(kWsRe)) {
-      QByteArray key = name.toUtf8().toLower();
+    foreach (const QByteArray &key, author.nameTerms)
       result.fields[Index::Author][key].append(namePos++);
-    }
 
     // Index message.
     GenericLexer generic;
@@ -272,96 +370,42 @@ public:
     while (generic.hasNext())
       index(generic.next(), result.fields, Index::Message, messagePos);
 
-    // Index diff.
-    quint32 diffPos = 0;
-    git::Diff diff = commit.diff(git::Commit(), mContextLines, true);
-    int patches = diff.count();
-    for (int pidx = 0; pidx < patches; ++pidx) {
-      // Truncate commits after term limit.
-      if (canceled || diffPos > mTermLimit)
-        break;
-
-      // Skip binary deltas.
-      if (diff.isBinary(pidx))
-        continue;
-
-      // Generate patch.
-      git::Patch patch = diff.patch(pidx);
-      if (!patch.isValid())
-        continue;
-
-      // Index file name and path.
-      QFileInfo info(patch.name().toLower());
-      result.fields[Index::Path][info.filePath().toUtf8()].append(filePos);
-      result.fields[Index::File][info.fileName().toUtf8()].append(filePos++);
-
-      // Look up lexer.
-      QByteArray name = Settings::instance()->lexer(patch.name()).toUtf8();
-      Lexer *lexer = (name == "null") ? &generic : mLexers.acquire(name);
-
-      // Lex one line at a time.
-      int hunks = patch.count();
-      for (int hidx = 0; hidx < hunks; ++hidx) {
-        if (canceled || diffPos > mTermLimit)
-          break;
-
-        // Index hunk header.
-        QByteArray header = patch.header(hidx);
-        if (lexer->lex(header)) {
-          while (lexer->hasNext())
-            index(lexer->next(), result.fields, Index::Scope, hunkPos);
-        }
-
-        // Index content.
-        int lines = patch.lineCount(hidx);
-        for (int line = 0; line < lines; ++line) {
-          if (canceled || diffPos > mTermLimit)
-            break;
-
-          Index::Field field;
-          switch (patch.lineOrigin(hidx, line)) {
-            case GIT_DIFF_LINE_CONTEXT:
-              field = Index::Context;
-              break;
-            case GIT_DIFF_LINE_ADDITION:
-              field = Index::Addition;
-              break;
-            case GIT_DIFF_LINE_DELETION:
-              field = Index::Deletion;
-              break;
-            default:
-              continue;
-          }
-
-          if (lexer->lex(patch.lineContent(hidx, line))) {
-            while (!canceled && lexer->hasNext())
-              index(lexer->next(), result.fields, field, diffPos);
-          }
-        }
-      }
-
-      // Return lexer to the pool.
-      if (lexer != &generic)
-        mLexers.release(lexer);
+    // Index diff. Content is lexed as it's generated.
+    Tokenizer tokenizer(mLexers, result.fields, mCanceled, mTermLimit,
+                        mCommitLimit);
+    git::Diff diff =
+        commit.diff(git::Commit(), mContextLines, true, mFileLimit);
+    if (!diff.visit(tokenizer)) {
+      // Index the names of files that weren't visited.
+      int count = diff.count();
+      for (int i = tokenizer.files(); i < count && !isCanceled(); ++i)
+        tokenizer.path(diff.name(i));
     }
 
     return result;
   }
 
 private:
+  bool isCanceled() const { return mCanceled->loadAcquire(); }
+
   LexerPool &mLexers;
+  git::Identities *mIdentities;
   QFile *mOut;
+  const QAtomicInt *mCanceled;
 
   int mContextLines = 3;
   quint32 mTermLimit = 1000000;
+  qint64 mFileLimit = kFileLimit;
+  qint64 mCommitLimit = kCommitLimit;
 };
 
 class Reduce {
 public:
-  Reduce(Index::IdList &ids, QFile *out) : mIds(ids), mOut(out) {}
+  Reduce(Index::IdList &ids, QFile *out, const QAtomicInt *canceled)
+      : mIds(ids), mOut(out), mCanceled(canceled) {}
 
   void operator()(Index::PostingMap &result, const Intermediate &intermediate) {
-    if (canceled || intermediate.fields.isEmpty())
+    if (mCanceled->loadAcquire() || intermediate.fields.isEmpty())
       return;
 
     log(mOut, "reduce: %1", intermediate.id);
@@ -387,65 +431,72 @@ public:
 private:
   Index::IdList &mIds;
   QFile *mOut;
+  const QAtomicInt *mCanceled;
 };
 
-class Indexer : public QObject, public QAbstractNativeEventFilter {
+class Indexer : public QObject {
 public:
-  Indexer(Index &index, QFile *out, bool notify, QObject *parent = nullptr)
-      : QObject(parent), mIndex(index), mOut(out), mNotify(notify) {
-    mWalker = mIndex.repo().walker();
+  using Callback = std::function<void(bool)>;
+
+  Indexer(Index &index, LexerPool &lexers, QFile *out, int limit,
+          QObject *parent = nullptr)
+      : QObject(parent), mIndex(index), mLexers(lexers), mOut(out),
+        mLimit(limit) {
     connect(&mWatcher, &QFutureWatcher<Index::PostingMap>::finished, this,
             &Indexer::finish);
+  }
 
-#ifdef Q_OS_UNIX
-    if (!socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
-      // Create notifier.
-      QSocketNotifier *notifier =
-          new QSocketNotifier(fds[1], QSocketNotifier::Read, this);
-      connect(notifier, &QSocketNotifier::activated, [this, notifier] {
-        notifier->setEnabled(false);
-        char ch;
-        read(fds[1], &ch, sizeof(ch));
-        cancel();
-        notifier->setEnabled(true);
-      });
+  bool isCanceled() const { return mCanceled.loadAcquire(); }
 
-      // Install handler.
-      struct sigaction sa;
-      sa.sa_handler = &term;
-      sigemptyset(&sa.sa_mask);
-      sa.sa_flags = SA_RESTART;
-      sigaction(SIGTERM, &sa, 0);
-    }
-#endif
-  }
+  // Set the function that's called after each batch
+  // with whether anything was written to disk.
+  void setCallback(const Callback &callback) { mCallback = callback; }
 
+  // Walk again from the current references on the next batch.
+  void rewind() { mRewind = true; }
+
+  // Start the next batch. Returns false if there's nothing left to index.
   bool start() {
     log(mOut, "start");
+    if (mRewind)
+      reset();
 
     // Get list of commits.
     int count = 0;
     QList<git::Commit> commits;
-    git::Commit commit = mWalker.next();
+    while (count < mLimit) {
+      git::Commit commit = mWalker.next();
+      if (!commit.isValid())
+        break;
+
+      // Remember walked commits for the sweep.
+      mReachable.insert(commit.id());
 
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-    QSet<git::Id> ids(mIndex.ids().begin(), mIndex.ids().end());
-#else
-    QSet<git::Id> ids = QSet<git::Id>::fromList(mIndex.ids());
-#endif
-    while (commit.isValid() && count < 8192) {
       // Don't index merge commits.
-      if (!commit.isMerge() && !ids.contains(commit.id())) {
+      if (!commit.isMerge() && mIndexed.insert(commit.id())) {
         commits.append(commit);
         ++count;
       }
-
-      commit = mWalker.next();
     }
 
     if (commits.isEmpty()) {
       log(mOut, "nothing to index");
-      QCoreApplication::quit();
+
+      // The walk is complete. Tombstone commits that aren't reachable
+      // anymore and advance the frontier unless the references moved in
+      // the meantime or a batch failed to write.
+      if (mSwept || mIncomplete || !mRefs.isCurrent())
+        return false;
+
+      mSwept = true;
+      bool changed = mIndex.sweep(unreachable(), mReachable);
+      mIndex.writeFrontier(mTips, mIndex.ids().size());
+      if (changed) {
+        log(mOut, "sweep");
+        QMetaObject::invokeMethod(this, &Indexer::swept, Qt::QueuedConnection);
+        return true;
+      }
+
       return false;
     }
 
@@ -453,35 +504,394 @@ public:
     using CommitList = QList<git::Commit>;
     mWatcher.setFuture(
         QtConcurrent::mappedReduced<Index::PostingMap, CommitList, Map, Reduce>(
-            commits, Map(mIndex.repo(), mLexers, mOut),
-            Reduce(mIndex.ids(), mOut)));
+            commits, Map(mIndex.repo(), mLexers, mOut, &mCanceled),
+            Reduce(mIndex.ids(), mOut, &mCanceled)));
     return true;
   }
 
+  void cancel() {
+    mCanceled.storeRelease(1);
+    mWatcher.cancel();
+    mWatcher.waitForFinished();
+  }
+
+private:
+  void reset() {
+    git::Repository repo = mIndex.repo();
+    mRefs = repo.refSnapshot();
+
+    git::IdSet tips;
+    mTips.clear();
+    for (const git::RefSnapshot::Entry &entry : mRefs.entries()) {
+      if (!entry.commit.isNull() && tips.insert(entry.commit))
+        mTips.append(entry.commit);
+    }
+
+    // Hide history that's already indexed. Fall back
+    // to walking everything if a hide point is gone.
+    mWalker = repo.walker(mTips);
+    mFrontier = mIndex.frontier(&mFrontierCount);
+    foreach (const git::Id &id, mFrontier) {
+      if (!mWalker.hide(id)) {
+        mFrontier.clear();
+        mWalker = repo.walker(mTips);
+        break;
+      }
+    }
+
+    // Build the set of indexed commits once per walk.
+    mIndexed = git::IdSet(mIndex.ids().size());
+    foreach (const git::Id &id, mIndex.ids())
+      mIndexed.insert(id);
+
+    mReachable.clear();
+    mIncomplete = false;
+    mSwept = false;
+    mRewind = false;
+  }
+
+  // Get indexed commits that the current tips don't reach.
+  git::IdSet unreachable() {
+    git::IdSet result;
+    if (mFrontier.isEmpty()) {
+      // Everything reachable was walked.
+      foreach (const git::Id &id, mIndex.ids()) {
+        if (!mReachable.contains(id))
+          result.insert(id);
+      }
+
+      return result;
+    }
+
+    // Walk back from the old frontier to the current tips.
+    git::RevWalk walker = mIndex.repo().walker(mFrontier);
+    foreach (const git::Id &id, mTips)
+      walker.hide(id);
+
+    git::Commit commit = walker.next();
+    while (commit.isValid()) {
+      result.insert(commit.id());
+      commit = walker.next();
+    }
+
+    // Docs that were added after the frontier aren't behind it. They
+    // were reached from tips that have moved or gone since then.
+    const Index::IdList &ids = mIndex.ids();
+    for (int i = mFrontierCount; i < ids.size(); ++i) {
+      if (!mReachable.contains(ids.at(i)))
+        result.insert(ids.at(i));
+    }
+
+    return result;
+  }
+
+  void swept() {
+    if (mCallback)
+      mCallback(true);
+  }
+
   void finish() {
     log(mOut, "finish");
 
-    if (canceled) {
-      QCoreApplication::exit(1);
-    } else {
-      // Write to disk.
+    // Write to disk.
+    bool written = false;
+    if (!isCanceled()) {
       log(mOut, "start write");
-      if (mIndex.write(mWatcher.result()) && mNotify)
-        QTextStream(stdout) << "write" << Qt::endl;
+      written = mIndex.write(mWatcher.result());
+      mIncomplete = mIncomplete || !written;
       log(mOut, "end write");
+    }
+
+    if (mCallback)
+      mCallback(written);
+  }
+
+  Index &mIndex;
+  LexerPool &mLexers;
+  QFile *mOut;
+  int mLimit;
+
+  QAtomicInt mCanceled;
+  Callback mCallback;
+
+  git::RefSnapshot mRefs;
+  Index::IdList mTips;
+  Index::IdList mFrontier;
+  int mFrontierCount = 0;
+  git::IdSet mIndexed;
+  git::IdSet mReachable;
+  bool mRewind = true;
+  bool mIncomplete = false;
+  bool mSwept = false;
+  git::RevWalk mWalker;
+  QFutureWatcher<Index::PostingMap> mWatcher;
+};
+
+// Serve indexing requests for every open repository over a local socket.
+// Batches from different repositories take turns on the shared thread pool
+// and lexers. The focused repository goes first. The server exits when it
+// has been without clients for the idle timeout.
+class Server : public QObject {
+public:
+  Server(int limit, int idle, QObject *parent = nullptr)
+      : QObject(parent), mLimit(limit) {
+    connect(&mServer, &QLocalServer::newConnection, this, &Server::accept);
+
+    mIdle.setInterval(idle);
+    mIdle.setSingleShot(true);
+    connect(&mIdle, &QTimer::timeout, QCoreApplication::instance(),
+            &QCoreApplication::quit);
+  }
+
+  ~Server() { cancel(); }
+
+  bool listen(const QString &name) {
+    // Defer to a server that's already running.
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (socket.waitForConnected(1000))
+      return false;
+
+    // Clean up after a server that didn't exit cleanly.
+    // Only accept connections from the same user.
+    QLocalServer::removeServer(name);
+    mServer.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!mServer.listen(name))
+      return false;
+
+    // Don't wait forever for the client that started the server.
+    mIdle.start();
+    return true;
+  }
+
+  void cancel() {
+    foreach (const QString &path, mJobs.keys())
+      remove(path);
+  }
+
+private:
+  struct Job {
+    QScopedPointer<QLockFile> lock;
+    QScopedPointer<QFile> out;
+    QScopedPointer<Index> index;
+    QScopedPointer<Indexer> indexer;
+
+    // The job runs while it has clients. Clients that canceled
+    // are told when it ends, because it holds the index lock.
+    QSet<QLocalSocket *> clients;
+    QSet<QLocalSocket *> waiting;
+  };
+
+  void accept() {
+    mIdle.stop();
+    while (QLocalSocket *socket = mServer.nextPendingConnection()) {
+      mSockets.insert(socket);
+      connect(socket, &QLocalSocket::readyRead, this,
+              [this, socket] { read(socket); });
+      connect(socket, &QLocalSocket::disconnected, this,
+              [this, socket] { drop(socket); });
+    }
+  }
 
-      // Restart.
-      start();
+  void read(QLocalSocket *socket) {
+    while (socket->canReadLine()) {
+      QString line = QString::fromUtf8(socket->readLine()).trimmed();
+      QString command = line.section(' ', 0, 0);
+      if (command == "index") {
+        bool log = (line.section(' ', 1, 1) == "1");
+        add(socket, line.section(' ', 2), log);
+      } else if (command == "cancel") {
+        cancel(socket, line.section(' ', 1));
+      } else if (command == "focus") {
+        mFocus = line.section(' ', 1);
+      }
     }
   }
 
+  void drop(QLocalSocket *socket) {
+    mSockets.remove(socket);
+    socket->deleteLater();
+
+    foreach (const QString &path, mJobs.keys()) {
+      Job *job = mJobs.value(path);
+      job->clients.remove(socket);
+      job->waiting.remove(socket);
+      if (job->clients.isEmpty())
+        remove(path);
+    }
+
+    // Exit unless a new client connects in time.
+    if (mSockets.isEmpty())
+      mIdle.start();
+
+    schedule();
+  }
+
+  void add(QLocalSocket *socket, const QString &path, bool log) {
+    Job *job = mJobs.value(path);
+    if (!job) {
+      job = open(path, log);
+      if (!job) {
+        send(socket, "done", path);
+        return;
+      }
+
+      mJobs.insert(path, job);
+      mQueue.append(path);
+    } else {
+      // Pick up new commits in the next batch.
+      job->indexer->rewind();
+    }
+
+    job->waiting.remove(socket);
+    job->clients.insert(socket);
+    send(socket, "start", path);
+    schedule();
+  }
+
+  void cancel(QLocalSocket *socket, const QString &path) {
+    Job *job = mJobs.value(path);
+    if (!job) {
+      send(socket, "done", path);
+      return;
+    }
+
+    // Keep going while other clients are interested.
+    // This client is told when the job ends.
+    job->clients.remove(socket);
+    job->waiting.insert(socket);
+    if (job->clients.isEmpty()) {
+      remove(path);
+      schedule();
+    }
+  }
+
+  Job *open(const QString &path, bool log) {
+    git::Repository repo = git::Repository::open(path);
+    if (!repo.isValid())
+      return nullptr;
+
+    // Set empty index to prevent going to the index on disk.
+    repo.setIndex(git::Index::create());
+
+    // Try to lock the index for writing.
+    QScopedPointer<Job> job(new Job);
+    job->lock.reset(new QLockFile(Index::lockFile(repo)));
+    job->lock->setStaleLockTime(Index::staleLockTime());
+    if (!job->lock->tryLock())
+      return nullptr;
+
+    if (log) {
+      QFile *out = new QFile(Index::indexDir(repo).filePath(kLogFile));
+      if (out->open(QIODevice::WriteOnly | QIODevice::Append))
+        job->out.reset(out);
+      else
+        delete out;
+    }
+
+    job->index.reset(new Index(repo));
+    job->indexer.reset(
+        new Indexer(*job->index, mLexers, job->out.data(), mLimit));
+    job->indexer->setCallback(
+        [this, path](bool written) { finish(path, written); });
+
+    return job.take();
+  }
+
+  void remove(const QString &path) {
+    Job *job = mJobs.take(path);
+    mQueue.removeOne(path);
+    if (mCurrent == path)
+      mCurrent.clear();
+
+    job->indexer->cancel();
+    foreach (QLocalSocket *socket, job->clients + job->waiting)
+      send(socket, "done", path);
+
+    delete job;
+  }
+
+  void schedule() {
+    while (mCurrent.isEmpty() && !mQueue.isEmpty()) {
+      // Prefer the focused repository. Otherwise take turns.
+      QString path = mQueue.contains(mFocus) ? mFocus : mQueue.first();
+      mQueue.removeOne(path);
+      mQueue.append(path);
+
+      if (mJobs.value(path)->indexer->start()) {
+        mCurrent = path;
+        return;
+      }
+
+      remove(path);
+    }
+  }
+
+  void finish(const QString &path, bool written) {
+    mCurrent.clear();
+    if (written) {
+      foreach (QLocalSocket *socket, mJobs.value(path)->clients)
+        send(socket, "write", path);
+    }
+
+    // Schedule from the event loop. The indexer might be removed.
+    QMetaObject::invokeMethod(
+        this, [this] { schedule(); }, Qt::QueuedConnection);
+  }
+
+  void send(QLocalSocket *socket, const QString &command,
+            const QString &path) {
+    socket->write(QString("%1 %2\n").arg(command, path).toUtf8());
+  }
+
+  int mLimit;
+  LexerPool mLexers;
+
+  QLocalServer mServer;
+  QSet<QLocalSocket *> mSockets;
+  QTimer mIdle;
+
+  QString mFocus;
+  QString mCurrent;
+  QStringList mQueue;
+  QMap<QString, Job *> mJobs;
+};
+
+// Call the handler on the main thread when asked to terminate.
+class Terminator : public QObject, public QAbstractNativeEventFilter {
+public:
+  Terminator(const std::function<void()> &handler, QObject *parent = nullptr)
+      : QObject(parent), mHandler(handler) {
+#ifdef Q_OS_UNIX
+    if (!socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
+      // Create notifier.
+      QSocketNotifier *notifier =
+          new QSocketNotifier(fds[1], QSocketNotifier::Read, this);
+      connect(notifier, &QSocketNotifier::activated, [this, notifier] {
+        notifier->setEnabled(false);
+        char ch;
+        read(fds[1], &ch, sizeof(ch));
+        mHandler();
+        notifier->setEnabled(true);
+      });
+
+      // Install handler.
+      struct sigaction sa;
+      sa.sa_handler = &term;
+      sigemptyset(&sa.sa_mask);
+      sa.sa_flags = SA_RESTART;
+      sigaction(SIGTERM, &sa, 0);
+    }
+#endif
+  }
+
   bool nativeEventFilter(const QByteArray &type, void *message,
                          long *result) override {
     Q_UNUSED(result);
 #ifdef Q_OS_WIN
     MSG *msg = static_cast<MSG *>(message);
     if (msg->message == WM_CLOSE)
-      cancel();
+      mHandler();
 #else
     Q_UNUSED(type);
     Q_UNUSED(message);
@@ -491,19 +901,7 @@ public:
   }
 
 private:
-  void cancel() {
-    canceled = true;
-    mWatcher.cancel();
-    mWatcher.waitForFinished();
-  }
-
-  Index &mIndex;
-  QFile *mOut;
-  bool mNotify;
-
-  git::RevWalk mWalker;
-  LexerPool mLexers;
-  QFutureWatcher<Index::PostingMap> mWatcher;
+  std::function<void()> mHandler;
 };
 
 class RepoInit {
@@ -535,16 +933,60 @@ int main(int argc, char *argv[]) {
   parser.addOption({{"v", "verbose"}, "Print indexer progress to stdout."});
   parser.addOption({{"n", "notify"}, "Notify when data is written to disk."});
   parser.addOption({{"b", "background"}, "Start with background priority."});
+  parser.addOption(
+      {{"s", "server"}, "Serve repositories on a local socket.", "name"});
+  parser.addOption({"threads", "Limit the number of worker threads.", "n"});
+  parser.addOption({"batch", "Limit the number of commits per batch.", "n"});
+  parser.addOption(
+      {"idle", "Exit the server after ms without clients.", "ms"});
+  parser.addOption({"compact", "Drop deleted commits from the index."});
   parser.process(app);
 
+  bool serve = parser.isSet("server");
   QStringList args = parser.positionalArguments();
-  if (args.isEmpty())
+  if (!serve && args.isEmpty())
     parser.showHelp(1);
 
   // Initialize global git state.
   RepoInit init;
   (void)init;
 
+  // Set priority.
+  if (parser.isSet("background")) {
+#ifdef Q_OS_WIN
+    SetPriorityClass(GetCurrentProcess(), BELOW_NORMAL_PRIORITY_CLASS);
+#else
+    setpriority(PRIO_PROCESS, 0, 15);
+#endif
+  }
+
+  // Limit the share of the CPU. The server leaves half for the app.
+  int threads = parser.value("threads").toInt();
+  if (threads <= 0 && serve)
+    threads = qMax(1, QThread::idealThreadCount() / 2);
+  if (threads > 0)
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+  // Limit the size of the in-memory postings per batch.
+  int limit = parser.value("batch").toInt();
+  if (limit <= 0)
+    limit = serve ? kServerBatchSize : kBatchSize;
+
+  // Serve all repositories from one process.
+  if (serve) {
+    int idle = parser.value("idle").toInt();
+    Server server(limit, idle > 0 ? idle : kIdleTimeout);
+    if (!server.listen(parser.value("server")))
+      return 0;
+
+    Terminator terminator([&server] {
+      server.cancel();
+      QCoreApplication::exit(1);
+    });
+    app.installNativeEventFilter(&terminator);
+    return app.exec();
+  }
+
   git::Repository repo = git::Repository::open(args.first());
   if (!repo.isValid())
     parser.showHelp(1);
@@ -568,15 +1010,6 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  // Set priority.
-  if (parser.isSet("background")) {
-#ifdef Q_OS_WIN
-    SetPriorityClass(GetCurrentProcess(), BELOW_NORMAL_PRIORITY_CLASS);
-#else
-    setpriority(PRIO_PROCESS, 0, 15);
-#endif
-  }
-
   // Try to lock the index for writing.
   QLockFile lock(Index::lockFile(repo));
   lock.setStaleLockTime(Index::staleLockTime());
@@ -584,8 +1017,27 @@ int main(int argc, char *argv[]) {
     return 0;
 
   // Start the indexer.
+  LexerPool lexers;
   Index index(repo);
-  Indexer indexer(index, out, parser.isSet("notify"));
-  app.installNativeEventFilter(&indexer);
+  if (parser.isSet("compact"))
+    return index.compact() ? 0 : 1;
+  Indexer indexer(index, lexers, out, limit);
+  bool notify = parser.isSet("notify");
+  indexer.setCallback([&indexer, notify](bool written) {
+    if (indexer.isCanceled()) {
+      QCoreApplication::exit(1);
+      return;
+    }
+
+    if (written && notify)
+      QTextStream(stdout) << "write" << Qt::endl;
+
+    // Restart.
+    if (!indexer.start())
+      QCoreApplication::quit();
+  });
+
+  Terminator terminator([&indexer] { indexer.cancel(); });
+  app.installNativeEventFilter(&terminator);
   return indexer.start() ? app.exec() : 0;
 }
@@ -0,0 +1,280 @@
+//
+//          Copyright (c) 2017, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "DirDiffTool.h"
+#include "git/Blob.h"
+#include "git/Command.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QtConcurrent>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(Q_OS_LINUX)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#endif
+
+namespace {
+
+const QString kLocalDir = "left";
+const QString kRemoteDir = "right";
+
+// Share the worktree file instead of copying it. Hard links let the tool
+// write changes back. Fall back to a copy-on-write clone, then a copy.
+bool linkFile(const QString &source, const QString &target) {
+#if defined(Q_OS_WIN)
+  if (CreateHardLinkW(reinterpret_cast<LPCWSTR>(target.utf16()),
+                      reinterpret_cast<LPCWSTR>(source.utf16()), nullptr))
+    return true;
+#else
+  QByteArray src = QFile::encodeName(source);
+  QByteArray dst = QFile::encodeName(target);
+  if (::link(src, dst) == 0)
+    return true;
+
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+  int in = ::open(src, O_RDONLY);
+  if (in >= 0) {
+    int out = ::open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool cloned = (out >= 0 && ::ioctl(out, FICLONE, in) == 0);
+    if (out >= 0)
+      ::close(out);
+    ::close(in);
+
+    if (cloned)
+      return true;
+
+    ::unlink(dst);
+  }
+#endif
+#endif
+
+  return QFile::copy(source, target);
+}
+
+// Check if both paths refer to the same file, i.e. they're hard links.
+bool sameFile(const QString &lhs, const QString &rhs) {
+#if defined(Q_OS_WIN)
+  auto info = [](const QString &path, BY_HANDLE_FILE_INFORMATION &data) {
+    HANDLE handle = CreateFileW(reinterpret_cast<LPCWSTR>(path.utf16()), 0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE |
+                                    FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, 0, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+      return false;
+
+    bool result = GetFileInformationByHandle(handle, &data);
+    CloseHandle(handle);
+    return result;
+  };
+
+  BY_HANDLE_FILE_INFORMATION a, b;
+  return (info(lhs, a) && info(rhs, b) &&
+          a.dwVolumeSerialNumber == b.dwVolumeSerialNumber &&
+          a.nFileIndexHigh == b.nFileIndexHigh &&
+          a.nFileIndexLow == b.nFileIndexLow);
+#else
+  struct stat a, b;
+  return (::stat(QFile::encodeName(lhs), &a) == 0 &&
+          ::stat(QFile::encodeName(rhs), &b) == 0 && a.st_dev == b.st_dev &&
+          a.st_ino == b.st_ino);
+#endif
+}
+
+bool containsPath(const QStringList &paths, const QString &name) {
+  foreach (const QString &path, paths) {
+    if (name == path || name.startsWith(path + '/'))
+      return true;
+  }
+
+  return false;
+}
+
+} // namespace
+
+DirDiffTool::DirDiffTool(const QStringList &files, const git::Diff &diff,
+                         const git::Repository &repo, QObject *parent)
+    : ExternalTool(repo.workdir().path(), parent), mFiles(files),
+      mDiff(diff), mRepo(repo) {}
+
+bool DirDiffTool::isValid() const {
+  return (ExternalTool::isValid() && mDiff.isValid());
+}
+
+ExternalTool::Kind DirDiffTool::kind() const { return Diff; }
+
+QString DirDiffTool::name() const { return tr("External Directory Diff"); }
+
+bool DirDiffTool::start() {
+  Q_ASSERT(isValid());
+
+  bool shell = false;
+  QString command = lookupCommand("diff", shell);
+  if (command.isEmpty())
+    return false;
+
+#if !defined(FLATPAK) && !defined(DEBUG_FLATPAK)
+  if (shell && git::Command::bashPath().isEmpty()) {
+    emit error(BashNotFound);
+    return false;
+  }
+#endif
+
+  // Collect both sides of every selected file.
+  mDir.reset(new QTemporaryDir);
+  QDir local(QDir(mDir->path()).filePath(kLocalDir));
+  QDir remote(QDir(mDir->path()).filePath(kRemoteDir));
+  if (!mDir->isValid() || !local.mkpath(".") || !remote.mkpath("."))
+    return false;
+
+  QDir workdir = mRepo.workdir();
+  bool status = mDiff.isStatusDiff();
+  for (int i = 0; i < mDiff.count(); ++i) {
+    QString name = mDiff.name(i);
+    git_delta_t delta = mDiff.status(i);
+    if (delta == GIT_DELTA_CONFLICTED ||
+        (!mFiles.isEmpty() && !containsPath(mFiles, name)))
+      continue;
+
+    if (delta != GIT_DELTA_ADDED && delta != GIT_DELTA_UNTRACKED) {
+      git::Id id = mDiff.id(i, git::Diff::OldFile);
+      mFilesToWrite.append({id, QString(), local.filePath(name)});
+    }
+
+    if (delta != GIT_DELTA_DELETED) {
+      // The new side of a status diff is the worktree itself.
+      git::Id id = mDiff.id(i, git::Diff::NewFile);
+      QString source = status ? workdir.filePath(name) : QString();
+      mFilesToWrite.append({id, source, remote.filePath(name)});
+    }
+  }
+
+  if (mFilesToWrite.isEmpty())
+    return false;
+
+  // Destroy this after the process finishes.
+  setParent(nullptr);
+
+  connect(&mWatcher, &QFutureWatcher<void>::finished, this, [this] {
+    if (!launch())
+      deleteLater();
+  });
+
+  // Write blobs in parallel.
+  git::Repository repo = mRepo;
+  mWatcher.setFuture(
+      QtConcurrent::map(mFilesToWrite, [repo](File &file) {
+        QDir().mkpath(QFileInfo(file.target).path());
+        if (!file.source.isEmpty()) {
+          if (linkFile(file.source, file.target)) {
+            QFileInfo info(file.target);
+            file.linked = sameFile(file.source, file.target);
+            file.modified = info.lastModified();
+            file.size = info.size();
+          }
+
+          return;
+        }
+
+        git::Blob blob = repo.lookupBlob(file.id);
+        if (!blob.isValid())
+          return; // submodules
+
+        QFile out(file.target);
+        if (out.open(QFile::WriteOnly))
+          out.write(blob.content());
+      }));
+
+  return true;
+}
+
+bool DirDiffTool::launch() {
+  bool shell = false;
+  QString command = lookupCommand("diff", shell);
+  QString localPath = QDir(mDir->path()).filePath(kLocalDir);
+  QString remotePath = QDir(mDir->path()).filePath(kRemoteDir);
+
+  QProcess *process = new QProcess(this);
+  process->setProcessChannelMode(
+      QProcess::ProcessChannelMode::ForwardedChannels);
+  auto signal = QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished);
+  QObject::connect(process, signal, this, [this] {
+    writeBack();
+    deleteLater();
+  });
+
+#if defined(FLATPAK) || defined(DEBUG_FLATPAK)
+  QStringList arguments = {"--host", "--env=LOCAL=" + localPath,
+                           "--env=REMOTE=" + remotePath,
+                           "--env=MERGED=" + remotePath,
+                           "--env=BASE=" + localPath};
+  arguments.append("sh");
+  arguments.append("-c");
+  arguments.append(command);
+  process->start("flatpak-spawn", arguments);
+#else
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("LOCAL", localPath);
+  env.insert("REMOTE", remotePath);
+  env.insert("MERGED", remotePath);
+  env.insert("BASE", localPath);
+  process->setProcessEnvironment(env);
+
+  QString bash = git::Command::bashPath();
+  if (!bash.isEmpty()) {
+    process->start(bash, {"-c", command});
+  } else if (!shell) {
+    process->start(git::Command::substitute(env, command));
+  } else {
+    return false;
+  }
+#endif
+
+  if (!process->waitForStarted()) {
+    qDebug() << "DirDiffTool starting failed";
+    return false;
+  }
+
+  return true;
+}
+
+void DirDiffTool::writeBack() {
+  foreach (const File &file, mFilesToWrite) {
+    if (file.source.isEmpty() || file.size < 0)
+      continue;
+
+    // Edits made through a hard link are already in the worktree. Tools
+    // that save atomically replace the link with a new file though. Copies
+    // and clones always have to be written back when they changed.
+    QFileInfo info(file.target);
+    if (!info.exists() || (file.linked && sameFile(file.source, file.target)))
+      continue;
+
+    if (file.linked || info.lastModified() != file.modified ||
+        info.size() != file.size) {
+      // Keep the worktree file and its permissions. Only replace content.
+      QFile in(file.target);
+      QFile out(file.source);
+      if (!in.open(QFile::ReadOnly) ||
+          !out.open(QFile::WriteOnly | QFile::Truncate)) {
+        qDebug() << "DirDiffTool failed to write back" << file.source;
+        continue;
+      }
+
+      out.write(in.readAll());
+    }
+  }
+}
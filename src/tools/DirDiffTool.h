@@ -0,0 +1,62 @@
+//
+//          Copyright (c) 2017, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef DIRDIFFTOOL_H
+#define DIRDIFFTOOL_H
+
+#include "ExternalTool.h"
+#include "git/Diff.h"
+#include "git/Id.h"
+#include "git/Repository.h"
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QVector>
+
+// Writes both sides of a diff into temporary directories and launches a
+// single diff tool process to compare them. Worktree files that the tool
+// replaced or changed are written back when the process exits.
+class DirDiffTool : public ExternalTool {
+  Q_OBJECT
+
+public:
+  DirDiffTool(const QStringList &files, const git::Diff &diff,
+              const git::Repository &repo, QObject *parent = nullptr);
+
+  bool isValid() const override;
+
+  Kind kind() const override;
+  QString name() const override;
+
+  bool start() override;
+
+private:
+  struct File {
+    git::Id id;     // blob to write
+    QString source; // worktree file to link instead
+    QString target;
+
+    // State of the target after it was written
+    bool linked = false;
+    QDateTime modified;
+    qint64 size = -1;
+  };
+
+  bool launch();
+  void writeBack();
+
+  QStringList mFiles;
+  git::Diff mDiff;
+  git::Repository mRepo;
+
+  QScopedPointer<QTemporaryDir> mDir;
+  QVector<File> mFilesToWrite;
+  QFutureWatcher<void> mWatcher;
+};
+
+#endif
@@ -72,12 +72,14 @@ void BlameMargin::setBlame(const git::Repository &repo,
   }
 
   mTimer.stop();
+  mRepo = repo;
   mSource = blame;
   updateBlame();
 }
 
 void BlameMargin::clear() {
   mName = QString();
+  mRepo = git::Repository();
   mBlame = git::Blame();
   mSource = git::Blame();
 
@@ -109,7 +111,7 @@ bool BlameMargin::event(QEvent *event) {
     QString email, date;
     git::Signature signature = mBlame.signature(index);
     if (signature.isValid()) {
-      email = QString("&lt;%1&gt;").arg(signature.email());
+      email = QString("&lt;%1&gt;").arg(identity(signature).email);
       date = QLocale().toString(signature.date(), QLocale::LongFormat);
     }
 
@@ -361,5 +363,12 @@ QString BlameMargin::name(int index) const {
     return tr("Not Committed");
 
   git::Signature signature = mBlame.signature(index);
-  return signature.isValid() ? signature.name() : tr("Invalid Signature");
+  return signature.isValid() ? identity(signature).name
+                             : tr("Invalid Signature");
+}
+
+git::Identities::Identity
+BlameMargin::identity(const git::Signature &signature) const {
+  git::Identities *identities = mRepo.identities();
+  return identities->identity(identities->intern(signature));
 }
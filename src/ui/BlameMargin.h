@@ -12,15 +12,12 @@
 
 #include "git/Id.h"
 #include "git/Blame.h"
+#include "git/Repository.h"
 #include <QTimer>
 #include <QWidget>
 
 class TextEditor;
 
-namespace git {
-class Repository;
-}
-
 class BlameMargin : public QWidget {
   Q_OBJECT
 
@@ -49,10 +46,12 @@ private:
 
   int index(int y) const;
   QString name(int index) const;
+  git::Identities::Identity identity(const git::Signature &signature) const;
 
   QString mName;
   TextEditor *mEditor;
 
+  git::Repository mRepo;
   git::Blame mBlame;
   git::Blame mSource;
 
@@ -12,6 +12,7 @@
 #include "Location.h"
 #include "MainWindow.h"
 #include "ProgressIndicator.h"
+#include "RangeDiff.h"
 #include "RepoView.h"
 #include "Debug.h"
 #include "ConfigKeys.h"
@@ -23,8 +24,11 @@
 #include "git/Commit.h"
 #include "git/Config.h"
 #include "git/Diff.h"
+#include "git/IdHash.h"
 #include "git/Index.h"
 #include "git/Patch.h"
+#include "git/RefSnapshot.h"
+#include "git/Reflog.h"
 #include "git/RevWalk.h"
 #include "git/Signature.h"
 #include "git/TagRef.h"
@@ -51,6 +55,9 @@ const QString kPathspecFmt = "pathspec:%1";
 // FIXME: Use 'core.abbrev' config instead?
 const int kShortIdSize = 7;
 
+// number of reflog entries to decode at a time
+const int kReflogPageSize = 64;
+
 enum GraphSegment {
   Dot,
   Top,
@@ -119,6 +126,11 @@ public:
     // Cancel existing status diff.
     cancelStatus();
 
+    if (mStatusSuspended) {
+      mStatusPending = true;
+      return;
+    }
+
     // Reload the index before starting the status thread. Allowing
     // it to reload on the thread frequently corrupts the index.
     mRepo.index().read();
@@ -143,6 +155,16 @@ public:
     mStatusCallbacks.setCanceled(false);
   }
 
+  void setStatusSuspended(bool suspended) {
+    mStatusSuspended = suspended;
+    if (suspended) {
+      cancelStatus();
+    } else if (mStatusPending) {
+      mStatusPending = false;
+      startStatus();
+    }
+  }
+
   void setPathspec(const QString &pathspec) {
     if (mPathspec == pathspec)
       return;
@@ -224,9 +246,10 @@ public:
       }
 
       if (mRefsFilter == CommitList::RefsFilter::AllRefs) {
-        foreach (const git::Reference ref, mRepo.refs()) {
-          if (!ref.isStash())
-            mWalker.push(ref);
+        git::RefSnapshot snapshot = mRepo.refSnapshot();
+        for (const git::RefSnapshot::Entry &entry : snapshot.entries()) {
+          if (!entry.commit.isNull() && entry.name != "refs/stash")
+            mWalker.push(entry.commit);
         }
       }
     }
@@ -552,6 +575,8 @@ private:
 
   DiffCallbacks mStatusCallbacks;
   QFutureWatcher<git::Diff> mStatus;
+  bool mStatusSuspended = false;
+  bool mStatusPending = false;
 
   QString mPathspec;
   git::Reference mRef;
@@ -579,10 +604,43 @@ public:
 
   void setList(const QList<git::Commit> &commits) {
     beginResetModel();
+    mRef = git::Reference();
+    mRepo = git::Repository();
+    mReflog = git::Reflog();
+    mEntries.clear();
     mCommits = commits;
     endResetModel();
   }
 
+  // Entries are looked up a page at a time as the view scrolls.
+  void setReflog(const git::Reference &ref) {
+    beginResetModel();
+    mRef = ref;
+    mRepo = ref.repo();
+    mReflog = ref.reflog();
+    mNext = 0;
+    mEntries.clear();
+    mCommits.clear();
+    mCommits.append(nextPage());
+    endResetModel();
+  }
+
+  bool canFetchMore(const QModelIndex &parent) const override {
+    return mReflog.isValid() && mNext < mReflog.count();
+  }
+
+  void fetchMore(const QModelIndex &parent) override {
+    QList<git::Commit> commits = nextPage();
+    if (commits.isEmpty())
+      return;
+
+    int first = mCommits.size();
+    int last = first + commits.size() - 1;
+    beginInsertRows(QModelIndex(), first, last);
+    mCommits.append(commits);
+    endInsertRows();
+  }
+
   int rowCount(const QModelIndex &parent = QModelIndex()) const override {
     return mCommits.size();
   }
@@ -600,12 +658,39 @@ public:
 
       case CommitList::Role::CommitRole:
         return QVariant::fromValue(mCommits.at(index.row()));
+
+      case CommitList::Role::StashRole:
+        // Rows don't match entries if some commits were missing.
+        if (mRef.isValid() && mRef.isStash())
+          return mEntries.at(index.row());
+        break;
     }
 
     return QVariant();
   }
 
 private:
+  QList<git::Commit> nextPage() {
+    QList<git::Commit> commits;
+    int count = mReflog.count();
+    int end = qMin(mNext + kReflogPageSize, count);
+    for (; mNext < end; ++mNext) {
+      // Skip entries that point to missing commits.
+      if (git::Commit commit = mRepo.lookupCommit(mReflog.id(mNext))) {
+        commits.append(commit);
+        mEntries.append(mNext);
+      }
+    }
+
+    return commits;
+  }
+
+  git::Reference mRef;
+  git::Repository mRepo;
+  git::Reflog mReflog;
+  QList<int> mEntries;
+  int mNext = 0;
+
   QList<git::Commit> mCommits;
 };
 
@@ -850,7 +935,7 @@ public:
 
         // Draw Name.
         if (showAuthor) {
-          QString name = commit.author().name() + "  ";
+          QString name = author(commit) + "  ";
           painter->save();
           QFont bold = opt.font;
           bold.setBold(true);
@@ -893,7 +978,7 @@ public:
         // Draw Name.
         QString name = "";
         if (showAuthor) {
-          name = commit.author().name();
+          name = author(commit);
           painter->save();
           QFont bold = opt.font;
           bold.setBold(true);
@@ -1118,6 +1203,12 @@ private:
     return {compact ? 7 : 8, compact ? 23 : 16, compact ? 5 : 2, 4};
   }
 
+  // Resolve the interned author instead of decoding the signature.
+  QString author(const git::Commit &commit) const {
+    git::Identities *identities = mRepo.identities();
+    return identities->identity(identities->author(commit)).name;
+  }
+
   void updateRefs() {
     mRefs.clear();
 
@@ -1127,10 +1218,18 @@ private:
           {Badge::Label::Type::Ref, head.name(), true});
     }
 
-    foreach (const git::Reference &ref, mRepo.refs()) {
-      if (git::Commit target = ref.target())
-        mRefs[target.id()].append(
-            {Badge::Label::Type::Ref, ref.name(), ref.isHead(), ref.isTag()});
+    git::Reference head = mRepo.head();
+    QByteArray headName = head.isValid() ? head.qualifiedName().toUtf8() : "";
+
+    git::RefSnapshot snapshot = mRepo.refSnapshot();
+    for (const git::RefSnapshot::Entry &entry : snapshot.entries()) {
+      if (entry.commit.isNull())
+        continue;
+
+      QString name = git::RefSnapshot::shorthand(entry.name);
+      bool tag = entry.name.startsWith("refs/tags/");
+      mRefs[entry.commit].append(
+          {Badge::Label::Type::Ref, name, entry.name == headName, tag});
     }
   }
 
@@ -1151,7 +1250,7 @@ private:
   }
 
   git::Repository mRepo;
-  QMap<git::Id, QList<Badge::Label>> mRefs;
+  git::IdMap<QList<Badge::Label>> mRefs;
 
   mutable int mMaxShortIdWidth = -1;
 };
@@ -1182,7 +1281,7 @@ static Hotkey selectCommitUpHotKey = HotkeyManager::registerHotkey(
     "k", "commitList/selectCommitUp", "CommitList/Select Next Commit Up");
 
 CommitList::CommitList(Index *index, QWidget *parent)
-    : QListView(parent), mIndex(index) {
+    : QListView(parent), mIndex(index), mRangeDiffs(new RangeDiff(this)) {
   Theme *theme = Application::theme();
   setPalette(theme->commitList());
 
@@ -1198,6 +1297,11 @@ CommitList::CommitList(Index *index, QWidget *parent)
   setModel(mModel);
   setItemDelegate(new CommitDelegate(repo, this));
 
+  connect(mRangeDiffs, &RangeDiff::finished, this,
+          [this](const git::Diff &diff) {
+            emit diffSelected(diff, mPendingFile, mPendingSpontaneous);
+          });
+
   connect(mModel, &QAbstractItemModel::modelAboutToBeReset, this,
           &CommitList::storeSelection);
   connect(mModel, &QAbstractItemModel::modelReset, this,
@@ -1287,11 +1391,13 @@ git::Diff CommitList::selectedDiff() const {
   if (!first.isValid())
     return git::Diff();
 
+  // Adjacent commits have the same diff as the newer one.
   git::Commit last = indexes.last().data(CommitRole).value<git::Commit>();
   bool ignoreWhitespace = Settings::instance()->isWhitespaceIgnored();
-  git::Diff diff = first.diff(last, -1, ignoreWhitespace);
-  diff.findSimilar();
-  return diff;
+  if (RangeDiff::key(first, last, ignoreWhitespace).isEmpty())
+    return indexes.first().data(DiffRole).value<git::Diff>();
+
+  return mRangeDiffs->diff(first, last, ignoreWhitespace);
 }
 
 QList<git::Commit> CommitList::selectedCommits() const {
@@ -1309,6 +1415,10 @@ void CommitList::cancelStatus() {
   static_cast<CommitModel *>(mModel)->cancelStatus();
 }
 
+void CommitList::setStatusSuspended(bool suspended) {
+  static_cast<CommitModel *>(mModel)->setStatusSuspended(suspended);
+}
+
 void CommitList::setReference(const git::Reference &ref) {
   static_cast<CommitModel *>(mModel)->setReference(ref);
   if (!isResetWalkerSuppressed())
@@ -1334,6 +1444,11 @@ void CommitList::setCommits(const QList<git::Commit> &commits) {
   static_cast<ListModel *>(mList)->setList(commits);
 }
 
+void CommitList::setReflog(const git::Reference &ref) {
+  setModel(mList);
+  static_cast<ListModel *>(mList)->setReflog(ref);
+}
+
 void CommitList::selectReference(const git::Reference &ref) {
   if (!ref.isValid())
     return;
@@ -1527,14 +1642,12 @@ void CommitList::contextMenuEvent(QContextMenuEvent *event) {
   menu.setToolTipsVisible(true);
 
   // stash
-  git::Reference ref = static_cast<CommitModel *>(mModel)->reference();
-  if (ref.isValid() && ref.isStash()) {
-    menu.addAction(tr("Apply"),
-                   [view, index] { view->applyStash(index.row()); });
-
-    menu.addAction(tr("Pop"), [view, index] { view->popStash(index.row()); });
-
-    menu.addAction(tr("Drop"), [view, index] { view->dropStash(index.row()); });
+  QVariant stash = index.data(StashRole);
+  if (stash.isValid()) {
+    int entry = stash.toInt();
+    menu.addAction(tr("Apply"), [view, entry] { view->applyStash(entry); });
+    menu.addAction(tr("Pop"), [view, entry] { view->popStash(entry); });
+    menu.addAction(tr("Drop"), [view, entry] { view->dropStash(entry); });
 
   } else {
     // multiple selection
@@ -1783,7 +1896,7 @@ void CommitList::updateModel() {
 
   git::Reference ref = static_cast<CommitModel *>(mModel)->reference();
   if (ref.isValid() && ref.isStash()) {
-    setCommits(ref.repo().stashes());
+    setReflog(ref);
     return;
   }
 
@@ -1854,6 +1967,23 @@ void CommitList::notifySelectionChanged() {
   // Redraw all selected indexes. Separators may have changed.
   foreach (const QModelIndex &index, indexes)
     update(index);
+
+  // Compute uncached range diffs in the background.
+  mRangeDiffs->cancel();
+  QModelIndexList sorted = sortedIndexes();
+  if (sorted.size() > 1) {
+    git::Commit first = sorted.first().data(CommitRole).value<git::Commit>();
+    git::Commit last = sorted.last().data(CommitRole).value<git::Commit>();
+    bool ignoreWhitespace = Settings::instance()->isWhitespaceIgnored();
+    QString key = RangeDiff::key(first, last, ignoreWhitespace);
+    if (!key.isEmpty() && !mRangeDiffs->cached(key).isValid()) {
+      mPendingFile = mFile;
+      mPendingSpontaneous = mSpontaneous;
+      mRangeDiffs->request(first, last, ignoreWhitespace);
+      return;
+    }
+  }
+
   git::Diff diff = selectedDiff();
   emit diffSelected(diff, mFile, mSpontaneous);
 }
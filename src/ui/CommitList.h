@@ -14,6 +14,7 @@
 #include <QListView>
 
 class Index;
+class RangeDiff;
 
 namespace git {
 class Commit;
@@ -24,7 +25,13 @@ class CommitList : public QListView {
   Q_OBJECT
 
 public:
-  enum Role { DiffRole = Qt::UserRole, CommitRole, GraphRole, GraphColorRole };
+  enum Role {
+    DiffRole = Qt::UserRole,
+    CommitRole,
+    GraphRole,
+    GraphColorRole,
+    StashRole // stash index of rows that show the stash reflog
+  };
   enum class RefsFilter {
     AllRefs,
     SelectedRef,
@@ -44,10 +51,15 @@ public:
   // Cancel background status diff.
   void cancelStatus();
 
+  // Don't read the index while it's written in the background.
+  // A status diff that was requested meanwhile starts on resume.
+  void setStatusSuspended(bool suspended);
+
   void setReference(const git::Reference &ref);
   void setFilter(const QString &filter);
   void setPathspec(const QString &pathspec, bool index = false);
   void setCommits(const QList<git::Commit> &commits);
+  void setReflog(const git::Reference &ref);
 
   void selectReference(const git::Reference &ref);
   void resetSelection(bool spontaneous = false);
@@ -105,6 +117,11 @@ private:
   bool mRestoreSelection{true};
 
   QString mSelectedRange;
+
+  // Range diffs and the selection state of the pending one.
+  RangeDiff *mRangeDiffs;
+  QString mPendingFile;
+  bool mPendingSpontaneous = false;
 };
 
 #endif
@@ -328,17 +328,25 @@ public:
     if (commits.isEmpty())
       return;
 
+    git::Identities *identities = commits.first().repo().identities();
+
     // Show range details.
     if (commits.size() > 1) {
       git::Commit last = commits.last();
       git::Commit first = commits.first();
 
       // Add names.
-      QSet<QString> authors, committers;
+      QSet<quint32> authorIds, committerIds;
       foreach (const git::Commit &commit, commits) {
-        authors.insert(kBoldFmt.arg(commit.author().name()));
-        committers.insert(kBoldFmt.arg(commit.committer().name()));
+        authorIds.insert(identities->author(commit));
+        committerIds.insert(identities->committer(commit));
       }
+
+      QSet<QString> authors, committers;
+      foreach (quint32 id, authorIds)
+        authors.insert(kBoldFmt.arg(identities->identity(id).name));
+      foreach (quint32 id, committerIds)
+        committers.insert(kBoldFmt.arg(identities->identity(id).name));
       QStringList author = authors.values();
       if (author.size() > 3)
         author = author.mid(0, 3) << kBoldFmt.arg("...");
@@ -386,15 +394,17 @@ public:
 
     // Populate details.
     git::Commit commit = commits.first();
-    git::Signature author = commit.author();
-    git::Signature committer = commit.committer();
+    git::Identities::Identity author =
+        identities->identity(identities->author(commit));
+    git::Identities::Identity committer =
+        identities->identity(identities->committer(commit));
     QDateTime date = commit.committer().date().toLocalTime();
     mHash->setText(brightText(tr("Id:")) + " " + commit.shortId());
     mAuthorCommitterDate->setDate(
         brightText(QLocale().toString(date, QLocale::LongFormat)));
     mAuthorCommitterDate->setAuthorCommitter(
-        kAuthorFmt.arg(author.name(), author.email()),
-        kAuthorFmt.arg(committer.name(), committer.email()));
+        kAuthorFmt.arg(author.name, author.email),
+        kAuthorFmt.arg(committer.name, committer.email));
 
     QStringList parents;
     foreach (const git::Commit &parent, commit.parents()) {
@@ -418,7 +428,7 @@ public:
       auto w_handler = w->windowHandle();
 
       int size = kSize * w_handler->devicePixelRatio();
-      QByteArray email = commit.author().email().trimmed().toLower().toUtf8();
+      QByteArray email = author.email.trimmed().toLower().toUtf8();
       QByteArray hash =
           QCryptographicHash::hash(email, QCryptographicHash::Md5);
 
@@ -33,6 +33,30 @@ bool asList() {
       .toBool();
 }
 
+void buildTree(Node *root, const git::Diff &diff, bool listView) {
+  for (int patchNum = 0; patchNum < diff.count(); ++patchNum) {
+    QString path = diff.name(patchNum);
+    auto pathParts = path.split("/");
+    root->addChild(pathParts, patchNum, 0, listView);
+  }
+}
+
+// Find the node with the same name and kind (file or folder).
+Node *counterpart(const QHash<QString, Node *> &nodes, const Node *node) {
+  Node *other = nodes.value(node->name());
+  if (!other || other->isFolder() != node->isFolder())
+    return nullptr;
+
+  return other;
+}
+
+QHash<QString, Node *> childrenByName(const Node *node) {
+  QHash<QString, Node *> children;
+  foreach (Node *child, node->children())
+    children.insert(child->name(), child);
+  return children;
+}
+
 } // namespace
 
 DiffTreeModel::DiffTreeModel(const git::Repository &repo, QObject *parent)
@@ -43,21 +67,26 @@ DiffTreeModel::DiffTreeModel(const git::Repository &repo, QObject *parent)
 DiffTreeModel::~DiffTreeModel() { delete mRoot; }
 
 void DiffTreeModel::setMultiColumn(bool multi) {
+  if (mRoot && multi == mMultiColumn)
+    return;
+
   beginResetModel();
   mMultiColumn = multi;
   endResetModel(); // Notify view about the change
 }
 
 void DiffTreeModel::createDiffTree() {
+  mTreeListView = mListView;
+  buildTree(mRoot, mDiff, mListView);
+}
 
-  for (int patchNum = 0; patchNum < mDiff.count(); ++patchNum) {
-    QString path = mDiff.name(patchNum);
-    auto pathParts = path.split("/");
-    mRoot->addChild(pathParts, patchNum, 0, mListView);
+bool DiffTreeModel::setDiff(const git::Diff &diff) {
+  if (diff && mDiff && mRoot && diff.isStatusDiff() && mDiff.isStatusDiff() &&
+      mTreeListView == mListView) {
+    reconcile(diff);
+    return true;
   }
-}
 
-void DiffTreeModel::setDiff(const git::Diff &diff) {
   beginResetModel();
 
   if (diff) {
@@ -68,6 +97,130 @@ void DiffTreeModel::setDiff(const git::Diff &diff) {
   }
 
   endResetModel();
+  return false;
+}
+
+void DiffTreeModel::reconcile(const git::Diff &diff) {
+  Node next(mRoot->name(), -1);
+  buildTree(&next, diff, mListView);
+
+  // Remove stale rows while the patch indices still refer to the old diff.
+  QSet<Node *> dirty;
+  removeStale(mRoot, &next, QModelIndex(), dirty);
+
+  // Every remaining node has a counterpart now. Switch to the new diff.
+  git::Diff prev = mDiff;
+  mDiff = diff;
+  updatePatchIndices(mRoot, &next, prev, dirty);
+  insertNew(mRoot, &next, QModelIndex(), dirty);
+
+  // Notify about changed files and all of their parent folders.
+  QSet<Node *> changed;
+  foreach (Node *node, dirty) {
+    for (; node != mRoot && !changed.contains(node); node = node->parent())
+      changed.insert(node);
+  }
+
+  foreach (Node *node, changed) {
+    QModelIndex index = this->index(node);
+    emit dataChanged(index, index, {Qt::CheckStateRole});
+  }
+}
+
+void DiffTreeModel::removeStale(Node *node, Node *next,
+                                const QModelIndex &parent,
+                                QSet<Node *> &dirty) {
+  QHash<QString, Node *> wanted = childrenByName(next);
+  QList<Node *> children = node->children();
+
+  // Remove contiguous runs from the bottom up.
+  int row = children.size() - 1;
+  while (row >= 0) {
+    Node *child = children.at(row);
+    if (Node *match = counterpart(wanted, child)) {
+      if (child->isFolder())
+        removeStale(child, match, createIndex(row, 0, child), dirty);
+      --row;
+      continue;
+    }
+
+    int last = row;
+    while (row >= 0 && !counterpart(wanted, children.at(row)))
+      --row;
+
+    beginRemoveRows(parent, row + 1, last);
+    for (int i = last; i > row; --i)
+      delete node->takeChild(i);
+    endRemoveRows();
+
+    dirty.insert(node);
+  }
+}
+
+void DiffTreeModel::updatePatchIndices(Node *node, Node *next,
+                                       const git::Diff &prev,
+                                       QSet<Node *> &dirty) {
+  QHash<QString, Node *> wanted = childrenByName(next);
+  foreach (Node *child, node->children()) {
+    Node *match = wanted.value(child->name());
+    if (child->isFolder()) {
+      updatePatchIndices(child, match, prev, dirty);
+      continue;
+    }
+
+    int before = child->patchIndex();
+    int after = match->patchIndex();
+    if (prev.status(before) != mDiff.status(after) ||
+        prev.id(before, git::Diff::OldFile) !=
+            mDiff.id(after, git::Diff::OldFile) ||
+        prev.id(before, git::Diff::NewFile) !=
+            mDiff.id(after, git::Diff::NewFile))
+      dirty.insert(child);
+
+    child->setPatchIndex(after);
+  }
+}
+
+void DiffTreeModel::insertNew(Node *node, Node *next,
+                              const QModelIndex &parent, QSet<Node *> &dirty) {
+  QHash<QString, Node *> existing = childrenByName(node);
+  QList<Node *> wanted = next->takeChildren();
+  for (int row = 0; row < wanted.size(); ++row) {
+    Node *want = wanted.at(row);
+    if (Node *have = existing.value(want->name())) {
+      // Keep the existing node. Move it if the order changed.
+      int from = node->children().indexOf(have, row);
+      if (from != row) {
+        beginMoveRows(parent, from, from, parent, row);
+        node->moveChild(from, row);
+        endMoveRows();
+      }
+
+      if (have->isFolder())
+        insertNew(have, want, createIndex(row, 0, have), dirty);
+      continue;
+    }
+
+    // Insert contiguous runs of new nodes at once.
+    int last = row;
+    while (last + 1 < wanted.size() &&
+           !existing.contains(wanted.at(last + 1)->name()))
+      ++last;
+
+    beginInsertRows(parent, row, last);
+    for (int i = row; i <= last; ++i)
+      node->insertChild(i, wanted.at(i));
+    endInsertRows();
+
+    dirty.insert(node);
+    row = last;
+  }
+
+  // Delete nodes that were replaced by existing ones.
+  foreach (Node *want, wanted) {
+    if (want->parent() == next)
+      delete want;
+  }
 }
 
 void DiffTreeModel::refresh(const QStringList &paths) {
@@ -442,7 +595,8 @@ QVariant DiffTreeModel::getDisplayRole(const QModelIndex &index) const {
 //#############################################################################
 
 Node::Node(const QString &name, int patchIndex, Node *parent)
-    : mName(name), mPatchIndex(patchIndex), mParent(parent) {}
+    : mName(name), mPatchIndex(patchIndex), mFolder(patchIndex < 0),
+      mParent(parent) {}
 
 Node::~Node() { qDeleteAll(mChildren); }
 
@@ -455,10 +609,31 @@ QString Node::path(bool relative) const {
 
 Node *Node::parent() const { return mParent; }
 
+bool Node::isFolder() const { return mFolder; }
+
 bool Node::hasChildren() const { return mChildren.length() > 0; }
 
 QList<Node *> Node::children() const { return mChildren; }
 
+void Node::insertChild(int row, Node *child) {
+  child->mParent = this;
+  mChildren.insert(row, child);
+}
+
+void Node::moveChild(int from, int to) { mChildren.move(from, to); }
+
+Node *Node::takeChild(int row) {
+  Node *child = mChildren.takeAt(row);
+  child->mParent = nullptr;
+  return child;
+}
+
+QList<Node *> Node::takeChildren() {
+  QList<Node *> children = mChildren;
+  mChildren.clear();
+  return children;
+}
+
 void Node::addChild(const QStringList &pathPart, int patchIndex,
                     int indexFirstDifferent, bool listView) {
   Node *node = nullptr;
@@ -559,6 +734,8 @@ void Node::patchIndices(QList<int> &list) {
 
 int Node::patchIndex() const { return mPatchIndex; }
 
+void Node::setPatchIndex(int patchIndex) { mPatchIndex = patchIndex; }
+
 Node *Node::child(const QStringList &name, int listIndex) {
 
   if (name[listIndex] != mName)
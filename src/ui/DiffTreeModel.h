@@ -17,6 +17,7 @@
 #include <QAbstractItemModel>
 #include <QAbstractListModel>
 #include <QFileIconProvider>
+#include <QSet>
 #include "git/Index.h"
 
 class Node : public QObject // item of the model
@@ -33,10 +34,20 @@ public:
   QString path(bool relative = false) const;
 
   Node *parent() const;
+  /*!
+   * \brief isFolder
+   * \return True if the node was created as a folder. A folder
+   * stays a folder while its children are replaced.
+   */
+  bool isFolder() const;
   bool hasChildren() const;
   QList<Node *> children() const;
   void addChild(const QStringList &pathPart, int patchIndex,
                 int indexFirstDifferent, bool listView);
+  void insertChild(int row, Node *child);
+  void moveChild(int from, int to);
+  Node *takeChild(int row);
+  QList<Node *> takeChildren();
   git::Index::StagedState stageState(const git::Index &idx,
                                      ParentStageState searchingState) const;
   void childFiles(QStringList &files);
@@ -54,6 +65,7 @@ public:
    * is a folder and so the index is not valid
    */
   int patchIndex() const;
+  void setPatchIndex(int patchIndex);
   /*!
    * \brief patchIndices
    * Get all patch indices from the current Node
@@ -72,6 +84,10 @@ private:
    * Index of the patch in the diff
    */
   int mPatchIndex{-1};
+  /*!
+   * Folders are created without a patch index
+   */
+  bool mFolder{false};
   Node *mParent{nullptr};
   QList<Node *> mChildren;
 };
@@ -97,7 +113,14 @@ public:
   DiffTreeModel(const git::Repository &repo, QObject *parent = nullptr);
   virtual ~DiffTreeModel();
 
-  void setDiff(const git::Diff &diff = git::Diff());
+  /*!
+   * \brief setDiff
+   * Consecutive status diffs are reconciled with the current tree. Only
+   * rows of paths that appeared, disappeared or changed are signaled, so
+   * existing nodes and their expansion state are kept.
+   * \return true if the tree was reconciled instead of reset
+   */
+  bool setDiff(const git::Diff &diff = git::Diff());
   void refresh(const QStringList &paths);
   void setMultiColumn(bool);
 
@@ -160,6 +183,14 @@ private:
   void handleDataChanged(const QModelIndex &index, int role);
 
 private:
+  void reconcile(const git::Diff &diff);
+  void removeStale(Node *node, Node *next, const QModelIndex &parent,
+                   QSet<Node *> &dirty);
+  void updatePatchIndices(Node *node, Node *next, const git::Diff &prev,
+                          QSet<Node *> &dirty);
+  void insertNew(Node *node, Node *next, const QModelIndex &parent,
+                 QSet<Node *> &dirty);
+
   Node *node(const QModelIndex &index) const;
   QVariant getDisplayRole(const QModelIndex &index) const;
 
@@ -170,6 +201,7 @@ private:
   git::Repository mRepo;
 
   bool mListView = false;
+  bool mTreeListView = false;
   bool mMultiColumn{true};
 };
 
@@ -397,11 +397,8 @@ void DoubleTreeWidget::setDiff(const git::Diff &diff, const QString &file,
   // Remember selection.
   storeSelection();
 
-  // Reset model.
-  // because of this, the content in the view is shown.
   TreeProxy *proxy = static_cast<TreeProxy *>(unstagedFiles->model());
   DiffTreeModel *model = static_cast<DiffTreeModel *>(proxy->sourceModel());
-  model->setDiff(diff);
 
   // Single tree & list view.
   bool singleTree =
@@ -419,6 +416,10 @@ void DoubleTreeWidget::setDiff(const git::Diff &diff, const QString &file,
   // Widget modifications.
   model->enableListView(listView);
   model->setMultiColumn(multiColumn);
+
+  // Reset or reconcile model.
+  // because of this, the content in the view is shown.
+  bool reconciled = model->setDiff(diff);
   stagedFiles->setRootIsDecorated(!listView);
   unstagedFiles->setRootIsDecorated(!listView);
   // mUnstagedCommitedFiles->setVisible(!singleTree);
@@ -429,13 +430,18 @@ void DoubleTreeWidget::setDiff(const git::Diff &diff, const QString &file,
                                // otherwise the collapse counter is wrong
   stagedFiles->updateView();
 
+  // do not expand if to many files exist, it takes really long
+  // So do it only when there are less than 100. A reconciled tree keeps
+  // the expansion state of its existing folders.
+  bool expand = diff.isValid() && diff.count() < fileCountExpansionThreshold;
+
   // If statusDiff, there exist no staged/unstaged, but only
   // the commited files must be shown
   if (!diff.isValid() || diff.isStatusDiff()) {
     mUnstagedCommitedFiles->setText(singleTree ? kAllFiles : kUnstagedFiles);
-    if (diff.isValid() && diff.count() < fileCountExpansionThreshold)
+    if (expand)
       stagedFiles->expandAll();
-    else
+    else if (!reconciled)
       stagedFiles->collapseAll();
 
     proxy->enableFilter(!singleTree);
@@ -445,11 +451,9 @@ void DoubleTreeWidget::setDiff(const git::Diff &diff, const QString &file,
     mStagedWidget->setVisible(false);
   }
 
-  // do not expand if to many files exist, it takes really long
-  // So do it only when there are less than 100
-  if (diff.isValid() && diff.count() < fileCountExpansionThreshold)
+  if (expand)
     unstagedFiles->expandAll();
-  else
+  else if (!reconciled)
     unstagedFiles->collapseAll();
 
   // Clear editor.
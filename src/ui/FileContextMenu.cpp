@@ -17,6 +17,7 @@
 #include "git/Index.h"
 #include "git/Tree.h"
 #include "host/Repository.h"
+#include "tools/DirDiffTool.h"
 #include "tools/EditTool.h"
 #include "tools/ShowTool.h"
 #include <QApplication>
@@ -96,6 +97,20 @@ FileContextMenu::FileContextMenu(RepoView *view, const QStringList &files,
   if (!diff.isValid())
     return;
 
+  auto connectError = [this](ExternalTool *tool) {
+    connect(tool, &ExternalTool::error, [this](ExternalTool::Error error) {
+      if (error != ExternalTool::BashNotFound)
+        return;
+
+      QString title = tr("Bash Not Found");
+      QString text = tr("Bash was not found on your PATH.");
+      QMessageBox msg(QMessageBox::Warning, title, text, QMessageBox::Ok,
+                      this);
+      msg.setInformativeText(tr("Bash is required to execute external tools."));
+      msg.exec();
+    });
+  };
+
   // Create external tools.
   QList<ExternalTool *> showTools;
   QList<ExternalTool *> editTools;
@@ -128,18 +143,7 @@ FileContextMenu::FileContextMenu(RepoView *view, const QStringList &files,
           break;
       }
 
-      connect(tool, &ExternalTool::error, [this](ExternalTool::Error error) {
-        if (error != ExternalTool::BashNotFound)
-          return;
-
-        QString title = tr("Bash Not Found");
-        QString text = tr("Bash was not found on your PATH.");
-        QMessageBox msg(QMessageBox::Warning, title, text, QMessageBox::Ok,
-                        this);
-        msg.setInformativeText(
-            tr("Bash is required to execute external tools."));
-        msg.exec();
-      });
+      connectError(tool);
     }
   }
 
@@ -147,6 +151,13 @@ FileContextMenu::FileContextMenu(RepoView *view, const QStringList &files,
   addExternalToolsAction(showTools);
   addExternalToolsAction(editTools);
   addExternalToolsAction(diffTools);
+
+  // Compare several files in a single tool process.
+  if (diffTools.size() > 1) {
+    DirDiffTool *tool = new DirDiffTool(files, diff, repo, this);
+    connectError(tool);
+    addExternalToolsAction({tool});
+  }
   addExternalToolsAction(mergeTools);
 
   if (!isEmpty())
@@ -54,7 +54,8 @@ public:
     switch (role) {
       case Qt::EditRole:
       case Qt::DisplayRole:
-        return dict().at(index.row()).key;
+        // The index may have been reloaded since the row count was taken.
+        return dict().value(index.row(), Index::Word(QByteArray())).key;
 
       default:
         return QVariant();
@@ -66,8 +67,8 @@ public:
   }
 
 private:
-  const Index::Dictionary &dict() const {
-    return mWindow->currentView()->index()->dict();
+  Index::Dictionary dict() const {
+    return mWindow->currentView()->index()->snapshot()->dict();
   }
 
   MainWindow *mWindow;
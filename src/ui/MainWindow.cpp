@@ -11,6 +11,7 @@
 #include "AdvancedSearchWidget.h"
 #include "IndexCompleter.h"
 #include "MenuBar.h"
+#include "RepoState.h"
 #include "RepoView.h"
 #include "SearchField.h"
 #include "SideBar.h"
@@ -21,6 +22,7 @@
 #include "git/Repository.h"
 #include "git/Config.h"
 #include "git/Submodule.h"
+#include "index/IndexService.h"
 #include "qmap.h"
 #include <QApplication>
 #include <QCloseEvent>
@@ -136,6 +138,10 @@ MainWindow::MainWindow(const git::Repository &repo, QWidget *parent,
   connect(tabs, &TabWidget::currentChanged, [this](int index) {
     updateInterface();
     MenuBar::instance(this)->update();
+
+    // Index the visible repository first.
+    if (RepoView *view = currentView())
+      IndexService::instance()->setFocus(view->repo());
   });
 
   connect(tabs, QOverload<>::of(&TabWidget::tabInserted), this,
@@ -250,11 +256,8 @@ RepoView *MainWindow::addTab(const git::Repository &repo) {
 
   RepoView *view = new RepoView(repo, this);
   view->detailSplitterMaximize(mMenuBar->isMaximized());
-  git::RepositoryNotifier *notifier = repo.notifier();
-  connect(notifier, &git::RepositoryNotifier::referenceUpdated, this,
+  connect(view->repoState(), &RepoState::changed, this,
           &MainWindow::updateInterface);
-  connect(notifier, &git::RepositoryNotifier::stateChanged, this,
-          [this] { updateWindowTitle(); });
 
   emit tabs->tabAboutToBeInserted();
   tabs->setCurrentIndex(tabs->addTab(view, dir.dirName()));
@@ -506,58 +509,42 @@ void MainWindow::updateInterface() {
   if (mClosing)
     return;
 
-  int ahead = 0;
-  int behind = 0;
-  if (RepoView *view = currentView()) {
-    if (git::Branch head = view->repo().head()) {
-      if (git::Branch upstream = head.upstream()) {
-        ahead = head.difference(upstream);
-        behind = upstream.difference(head);
-      }
-    }
-  }
+  RepoView *view = currentView();
+  RepoState::Snapshot state =
+      view ? view->repoState()->snapshot() : RepoState::Snapshot();
 
-  updateWindowTitle(ahead, behind);
-  mToolBar->updateButtons(ahead, behind);
+  updateWindowTitle();
+  mToolBar->updateButtons(state.ahead, state.behind);
 }
 
-void MainWindow::updateWindowTitle(int ahead, int behind) {
+void MainWindow::updateWindowTitle() {
   RepoView *view = currentView();
   if (!view) {
     setWindowTitle(QCoreApplication::applicationName() + BUILD_DESCRIPTION);
     return;
   }
 
-  git::Repository repo = view->repo();
-  QDir dir = repo.dir(false);
-  git::Reference head = repo.head();
+  const RepoState::Snapshot &snapshot = view->repoState()->snapshot();
+  QDir dir = view->repo().dir(false);
   QString path = mFullPath ? dir.path() : dir.dirName();
-  QString name = head.isValid() ? head.name() : repo.unbornHeadName();
-  QString title = tr("%1 - %2").arg(path, name);
+  QString title = tr("%1 - %2").arg(path, snapshot.headName);
 
   // Add remote tracking information.
-  if (git::Branch branch = head) {
-    if (git::Branch upstream = branch.upstream()) {
-      if (ahead < 0)
-        ahead = branch.difference(upstream);
-      if (behind < 0)
-        behind = upstream.difference(branch);
-
-      QStringList parts;
-      if (ahead > 0)
-        parts.append(tr("ahead: %1").arg(ahead));
-      if (behind > 0)
-        parts.append(tr("behind: %1").arg(behind));
-
-      QString status = parts.isEmpty() ? tr("up-to-date") : parts.join(", ");
-      QString remote = tr("%1 (%2)").arg(status, upstream.name());
-      title = tr("%1 - %2").arg(title, remote);
-    }
+  if (!snapshot.upstreamName.isEmpty()) {
+    QStringList parts;
+    if (snapshot.ahead > 0)
+      parts.append(tr("ahead: %1").arg(snapshot.ahead));
+    if (snapshot.behind > 0)
+      parts.append(tr("behind: %1").arg(snapshot.behind));
+
+    QString status = parts.isEmpty() ? tr("up-to-date") : parts.join(", ");
+    QString remote = tr("%1 (%2)").arg(status, snapshot.upstreamName);
+    title = tr("%1 - %2").arg(title, remote);
   }
 
   // Add state.
   QString state;
-  switch (repo.state()) {
+  switch (snapshot.state) {
     case GIT_REPOSITORY_STATE_MERGE:
       state = tr("MERGING");
       break;
@@ -66,7 +66,7 @@ protected:
 private:
   void updateTabNames();
   void updateInterface();
-  void updateWindowTitle(int ahead = -1, int behind = -1);
+  void updateWindowTitle();
 
   static void warnInvalidRepo(const QString &path);
 
@@ -15,6 +15,7 @@
 #include "History.h"
 #include "HotkeyManager.h"
 #include "MainWindow.h"
+#include "RepoState.h"
 #include "RepoView.h"
 #include "TabWidget.h"
 #include "StateAction.h"
@@ -25,6 +26,8 @@
 #include "cred/CredentialHelper.h"
 #include "dialogs/AboutDialog.h"
 #include "dialogs/CloneDialog.h"
+#include "dialogs/ContributorsDialog.h"
+#include "dialogs/GrepDialog.h"
 #include "dialogs/MergeDialog.h"
 #include "dialogs/RemoteDialog.h"
 #include "dialogs/SettingsDialog.h"
@@ -32,6 +35,7 @@
 #include "dialogs/UpdateSubmodulesDialog.h"
 #include "editor/TextEditor.h"
 #include "git/Reference.h"
+#include "git/ReferenceCatalog.h"
 #include "git/Remote.h"
 #include "git/RevWalk.h"
 #include "git/Submodule.h"
@@ -126,6 +130,9 @@ static Hotkey findPreviousHotkey = HotkeyManager::registerHotkey(
 static Hotkey findSelectionHotkey = HotkeyManager::registerHotkey(
     "Ctrl+E", "edit/findSelection", "Edit/Use Selection for Find");
 
+static Hotkey findInTreeHotkey = HotkeyManager::registerHotkey(
+    nullptr, "edit/findInTree", "Edit/Find in Tree");
+
 static Hotkey refreshHotkey = HotkeyManager::registerHotkey(
     QKeySequence::Refresh, "view/refresh", "View/Refresh");
 
@@ -144,6 +151,9 @@ static Hotkey toggleMenuBarHotkey = HotkeyManager::registerHotkey(
 static Hotkey configureRepositoryHotkey = HotkeyManager::registerHotkey(
     nullptr, "repository/configure", "Repository/Configure Repository");
 
+static Hotkey contributorsHotkey = HotkeyManager::registerHotkey(
+    nullptr, "repository/contributors", "Repository/Contributors");
+
 static Hotkey stageAllHotkey = HotkeyManager::registerHotkey(
     "Ctrl++", "repository/stageAll", "Repository/Stage All");
 
@@ -186,6 +196,9 @@ static Hotkey pushHotkey = HotkeyManager::registerHotkey(
 static Hotkey pushToHotkey = HotkeyManager::registerHotkey(
     "Ctrl+Shift+P", "remote/pushTo", "Remote/Push To");
 
+static Hotkey pushAllHotkey = HotkeyManager::registerHotkey(
+    nullptr, "remote/pushAll", "Remote/Push to All Remotes");
+
 static Hotkey configureBranchesHotkey = HotkeyManager::registerHotkey(
     nullptr, "branch/configure", "Branch/Configure");
 
@@ -483,12 +496,32 @@ MenuBar::MenuBar(QWidget *parent) : QMenuBar(parent) {
     updateFind();
   });
 
+  edit->addSeparator();
+
+  mFindInTree = edit->addAction(tr("Find in Tree..."));
+  findInTreeHotkey.use(mFindInTree);
+  connect(mFindInTree, &QAction::triggered, [this] {
+    RepoView *view = this->view();
+    QList<git::Commit> commits = view->commits();
+    git::Commit commit = !commits.isEmpty() ? commits.first()
+                                            : view->repo().head().target();
+    if (!commit.isValid())
+      return;
+
+    (new GrepDialog(commit, view))->show();
+  });
+
   // View
   QMenu *viewMenu = addMenu(tr("View"));
 
   mRefresh = viewMenu->addAction(tr("Refresh"));
   refreshHotkey.use(mRefresh);
-  connect(mRefresh, &QAction::triggered, [this] { view()->refresh(); });
+  connect(mRefresh, &QAction::triggered, [this] {
+    // Pick up references that were changed outside of the app.
+    RepoView *view = this->view();
+    view->repo().referenceCatalog()->update();
+    view->refresh();
+  });
 
   viewMenu->addSeparator();
 
@@ -541,6 +574,11 @@ MenuBar::MenuBar(QWidget *parent) : QMenuBar(parent) {
   connect(mConfigureRepository, &QAction::triggered,
           [this] { view()->configureSettings(); });
 
+  mContributors = repository->addAction(tr("Contributors..."));
+  contributorsHotkey.use(mContributors);
+  connect(mContributors, &QAction::triggered,
+          [this] { (new ContributorsDialog(view()))->show(); });
+
   repository->addSeparator();
 
   mStageAll = repository->addAction(tr("Stage All"));
@@ -629,6 +667,10 @@ MenuBar::MenuBar(QWidget *parent) : QMenuBar(parent) {
     dialog->open();
   });
 
+  mPushAll = remote->addAction(tr("Push to All Remotes"));
+  pushAllHotkey.use(mPushAll);
+  connect(mPushAll, &QAction::triggered, [this] { view()->pushAll(); });
+
   // Branch
   QMenu *branch = addMenu(tr("Branch"));
 
@@ -1004,6 +1046,7 @@ void MenuBar::updateFind() {
   mFind->setEnabled(view || editor);
   mFindNext->setEnabled((view || editor) && !empty);
   mFindPrevious->setEnabled((view || editor) && !empty);
+  mFindInTree->setEnabled(view);
 }
 
 void MenuBar::updateView() {
@@ -1027,12 +1070,13 @@ void MenuBar::updateRepository() {
   MainWindow *win = qobject_cast<MainWindow *>(window());
   RepoView *view = win ? win->currentView() : nullptr;
   mConfigureRepository->setEnabled(view);
+  mContributors->setEnabled(view);
   mCommit->setEnabled(view && view->isCommitEnabled());
   mStageAll->setEnabled(view && view->isStageEnabled());
   mUnstageAll->setEnabled(view && view->isUnstageEnabled());
   mAmendCommit->setEnabled(view);
 
-  bool lfs = view && view->repo().lfsIsInitialized();
+  bool lfs = view && view->repoState()->snapshot().lfs;
   mLfsUnlock->setEnabled(lfs);
   mLfsInitialize->setEnabled(!lfs);
 }
@@ -1043,11 +1087,12 @@ void MenuBar::updateRemote() {
   mConfigureRemotes->setEnabled(view);
   mFetch->setEnabled(view);
   mFetchAll->setEnabled(view);
-  mPull->setEnabled(view && !view->repo().isBare());
+  mPull->setEnabled(view && !view->repoState()->snapshot().bare);
   mPush->setEnabled(view);
   mFetchFrom->setEnabled(view);
   mPullFrom->setEnabled(view);
   mPushTo->setEnabled(view);
+  mPushAll->setEnabled(view);
 }
 
 void MenuBar::updateBranch() {
@@ -1055,22 +1100,24 @@ void MenuBar::updateBranch() {
   RepoView *view = win ? win->currentView() : nullptr;
   mConfigureBranches->setEnabled(view);
 
+  RepoState::Snapshot state =
+      view ? view->repoState()->snapshot() : RepoState::Snapshot();
   git::Reference ref = view ? view->reference() : git::Reference();
-  git::Reference head = view ? view->repo().head() : git::Reference();
-  mCheckoutCurrent->setEnabled(ref.isValid() && head.isValid() &&
-                               ref.qualifiedName() != head.qualifiedName());
-  mCheckout->setEnabled(head.isValid() && !view->repo().isBare());
+  bool head = state.headValid;
+  mCheckoutCurrent->setEnabled(ref.isValid() && head &&
+                               ref.qualifiedName() != state.headQualifiedName);
+  mCheckout->setEnabled(head && !state.bare);
   mRenameBranch->setEnabled(ref.isLocalBranch());
-  mNewBranch->setEnabled(head.isValid());
+  mNewBranch->setEnabled(head);
 
-  mMerge->setEnabled(head.isValid());
-  mRebase->setEnabled(head.isValid());
-  mSquash->setEnabled(head.isValid());
+  mMerge->setEnabled(head);
+  mRebase->setEnabled(head);
+  mSquash->setEnabled(head);
 
   bool merging = false;
   QString text = tr("Merge");
   if (view) {
-    switch (view->repo().state()) {
+    switch (state.state) {
       case GIT_REPOSITORY_STATE_MERGE:
         merging = true;
         break;
@@ -1095,29 +1142,27 @@ void MenuBar::updateBranch() {
     }
   }
 
-  git::Branch headBranch = head;
   mAbort->setText(tr("Abort %1").arg(text));
-  mAbort->setEnabled(headBranch.isValid() && merging);
+  mAbort->setEnabled(state.headIsBranch && merging);
 }
 
 void MenuBar::updateSubmodules() {
   MainWindow *win = qobject_cast<MainWindow *>(window());
   RepoView *view = win ? win->currentView() : nullptr;
-  QList<git::Submodule> submodules =
-      view ? view->repo().submodules() : QList<git::Submodule>();
+  bool submodules = view && view->repoState()->snapshot().submoduleCount;
 
   mConfigureSubmodules->setEnabled(view);
-  mUpdateSubmodules->setEnabled(!submodules.isEmpty());
-  mInitSubmodules->setEnabled(!submodules.isEmpty());
+  mUpdateSubmodules->setEnabled(submodules);
+  mInitSubmodules->setEnabled(submodules);
 
   // FIXME: This doesn't actually work on Mac.
-  mOpenSubmodule->setEnabled(!submodules.isEmpty());
+  mOpenSubmodule->setEnabled(submodules);
 }
 
 void MenuBar::updateStash() {
   MainWindow *win = qobject_cast<MainWindow *>(window());
   RepoView *view = win ? win->currentView() : nullptr;
-  bool stash = view && view->repo().stashRef().isValid();
+  bool stash = view && view->repoState()->snapshot().stashCount;
   mShowStashes->setEnabled(stash);
   mStash->setEnabled(view && view->isWorkingDirectoryDirty());
   mStashPop->setEnabled(stash);
@@ -84,6 +84,7 @@ private:
   QAction *mFindNext;
   QAction *mFindPrevious;
   QAction *mFindSelection;
+  QAction *mFindInTree;
 
   // View
   QAction *mRefresh;
@@ -94,6 +95,7 @@ private:
 
   // Repository
   QAction *mConfigureRepository;
+  QAction *mContributors;
   QAction *mStageAll;
   QAction *mUnstageAll;
   QAction *mCommit;
@@ -110,6 +112,7 @@ private:
   QAction *mPullFrom;
   QAction *mPush;
   QAction *mPushTo;
+  QAction *mPushAll;
 
   // Branch
   QAction *mConfigureBranches;
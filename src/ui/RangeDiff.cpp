@@ -0,0 +1,83 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "RangeDiff.h"
+#include "git/Tree.h"
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+namespace {
+
+// Number of range diffs kept for multi-selection.
+const int kCacheSize = 8;
+
+} // namespace
+
+RangeDiff::RangeDiff(QObject *parent) : QObject(parent), mCache(kCacheSize) {}
+
+QString RangeDiff::key(const git::Commit &first, const git::Commit &last,
+                       bool ignoreWhitespace) {
+  if (!first.isValid() || !last.isValid())
+    return QString();
+
+  QList<git::Commit> parents = first.parents();
+  if (!parents.isEmpty() && parents.first() == last)
+    return QString();
+
+  return QString("%1..%2:%3")
+      .arg(last.tree().id().toString(), first.tree().id().toString())
+      .arg(ignoreWhitespace);
+}
+
+git::Diff RangeDiff::cached(const QString &key) const {
+  git::Diff *diff = mCache.object(key);
+  return diff ? *diff : git::Diff();
+}
+
+git::Diff RangeDiff::diff(const git::Commit &first, const git::Commit &last,
+                          bool ignoreWhitespace) {
+  QString key = this->key(first, last, ignoreWhitespace);
+  if (git::Diff *diff = mCache.object(key))
+    return *diff;
+
+  git::Diff diff = compute(first, last, ignoreWhitespace);
+  if (!key.isEmpty())
+    mCache.insert(key, new git::Diff(diff));
+
+  return diff;
+}
+
+void RangeDiff::request(const git::Commit &first, const git::Commit &last,
+                        bool ignoreWhitespace) {
+  QString key = this->key(first, last, ignoreWhitespace);
+  int request = ++mRequest;
+
+  QFutureWatcher<git::Diff> *watcher = new QFutureWatcher<git::Diff>(this);
+  connect(watcher, &QFutureWatcher<git::Diff>::finished, this,
+          [this, watcher, key, request] {
+            git::Diff diff = watcher->result();
+            watcher->deleteLater();
+
+            if (!key.isEmpty())
+              mCache.insert(key, new git::Diff(diff));
+
+            if (request == mRequest)
+              emit finished(diff);
+          });
+
+  watcher->setFuture(
+      QtConcurrent::run(&RangeDiff::compute, first, last, ignoreWhitespace));
+}
+
+void RangeDiff::cancel() { ++mRequest; }
+
+git::Diff RangeDiff::compute(const git::Commit &first, const git::Commit &last,
+                             bool ignoreWhitespace) {
+  git::Diff diff = first.diff(last, -1, ignoreWhitespace);
+  diff.findSimilar();
+  return diff;
+}
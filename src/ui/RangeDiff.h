@@ -0,0 +1,57 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#ifndef RANGEDIFF_H
+#define RANGEDIFF_H
+
+#include "git/Commit.h"
+#include "git/Diff.h"
+#include <QCache>
+#include <QObject>
+
+// Diffs of commit ranges for multi-selection. They're computed with
+// rename detection on a worker thread and cached by old tree, new tree
+// and options. A commit and its first parent aren't a range. Their diff
+// is the commit's own diff and isn't computed here.
+class RangeDiff : public QObject {
+  Q_OBJECT
+
+public:
+  RangeDiff(QObject *parent = nullptr);
+
+  // Get the cache key of the range from last to first or an empty
+  // string if the range doesn't need its own diff.
+  static QString key(const git::Commit &first, const git::Commit &last,
+                     bool ignoreWhitespace);
+
+  // Get a cached diff or an invalid diff.
+  git::Diff cached(const QString &key) const;
+
+  // Compute the diff synchronously and cache it.
+  git::Diff diff(const git::Commit &first, const git::Commit &last,
+                 bool ignoreWhitespace);
+
+  // Compute the diff on a worker. Only the result of the latest request
+  // is reported. Results of earlier requests are still cached.
+  void request(const git::Commit &first, const git::Commit &last,
+               bool ignoreWhitespace);
+
+  // Forget the pending request.
+  void cancel();
+
+signals:
+  void finished(const git::Diff &diff);
+
+private:
+  static git::Diff compute(const git::Commit &first, const git::Commit &last,
+                           bool ignoreWhitespace);
+
+  QCache<QString, git::Diff> mCache;
+  int mRequest = 0;
+};
+
+#endif
@@ -9,25 +9,14 @@
 
 namespace {
 const QString kNowrapFmt = "<span style='white-space: nowrap'>%1</span>";
-
-bool refComparator(const git::Reference &lhs, const git::Reference &rhs) {
-  git::Commit lhsCommit = lhs.target();
-  git::Commit rhsCommit = rhs.target();
-  return (lhsCommit.isValid() && rhsCommit.isValid() &&
-          lhsCommit.committer().date() > rhsCommit.committer().date());
-}
 } // namespace
 
 ReferenceModel::ReferenceModel(const git::Repository &repo,
                                ReferenceView::Kinds kinds, QObject *parent)
     : QAbstractItemModel(parent), mRepo(repo), mKinds(kinds) {
   if (repo.isValid()) {
-    git::RepositoryNotifier *notifier = repo.notifier();
-    connect(notifier, &git::RepositoryNotifier::referenceAdded, this,
-            &ReferenceModel::update);
-    connect(notifier, &git::RepositoryNotifier::referenceRemoved, this,
-            &ReferenceModel::update);
-    connect(notifier, &git::RepositoryNotifier::referenceUpdated, this,
+    mCatalog = repo.referenceCatalog();
+    connect(mCatalog, &git::ReferenceCatalog::updated, this,
             &ReferenceModel::update);
   }
 }
@@ -71,84 +60,63 @@ void ReferenceModel::update() {
   beginResetModel();
 
   mRefs.clear();
+  mHead = mRepo.isValid() ? mRepo.head() : git::Reference();
 
   // Add detached head.
   git::Reference detachedHead;
   if (mKinds & ReferenceView::DetachedHead) {
-    git::Reference head = mRepo.head();
-    if (head.isValid() && !head.isBranch()) {
-      if (!mCommit.isValid() || head.annotatedCommit().commit() == mCommit) {
-        detachedHead = head;
+    if (mHead.isValid() && !mHead.isBranch()) {
+      if (!mCommit.isValid() || mHead.annotatedCommit().commit() == mCommit) {
+        detachedHead = mHead;
       }
     }
   }
 
   // Add local branches.
   if (mKinds & ReferenceView::LocalBranches) {
-    QList<git::Reference> branches;
-    foreach (const git::Branch &branch, mRepo.branches(GIT_BRANCH_LOCAL)) {
-      Debug("ReferenceView: Local branches: " << branch.name());
-      const bool branchOnCommit =
-          !mCommit.isValid() || branch.annotatedCommit().commit() == mCommit;
-      if ((!(mKinds & ReferenceView::ExcludeHead) || !branch.isHead()) &&
-          branchOnCommit)
-        branches.append(branch);
-    }
-
-    std::sort(branches.begin(), branches.end(), refComparator);
+    ReferenceList branches;
+    branches.name = tr("Branches");
+    branches.type = ReferenceType::Branches;
+    branches.kind = git::ReferenceCatalog::LocalBranch;
+    branches.entries = entries(branches.kind);
 
     // Add top references.
-    if (detachedHead.isValid())
-      branches.prepend(detachedHead);
     if (mKinds & ReferenceView::InvalidRef)
-      branches.prepend(git::Reference());
+      branches.top.append(git::Reference());
+    if (detachedHead.isValid())
+      branches.top.append(detachedHead);
 
     // Add bottom references.
-    const bool stashOnCommit =
-        !mCommit.isValid() ||
-        mRepo.stashRef().annotatedCommit().commit() == mCommit;
-    if ((mKinds & ReferenceView::Stash) && stashOnCommit) {
-      if (git::Reference stash = mRepo.stashRef())
-        branches.append(stash);
+    if (mKinds & ReferenceView::Stash) {
+      if (git::Reference stash = mRepo.stashRef()) {
+        if (!mCommit.isValid() || stash.annotatedCommit().commit() == mCommit)
+          branches.bottom.append(stash);
+      }
     }
 
-    mRefs.append({tr("Branches"), branches,
-                  ReferenceType::Branches}); // First element in mRefs
+    mRefs.append(branches); // First element in mRefs
   }
 
   // Add remote branches.
   if (mKinds & ReferenceView::RemoteBranches) {
-    QList<git::Reference> remotes;
-    foreach (const git::Branch &branch, mRepo.branches(GIT_BRANCH_REMOTE)) {
-      // Filter remote HEAD branches.
-      Debug("ReferenceView: Remote branches: " << branch.name());
-      const bool remoteOnCommit =
-          !mCommit.isValid() || branch.annotatedCommit().commit() == mCommit;
-      if (!branch.name().endsWith("HEAD") && remoteOnCommit)
-        remotes.append(branch);
-    }
-
-    std::sort(remotes.begin(), remotes.end(), refComparator);
+    ReferenceList remotes;
+    remotes.name = tr("Remotes");
+    remotes.type = ReferenceType::Remotes;
+    remotes.kind = git::ReferenceCatalog::RemoteBranch;
+    remotes.entries = entries(remotes.kind);
     if (mKinds & ReferenceView::InvalidRef)
-      remotes.prepend(git::Reference());
-    mRefs.append({tr("Remotes"), remotes,
-                  ReferenceType::Remotes}); // Second element in mRefs
+      remotes.top.append(git::Reference());
+    mRefs.append(remotes); // Second element in mRefs
   }
 
   // Add tags.
   if (mKinds & ReferenceView::Tags) {
-    QList<git::Reference> tags;
-    foreach (const git::TagRef &tag, mRepo.tags()) {
-      Debug("ReferenceView: Tags: " << tag.name());
-      const bool tagOnCommit =
-          !mCommit.isValid() || tag.annotatedCommit().commit() == mCommit;
-      if (tagOnCommit)
-        tags.append(tag);
-    }
-
-    std::sort(tags.begin(), tags.end(), refComparator);
-    mRefs.append(
-        {tr("Tags"), tags, ReferenceType::Tags}); // Third element in mRefs
+    ReferenceList tags;
+    tags.name = tr("Tags");
+    tags.type = ReferenceType::Tags;
+    tags.kind = git::ReferenceCatalog::Tag;
+    tags.entries = entries(tags.kind);
+    mRefs.append(tags); // Third element in mRefs
   }
 
   endResetModel();
@@ -157,9 +125,9 @@ void ReferenceModel::update() {
 QModelIndex ReferenceModel::firstRemote() {
   // Return first remote if available, otherwise an invalid modelIndex
   for (auto &ref : mRefs) {
-    if (ref.type == ReferenceType::Remotes && ref.refs.count() > 0) {
+    if (ref.type == ReferenceType::Remotes && ref.count() > 0) {
       if (mKinds & ReferenceView::InvalidRef) {
-        if (ref.refs.count() > 1) {
+        if (ref.count() > 1) {
           // use the first valid ref after the invalid ref
           return createIndex(1, 0, ReferenceType::Remotes);
         }
@@ -175,15 +143,13 @@ QModelIndex ReferenceModel::firstBranch() {
   // Return first branch if available, otherwise an invalid modelIndex
   // Ignore stash
   for (auto &ref : mRefs) {
-    if (ref.type == ReferenceType::Branches && ref.refs.count() > 0) {
+    if (ref.type == ReferenceType::Branches && ref.count() > 0) {
       if (mKinds & ReferenceView::InvalidRef) {
         // use the first valid ref after the invalid ref but only
         // it is not the stash
-        if (ref.refs.count() > 1 &&
-            ref.refs.at(1).annotatedCommit().commit() !=
-                mRepo.stashRef().annotatedCommit().commit())
+        if (ref.count() > 1 && !reference(ref, 1).isStash())
           return createIndex(1, 0, ReferenceType::Branches);
-      } else if (ref.refs.count() > 0)
+      } else if (ref.count() > 0)
         return createIndex(0, 0, ReferenceType::Branches);
       break; // Remotes are already found so no need to continue searching
     }
@@ -195,7 +161,7 @@ QModelIndex ReferenceModel::firstTag() {
   // Return first tag if available, otherwise an invalid modelIndex
 
   for (auto &ref : mRefs) {
-    if (ref.type == ReferenceType::Tags && ref.refs.count() > 0)
+    if (ref.type == ReferenceType::Tags && ref.count() > 0)
       return createIndex(0, 0, ReferenceType::Tags);
   }
   return QModelIndex();
@@ -232,7 +198,7 @@ int ReferenceModel::rowCount(const QModelIndex &parent) const {
   if (parent.internalId() != COMBOBOX_HEADER)
     return 0; // refs it self do not have childs
 
-  return mRefs.at(parent.row()).refs.size();
+  return mRefs.at(parent.row()).count();
 }
 
 int ReferenceModel::columnCount(const QModelIndex &parent) const { return 1; }
@@ -247,13 +213,17 @@ QVariant ReferenceModel::data(const QModelIndex &index, int role) const {
   auto refType = static_cast<ReferenceType>(id);
 
   // refs
-  git::Reference ref = mRefs.at(referenceTypeToIndex(refType)).refs.at(row);
+  const ReferenceList &list = mRefs.at(referenceTypeToIndex(refType));
   switch (role) {
     case Qt::DisplayRole:
-      return ref.isValid() ? ref.name() : QString();
+      return name(list, row);
 
     case Qt::ToolTipRole: {
-      if (!ref.isValid() || !ref.isTag())
+      if (refType != ReferenceType::Tags)
+        return QVariant();
+
+      git::Reference ref = reference(list, row);
+      if (!ref.isValid())
         return QVariant();
 
       git::Tag tag = git::TagRef(ref).tag();
@@ -280,12 +250,12 @@ QVariant ReferenceModel::data(const QModelIndex &index, int role) const {
 
     case Qt::FontRole: {
       QFont font = static_cast<QWidget *>(QObject::parent())->font();
-      font.setBold(ref.isValid() && ref.isHead());
+      font.setBold(isHead(list, row));
       return font;
     }
 
     case Qt::UserRole:
-      return QVariant::fromValue(ref);
+      return QVariant::fromValue(reference(list, row));
 
     default:
       return QVariant();
@@ -296,3 +266,77 @@ QVariant ReferenceModel::headerData(int section, Qt::Orientation orientation,
                                     int role) const {
   return QVariant();
 }
+
+QVector<int> ReferenceModel::entries(git::ReferenceCatalog::Kind kind) const {
+  QVector<int> rows;
+  if (!mCatalog)
+    return rows;
+
+  QString head;
+  if (kind == git::ReferenceCatalog::LocalBranch &&
+      (mKinds & ReferenceView::ExcludeHead) && mHead.isLocalBranch())
+    head = mHead.name();
+
+  git::Id commit = mCommit.isValid() ? mCommit.id() : git::Id();
+  const git::ReferenceCatalog::Entries &entries = mCatalog->entries(kind);
+  for (int i = 0; i < entries.size(); ++i) {
+    const git::ReferenceCatalog::Entry &entry = entries.at(i);
+    if (mCommit.isValid() && !(entry.target == commit))
+      continue;
+
+    // Filter remote HEAD branches.
+    if (kind == git::ReferenceCatalog::RemoteBranch &&
+        entry.name.endsWith("HEAD"))
+      continue;
+
+    if (!head.isEmpty() && entry.name == head)
+      continue;
+
+    rows.append(i);
+  }
+
+  return rows;
+}
+
+QString ReferenceModel::name(const ReferenceList &list, int row) const {
+  if (row < list.top.size()) {
+    git::Reference ref = list.top.at(row);
+    return ref.isValid() ? ref.name() : QString();
+  }
+
+  row -= list.top.size();
+  if (row < list.entries.size())
+    return mCatalog->entries(list.kind).value(list.entries.at(row)).name;
+
+  git::Reference ref = list.bottom.value(row - list.entries.size());
+  return ref.isValid() ? ref.name() : QString();
+}
+
+git::Reference ReferenceModel::reference(const ReferenceList &list,
+                                         int row) const {
+  if (row < list.top.size())
+    return list.top.at(row);
+
+  row -= list.top.size();
+  if (row < list.entries.size()) {
+    QString name = this->name(list, row + list.top.size());
+    return mRepo.lookupRef(
+        git::ReferenceCatalog::qualifiedName(list.kind, name));
+  }
+
+  return list.bottom.value(row - list.entries.size());
+}
+
+bool ReferenceModel::isHead(const ReferenceList &list, int row) const {
+  if (!mHead.isValid())
+    return false;
+
+  // Compare catalog entries by name to avoid looking them up.
+  int index = row - list.top.size();
+  if (index >= 0 && index < list.entries.size())
+    return (list.kind == git::ReferenceCatalog::LocalBranch &&
+            mHead.isLocalBranch() && name(list, row) == mHead.name());
+
+  git::Reference ref = reference(list, row);
+  return (ref.isValid() && ref.isHead());
+}
@@ -14,6 +14,7 @@
 #include <QAbstractItemModel>
 #include "ReferenceView.h"
 #include "git/Reference.h"
+#include "git/ReferenceCatalog.h"
 
 class ReferenceModel : public QAbstractItemModel {
   Q_OBJECT
@@ -26,10 +27,18 @@ public:
     Tags = 3
   };
 
+  // The rows of a list are the references at the top, followed by the
+  // catalog entries at the given indexes, followed by the references at
+  // the bottom. Catalog entries are only looked up when they're needed.
   struct ReferenceList {
     QString name;
-    QList<git::Reference> refs;
     ReferenceType type;
+    git::ReferenceCatalog::Kind kind;
+    QList<git::Reference> top;
+    QVector<int> entries;
+    QList<git::Reference> bottom;
+
+    int count() const { return top.size() + entries.size() + bottom.size(); }
   };
 
   ReferenceModel(const git::Repository &repo, ReferenceView::Kinds kinds,
@@ -52,10 +61,18 @@ public:
                       int role = Qt::DisplayRole) const override;
 
 private:
+  QVector<int> entries(git::ReferenceCatalog::Kind kind) const;
+
+  QString name(const ReferenceList &list, int row) const;
+  git::Reference reference(const ReferenceList &list, int row) const;
+  bool isHead(const ReferenceList &list, int row) const;
+
   git::Repository mRepo;
+  git::ReferenceCatalog *mCatalog = nullptr;
   ReferenceView::Kinds mKinds;
   QList<ReferenceList> mRefs;
   git::Commit mCommit;
+  git::Reference mHead;
 };
 
 #endif // REFERENCEMODEL_H
@@ -18,7 +18,9 @@
 #include "git/TagRef.h"
 #include "log/LogEntry.h"
 #include <QAbstractItemModel>
+#include <QBitArray>
 #include <QDateTime>
+#include <QHash>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QKeyEvent>
@@ -37,19 +39,49 @@ const int kHeight = 200;
 
 class FilterProxyModel : public QSortFilterProxyModel {
 public:
-  FilterProxyModel(QObject *parent = nullptr) : QSortFilterProxyModel(parent) {}
+  FilterProxyModel(QObject *parent = nullptr) : QSortFilterProxyModel(parent) {
+    connect(this, &QAbstractItemModel::modelAboutToBeReset, [this] {
+      mPrevious.clear();
+      mMatches.clear();
+    });
+  }
 
   void setFilter(const QString &filter) {
-    setFilterRegExp(QRegExp(filter, Qt::CaseInsensitive, QRegExp::FixedString));
+    // A filter that contains the previous filter can only match rows
+    // that matched before, so the others don't have to be checked again.
+    mPrevious.clear();
+    if (!mFilter.isEmpty() && filter.contains(mFilter, Qt::CaseInsensitive))
+      mPrevious = mMatches;
+
+    mMatches.clear();
+    mFilter = filter;
+    invalidateFilter();
   }
 
 protected:
   bool filterAcceptsRow(int row, const QModelIndex &parent) const override {
-    if (!parent.isValid())
+    if (!parent.isValid() || mFilter.isEmpty())
       return true;
 
-    return QSortFilterProxyModel::filterAcceptsRow(row, parent);
+    int section = parent.row();
+    auto it = mPrevious.constFind(section);
+    if (it != mPrevious.constEnd() && row < it->size() && !it->testBit(row))
+      return false;
+
+    QModelIndex index = sourceModel()->index(row, 0, parent);
+    bool match = index.data().toString().contains(mFilter, Qt::CaseInsensitive);
+
+    QBitArray &matches = mMatches[section];
+    if (matches.size() <= row)
+      matches.resize(sourceModel()->rowCount(parent));
+    matches.setBit(row, match);
+    return match;
   }
+
+private:
+  QString mFilter;
+  QHash<int, QBitArray> mPrevious;
+  mutable QHash<int, QBitArray> mMatches;
 };
 
 class Delegate : public QStyledItemDelegate {
@@ -288,6 +320,9 @@ void ReferenceView::contextMenuEvent(QContextMenuEvent *event) {
   RepoView *view = RepoView::parentView(this);
   checkout->setEnabled(!ref.isHead() && !view->repo().isBare());
 
+  if (!ref.isStash())
+    menu.addAction(tr("Show Reflog"), [view, ref] { view->showReflog(ref); });
+
   menu.addSeparator();
 
   if (ref.isLocalBranch()) {
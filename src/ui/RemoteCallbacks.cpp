@@ -191,11 +191,17 @@ void RemoteCallbacks::rejected(const QString &name, const QString &status) {
 }
 
 void RemoteCallbacks::add(int total, int current) {
-  emit queueAdd(total, current);
+  if (current == 0 || current == total || mTimer.elapsed() > 100) {
+    emit queueAdd(total, current);
+    mTimer.restart();
+  }
 }
 
 void RemoteCallbacks::delta(int total, int current) {
-  emit queueDelta(total, current);
+  if (current == 0 || current == total || mTimer.elapsed() > 100) {
+    emit queueDelta(total, current);
+    mTimer.restart();
+  }
 }
 
 bool RemoteCallbacks::negotiation(
@@ -0,0 +1,99 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+// Author: Jason Haslam
+//
+
+#include "RepoState.h"
+#include "git/Branch.h"
+#include "git/Submodule.h"
+#include <QFileInfo>
+#include <QtConcurrent>
+
+RepoState::RepoState(const git::Repository &repo, QObject *parent)
+    : QObject(parent), mRepo(repo) {
+  mSnapshot.bare = repo.isBare();
+
+  connect(&mWatcher, &QFutureWatcher<Snapshot>::finished, this, [this] {
+    mSnapshot = mWatcher.result();
+    emit changed();
+
+    if (mPending) {
+      mPending = false;
+      invalidate();
+    }
+  });
+
+  // Upstreams and LFS filters are read from the config. The files are
+  // replaced on write, so the watch has to be renewed. LFS also adds
+  // hooks, which the workdir watcher doesn't see.
+  QStringList paths = {repo.dir().filePath("config"),
+                       repo.appDir().filePath("config"),
+                       repo.dir().filePath("hooks")};
+  foreach (const QString &path, paths) {
+    if (QFileInfo::exists(path))
+      mFileWatcher.addPath(path);
+  }
+
+  connect(&mFileWatcher, &QFileSystemWatcher::fileChanged, this,
+          [this](const QString &path) {
+            if (QFileInfo::exists(path) &&
+                !mFileWatcher.files().contains(path))
+              mFileWatcher.addPath(path);
+            invalidate();
+          });
+  connect(&mFileWatcher, &QFileSystemWatcher::directoryChanged, this,
+          &RepoState::invalidate);
+
+  // Attributes decide which files go through LFS.
+  connect(repo.notifier(), &git::RepositoryNotifier::workdirChanged, this,
+          &RepoState::invalidate);
+
+  invalidate();
+}
+
+void RepoState::invalidate() {
+  if (mWatcher.isRunning()) {
+    mPending = true;
+    return;
+  }
+
+  // The worker opens its own repository. The shared one caches
+  // submodules and isn't safe to use from more than one thread.
+  QString path = mRepo.dir().path();
+  Snapshot current = mSnapshot;
+  mWatcher.setFuture(QtConcurrent::run([path, current] {
+    git::Repository repo = git::Repository::open(path);
+    return repo.isValid() ? build(repo) : current;
+  }));
+}
+
+RepoState::Snapshot RepoState::build(git::Repository repo) {
+  Snapshot snapshot;
+  snapshot.bare = repo.isBare();
+  snapshot.lfs = repo.lfsIsInitialized();
+  snapshot.state = repo.state();
+
+  git::Reference head = repo.head();
+  snapshot.headValid = head.isValid();
+  snapshot.headName = head.isValid() ? head.name() : repo.unbornHeadName();
+  snapshot.headQualifiedName = head.isValid() ? head.qualifiedName() : QString();
+
+  if (git::Branch branch = head) {
+    snapshot.headIsBranch = true;
+    if (git::Branch upstream = branch.upstream()) {
+      snapshot.upstreamName = upstream.name();
+      snapshot.ahead = branch.difference(upstream);
+      snapshot.behind = upstream.difference(branch);
+    }
+  }
+
+  if (repo.stashRef().isValid())
+    snapshot.stashCount = repo.stashCount();
+  snapshot.submoduleCount = repo.submodules().count();
+
+  return snapshot;
+}
@@ -0,0 +1,70 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+// Author: Jason Haslam
+//
+
+#ifndef REPOSTATE_H
+#define REPOSTATE_H
+
+#include "git/Repository.h"
+#include "git2/repository.h"
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QObject>
+
+// Summary of the repository that's shown in the window chrome. It's
+// rebuilt on a worker thread once per change notification so that the
+// menu bar, tool bar and window title can read it without calling git.
+// The first snapshot is also built on a worker. Until it's ready, only
+// the bare flag is filled in. Changes to the config files, hooks and
+// working directory are watched.
+class RepoState : public QObject {
+  Q_OBJECT
+
+public:
+  struct Snapshot {
+    bool bare = false;
+    bool lfs = false;
+    int state = GIT_REPOSITORY_STATE_NONE;
+
+    bool headValid = false;
+    bool headIsBranch = false;
+    QString headName;
+    QString headQualifiedName;
+
+    QString upstreamName;
+    int ahead = 0;
+    int behind = 0;
+
+    int stashCount = 0;
+    int submoduleCount = 0;
+  };
+
+  RepoState(const git::Repository &repo, QObject *parent = nullptr);
+
+  const Snapshot &snapshot() const { return mSnapshot; }
+
+  // Schedule a rebuild. Requests that arrive while a rebuild
+  // is running are coalesced into a single extra pass.
+  void invalidate();
+
+  static Snapshot build(git::Repository repo);
+
+signals:
+  void changed();
+
+private:
+  git::Repository mRepo;
+  Snapshot mSnapshot;
+
+  QFutureWatcher<Snapshot> mWatcher;
+  bool mPending = false;
+
+  QFileSystemWatcher mFileWatcher;
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include "qtsupport.h"
 #include "ReferenceWidget.h"
 #include "RemoteCallbacks.h"
+#include "RepoState.h"
 #include "SearchField.h"
 #include "DoubleTreeWidget.h"
 #include "ToolBar.h"
@@ -49,7 +50,11 @@
 #include "git2/merge.h"
 #include "host/Accounts.h"
 #include "index/Index.h"
+#include "index/IndexService.h"
+#include "index/Statistics.h"
+#include "index/TrigramIndex.h"
 #include "log/LogEntry.h"
+#include "log/LogModel.h"
 #include "log/LogView.h"
 #include "tools/ShowTool.h"
 #include "watcher/RepositoryWatcher.h"
@@ -66,6 +71,7 @@
 #include <QUrlQuery>
 #include <QVBoxLayout>
 #include <QtConcurrent>
+#include <atomic>
 
 #if defined(Q_OS_WIN)
 #include <Windows.h>
@@ -92,6 +98,8 @@ public:
     // Connect with automatic type.
     connect(this, &CheckoutCallbacks::queueNotify, this,
             &CheckoutCallbacks::notifyImpl);
+    connect(this, &CheckoutCallbacks::queueProgress, this,
+            &CheckoutCallbacks::progressImpl);
   }
 
   QStringList conflicts() const { return mConflicts; }
@@ -104,6 +112,15 @@ public:
   }
 
   void progress(const QString &path, int current, int total) override {
+    emit queueProgress(path, current, total);
+  }
+
+signals:
+  void queueNotify(char status, const QString &path);
+  void queueProgress(const QString &path, int current, int total);
+
+private:
+  void progressImpl(const QString &path, int current, int total) {
     Q_UNUSED(path)
 
     // Add entries all at once.
@@ -111,10 +128,6 @@ public:
       mLog->addEntries(mEntries);
   }
 
-signals:
-  void queueNotify(char status, const QString &path);
-
-private:
   void notifyImpl(char status, const QString &path) {
     LogEntry *entry = new LogEntry(LogEntry::File, path, QString());
     entry->setStatus(status);
@@ -145,6 +158,15 @@ private:
 
 } // namespace
 
+class RebaseCallbacks : public git::Repository::RebaseCallbacks {
+public:
+  bool isCanceled() const override { return mCanceled; }
+  void setCanceled(bool canceled) { mCanceled = canceled; }
+
+private:
+  std::atomic<bool> mCanceled{false};
+};
+
 RepoView::RepoView(const git::Repository &repo, MainWindow *parent)
     : QSplitter(Qt::Vertical, parent), mRepo(repo) {
   setHandleWidth(0);
@@ -155,10 +177,20 @@ RepoView::RepoView(const git::Repository &repo, MainWindow *parent)
   connect(notifier, &git::RepositoryNotifier::referenceUpdated, this,
           &RepoView::startIndexing);
 
+  // Rebuild the state shown in the window chrome after any change.
+  mState = new RepoState(repo, this);
+  connect(notifier, &git::RepositoryNotifier::referenceUpdated, mState,
+          &RepoState::invalidate);
+  connect(notifier, &git::RepositoryNotifier::stateChanged, mState,
+          &RepoState::invalidate);
+
   MenuBar *menuBar = MenuBar::instance(parent);
   connect(this, &RepoView::statusChanged, menuBar, &MenuBar::updateStash);
-  connect(notifier, &git::RepositoryNotifier::stateChanged, menuBar,
-          &MenuBar::updateBranch);
+  connect(mState, &RepoState::changed, menuBar, &MenuBar::updateBranch);
+  connect(mState, &RepoState::changed, menuBar, &MenuBar::updateStash);
+  connect(mState, &RepoState::changed, menuBar, &MenuBar::updateSubmodules);
+  connect(mState, &RepoState::changed, menuBar, &MenuBar::updateRepository);
+  connect(mState, &RepoState::changed, menuBar, &MenuBar::updateRemote);
   connect(notifier, &git::RepositoryNotifier::rebaseInitError, this,
           &RepoView::rebaseInitError);
   connect(notifier, &git::RepositoryNotifier::rebaseAboutToRebase, this,
@@ -171,42 +203,41 @@ RepoView::RepoView(const git::Repository &repo, MainWindow *parent)
           &RepoView::rebaseCommitSuccess);
   connect(notifier, &git::RepositoryNotifier::rebaseConflict, this,
           &RepoView::rebaseConflict);
+  connect(notifier, &git::RepositoryNotifier::rebaseCanceled, this,
+          &RepoView::rebaseCanceled);
 
   ToolBar *toolBar = parent->toolBar();
   connect(this, &RepoView::statusChanged, toolBar, &ToolBar::updateStash);
+  connect(mState, &RepoState::changed, toolBar, &ToolBar::updateStash);
 
   // Initialize index.
   mIndex = new Index(repo, this);
   SearchField *searchField = toolBar->searchField();
-  connect(&mIndexer, &QProcess::started, this, [searchField] {
-    searchField->setPlaceholderText(tr("Indexing..."));
-  });
-  using Signal = void (QProcess::*)(int, QProcess::ExitStatus);
-  auto signal = static_cast<Signal>(&QProcess::finished);
-  connect(&mIndexer, signal, this,
-          [this, searchField](int code, QProcess::ExitStatus status) {
-            Q_UNUSED(code)
-
-            searchField->setPlaceholderText(tr("Search"));
-            if (status == QProcess::CrashExit) {
-              QString text =
-                  tr("The indexer worker process crashed. If this problem "
-                     "persists please contact us at <TODO: "
-                     "replace.support@gitahead.com>.");
-              addLogEntry(text, tr("Indexer Crashed"));
-            }
-
-            if (mRestartIndexer) {
-              mRestartIndexer = false;
-              startIndexing();
-            }
+  IndexService *service = IndexService::instance();
+  connect(service, &IndexService::started, this,
+          [this, searchField](const QString &path) {
+            if (path == mRepo.dir().path())
+              searchField->setPlaceholderText(tr("Indexing..."));
           });
+  connect(service, &IndexService::finished, this,
+          [this, searchField](const QString &path) {
+            if (path == mRepo.dir().path())
+              searchField->setPlaceholderText(tr("Search"));
+          });
+  connect(service, &IndexService::crashed, this, [this](const QString &path) {
+    if (path != mRepo.dir().path())
+      return;
 
-  // Forward indexer stderr. Read from stdout.
-  mIndexer.setProcessChannelMode(QProcess::ForwardedErrorChannel);
-  connect(&mIndexer, &QProcess::readyReadStandardOutput, this, [this] {
-    mIndexer.readAllStandardOutput();
-    mIndex->reset();
+    QString text = tr("The indexer worker process crashed. If this problem "
+                      "persists please contact us at <TODO: "
+                      "replace.support@gitahead.com>.");
+    addLogEntry(text, tr("Indexer Crashed"));
+  });
+
+  // Reload when the indexer writes to disk.
+  connect(service, &IndexService::written, this, [this](const QString &path) {
+    if (path == mRepo.dir().path())
+      mIndex->reload();
   });
 
   // Initialize history.
@@ -400,6 +431,13 @@ RepoView::RepoView(const git::Repository &repo, MainWindow *parent)
   connect(mLogView, &LogView::linkActivated, this, &RepoView::visitLink);
   connect(mLogView, &LogView::operationCanceled, this,
           &RepoView::cancelRemoteTransfer);
+  connect(mLogView, &LogView::operationCanceled, this,
+          [this](const QModelIndex &index) {
+            // Only the rebase's own entry cancels it.
+            QVariant entry = index.data(LogModel::EntryRole);
+            if (mRebaseWatcher && entry.value<LogEntry *>() == mRebase)
+              cancelRebase();
+          });
 
   mLogTimer.setSingleShot(true);
   connect(&mLogTimer, &QTimer::timeout, this, [this] { setLogVisible(false); });
@@ -491,15 +529,21 @@ void RepoView::selectFirstCommit() { mCommits->selectFirstCommit(); }
 
 void RepoView::commit(bool force) { mDetails->commit(force); }
 
-bool RepoView::isCommitEnabled() const { return mDetails->isCommitEnabled(); }
+bool RepoView::isCommitEnabled() const {
+  return !mCheckoutWatcher && mDetails->isCommitEnabled();
+}
 
 void RepoView::stage() { mDetails->stage(); }
 
-bool RepoView::isStageEnabled() const { return mDetails->isStageEnabled(); }
+bool RepoView::isStageEnabled() const {
+  return !mCheckoutWatcher && mDetails->isStageEnabled();
+}
 
 void RepoView::unstage() { mDetails->unstage(); }
 
-bool RepoView::isUnstageEnabled() const { return mDetails->isUnstageEnabled(); }
+bool RepoView::isUnstageEnabled() const {
+  return !mCheckoutWatcher && mDetails->isUnstageEnabled();
+}
 
 RepoView::ViewMode RepoView::viewMode() const { return mDetails->viewMode(); }
 
@@ -526,6 +570,10 @@ void RepoView::selectReference(const git::Reference &ref) {
   mRefs->select(ref);
 }
 
+void RepoView::showReflog(const git::Reference &ref) {
+  mCommits->setReflog(ref);
+}
+
 QList<git::Commit> RepoView::commits() const {
   return mCommits->selectedCommits();
 }
@@ -542,18 +590,30 @@ git::Tree RepoView::tree() const {
 }
 
 void RepoView::cancelRemoteTransfer() {
-  if (!mCallbacks)
-    return;
+  foreach (RemoteCallbacks *callbacks, mPushAllWatchers)
+    callbacks->setCanceled(true);
+
+  if (mCallbacks)
+    mCallbacks->setCanceled(true);
 
-  mCallbacks->setCanceled(true);
   QCoreApplication::processEvents();
   if (mWatcher && mWatcher->isRunning())
     mWatcher->waitForFinished();
+
+  foreach (QFutureWatcher<git::Result> *watcher, mPushAllWatchers.keys()) {
+    if (watcher->isRunning())
+      watcher->waitForFinished();
+  }
 }
 
 void RepoView::cancelBackgroundTasks() {
   cancelIndexing();
   cancelRemoteTransfer();
+  cancelRebase();
+  if (mRebaseWatcher && mRebaseWatcher->isRunning())
+    mRebaseWatcher->waitForFinished();
+  if (mCheckoutWatcher && mCheckoutWatcher->isRunning())
+    mCheckoutWatcher->waitForFinished();
   mCommits->cancelStatus();
   mDetails->cancelBackgroundTasks();
 }
@@ -759,7 +819,9 @@ Repository *RepoView::remoteRepo() {
 
 void RepoView::lfsInitialize() {
   LogEntry *entry = addLogEntry(tr("Git LFS"), tr("Initialize"));
-  if (!mRepo.lfsInitialize()) {
+  bool initialized = mRepo.lfsInitialize();
+  mState->invalidate();
+  if (!initialized) {
     error(entry, tr("initialize"));
     return;
   }
@@ -769,7 +831,9 @@ void RepoView::lfsInitialize() {
 
 void RepoView::lfsDeinitialize() {
   LogEntry *entry = addLogEntry(tr("Git LFS"), tr("Deinitialize"));
-  if (!mRepo.lfsDeinitialize()) {
+  bool deinitialized = mRepo.lfsDeinitialize();
+  mState->invalidate();
+  if (!deinitialized) {
     error(entry, tr("deinitialize"));
     return;
   }
@@ -830,42 +894,28 @@ void RepoView::startIndexing() {
   if (!mRepo.appConfig().value<bool>("index.enable", true))
     return;
 
-  if (mIndexer.state() != QProcess::NotRunning) {
-    mRestartIndexer = true;
-    return;
-  }
+  // Index the content at HEAD in process. It follows HEAD by itself.
+  if (!mTrigramIndex)
+    mTrigramIndex = new TrigramIndex(mRepo, this);
+  mTrigramIndex->update();
 
-  QStringList args = {"--notify", "--background", mRepo.dir().path()};
-  if (Index::isLoggingEnabled())
-    args.prepend("--log");
-
-  QDir dir(QCoreApplication::applicationDirPath());
-#ifdef WIN32
-  auto indexer_cmd = dir.filePath("indexer.exe");
-#else
-  auto indexer_cmd = dir.filePath("indexer");
-#endif
-  QFileInfo check_file(indexer_cmd);
-  if (!check_file.isFile()) {
-    Debug("No indexer found: " << indexer_cmd);
-  }
-  mIndexer.start(indexer_cmd, args);
+  // The shared indexer picks up new commits if it's already running.
+  IndexService::instance()->start(mRepo);
 }
 
-void RepoView::cancelIndexing() {
-  if (mIndexer.state() == QProcess::NotRunning)
-    return;
-
-  mIndexer.terminate();
-  mIndexer.waitForFinished(5000);
-
-  if (mIndexer.state() == QProcess::NotRunning)
-    return;
+Statistics *RepoView::statistics() {
+  // Build on first use. Stored totals are read back and only commits that
+  // were added since are counted. Statistics follow new commits after.
+  if (!mStatistics) {
+    mStatistics = new Statistics(mRepo, this);
+    mStatistics->update();
+  }
 
-  mIndexer.kill();
-  mIndexer.waitForFinished(5000);
+  return mStatistics;
 }
 
+void RepoView::cancelIndexing() { IndexService::instance()->cancel(mRepo); }
+
 bool RepoView::isLogVisible() const { return mIsLogVisible; }
 
 void RepoView::setLogVisible(bool visible) {
@@ -1144,6 +1194,11 @@ void RepoView::pull(MergeFlags flags, const git::Remote &rmt, bool tags,
 void RepoView::merge(MergeFlags flags, const git::Reference &ref,
                      const git::AnnotatedCommit &commit, LogEntry *parent,
                      const std::function<void()> &callback) {
+  if (queueAfterCheckout([this, flags, ref, commit, parent, callback] {
+        merge(flags, ref, commit, parent, callback);
+      }))
+    return;
+
   DebugRefresh("");
   git::Reference head = mRepo.head();
 
@@ -1240,10 +1295,35 @@ void RepoView::fastForward(const git::Reference &ref,
   Q_ASSERT(head.isValid());
 
   git::Commit commit = upstream.commit();
-  CheckoutCallbacks callbacks(parent, GIT_CHECKOUT_NOTIFY_UPDATED);
-  if (!mRepo.checkout(commit, &callbacks)) {
+  CheckoutCallbacks *callbacks =
+      new CheckoutCallbacks(parent, GIT_CHECKOUT_NOTIFY_UPDATED, this);
+
+  auto finish = [this, ref, head, commit, parent, callbacks,
+                 callback](bool checkedOut) {
+    callbacks->deleteLater();
+    fastForwardFinished(ref, head, commit, parent, callback, checkedOut,
+                        callbacks->conflicts());
+  };
+
+  // Write large fast-forwards in the background.
+  git::Diff diff = mRepo.checkoutDiff(commit);
+  if (!git::Repository::isParallelCheckout(diff)) {
+    finish(mRepo.checkout(commit, callbacks));
+    return;
+  }
+
+  checkoutParallel(commit, diff, callbacks, GIT_CHECKOUT_SAFE, parent, finish);
+}
+
+void RepoView::fastForwardFinished(const git::Reference &ref,
+                                   const git::Reference &head,
+                                   const git::Commit &commit, LogEntry *parent,
+                                   const std::function<void()> &callback,
+                                   bool checkedOut,
+                                   const QStringList &conflicts) {
+  if (!checkedOut) {
     LogEntry *err = error(parent, tr("fast-forward"), head.name());
-    foreach (const QString &path, callbacks.conflicts())
+    foreach (const QString &path, conflicts)
       err->addEntry(LogEntry::File, path)->setStatus('!');
 
     QUrlQuery query;
@@ -1427,9 +1507,57 @@ void RepoView::rebase(const git::AnnotatedCommit &upstream, LogEntry *parent) {
     return;
   }
 
+  if (mRebaseWatcher) {
+    addLogEntry(tr("A rebase is already running."), tr("Abort"), parent);
+    return;
+  }
+
   mRebase = parent;
 
-  mRepo.rebase(upstream, mDetails->overrideUser(), mDetails->overrideEmail());
+  QString user = mDetails->overrideUser();
+  QString email = mDetails->overrideEmail();
+  Settings *settings = Settings::instance();
+  if (!settings->value(Setting::Id::RebaseInMemory).toBool()) {
+    mRepo.rebase(upstream, user, email);
+    return;
+  }
+
+  // Replay in memory on a worker. Progress arrives through the queued
+  // notifier signals and the workdir is written only once at the end.
+  mRebaseCallbacks = new RebaseCallbacks;
+  mRebaseWatcher = new QFutureWatcher<void>(this);
+  connect(mRebaseWatcher, &QFutureWatcher<void>::finished, mRebaseWatcher,
+          [this, parent] {
+            if (parent)
+              parent->setBusy(false);
+
+            delete mRebaseCallbacks;
+            mRebaseCallbacks = nullptr;
+
+            mRebaseWatcher->deleteLater();
+            mRebaseWatcher = nullptr;
+
+            refresh(false);
+          });
+
+  if (parent)
+    parent->setBusy(true);
+
+  git::Repository repo = mRepo;
+  RebaseCallbacks *callbacks = mRebaseCallbacks;
+  mRebaseWatcher->setFuture(
+      QtConcurrent::run([repo, upstream, callbacks, user, email] {
+        git::Repository(repo).rebaseInMemory(upstream, callbacks, user, email);
+      }));
+}
+
+void RepoView::cancelRebase() {
+  if (!mRebaseCallbacks)
+    return;
+
+  // The worker stops before the next operation and
+  // reports through the queued canceled signal.
+  mRebaseCallbacks->setCanceled(true);
 }
 
 void RepoView::rebaseInitError() {
@@ -1455,9 +1583,10 @@ void RepoView::rebaseCommitInvalid(const git::Rebase rebase) {
 }
 
 void RepoView::rebaseAboutToRebase(const git::Rebase rebase,
-                                   const git::Commit before, int currIndex) {
+                                   const git::Commit before, int currIndex,
+                                   int total) {
   QString beforeText = before.link();
-  QString step = tr("%1/%2").arg(currIndex).arg(rebase.count());
+  QString step = tr("%1/%2").arg(currIndex).arg(total);
   QString text = tr("%1 - %2").arg(step, beforeText);
   mRebase->addEntry(text, tr("Apply"));
 }
@@ -1475,9 +1604,10 @@ void RepoView::rebaseConflict(const git::Rebase rebase) {
 
 void RepoView::rebaseCommitSuccess(const git::Rebase rebase,
                                    const git::Commit before,
-                                   const git::Commit after, int currIndex) {
+                                   const git::Commit after, int currIndex,
+                                   int total) {
   QString beforeText = before.link();
-  QString step = tr("%1/%2").arg(currIndex).arg(rebase.count());
+  QString step = tr("%1/%2").arg(currIndex).arg(total);
   auto *lastEntry = mRebase->lastEntry();
   if (lastEntry) {
     lastEntry->setText(
@@ -1493,6 +1623,12 @@ void RepoView::rebaseCommitSuccess(const git::Rebase rebase,
   QCoreApplication::processEvents();
 }
 
+void RepoView::rebaseCanceled(const git::Rebase rebase) {
+  if (mRebase)
+    mRebase->addEntry(LogEntry::Error, tr("Rebase canceled."));
+  mRebase = nullptr;
+}
+
 void RepoView::rebaseFinished(const git::Rebase rebase) {
   QString text = tr("Rebase finished");
   mRebase->addEntry(text, tr("Rebase"));
@@ -1529,7 +1665,8 @@ void RepoView::squash(const git::AnnotatedCommit &upstream, LogEntry *parent) {
 }
 
 void RepoView::revert(const git::Commit &commit) {
-  if (!commit.isValid())
+  if (!commit.isValid() ||
+      queueAfterCheckout([this, commit] { revert(commit); }))
     return;
 
   QString link = commit.link();
@@ -1576,7 +1713,8 @@ void RepoView::revert(const git::Commit &commit) {
 }
 
 void RepoView::cherryPick(const git::Commit &commit) {
-  if (!commit.isValid())
+  if (!commit.isValid() ||
+      queueAfterCheckout([this, commit] { cherryPick(commit); }))
     return;
 
   QString link = commit.link();
@@ -1810,6 +1948,70 @@ void RepoView::push(const git::Remote &rmt, const git::Reference &src,
                                         ref, dst, force, tags));
 }
 
+void RepoView::pushAll(bool force) {
+  if (mWatcher) {
+    // Queue push.
+    connect(mWatcher, &QFutureWatcher<git::Result>::finished, mWatcher,
+            [this, force] { pushAll(force); });
+    return;
+  }
+
+  // Fall back to a single push to report errors.
+  git::Reference ref = mRepo.head();
+  QList<git::Remote> remotes = mRepo.remotes();
+  if (!ref.isValid() || remotes.isEmpty()) {
+    push(git::Remote(), git::Reference(), QString(), false, force);
+    return;
+  }
+
+  QString title = !force ? tr("Push") : tr("Push (Force)");
+  QString text = tr("%1 to all remotes").arg(ref.name());
+  LogEntry *entry = addLogEntry(text, title);
+  entry->setBusy(true);
+
+  // Each remote gets its own connection and pack builder.
+  QSharedPointer<int> pending(new int(remotes.size()));
+  foreach (const git::Remote &remote, remotes) {
+    QString name = remote.name();
+    LogEntry *child = entry->addEntry(name);
+    child->setBusy(true);
+
+    auto *watcher = new QFutureWatcher<git::Result>(this);
+    RemoteCallbacks *callbacks =
+        new RemoteCallbacks(RemoteCallbacks::Send, child, remote.url(), name,
+                            watcher, mRepo);
+    connect(callbacks, &RemoteCallbacks::referenceUpdated, this,
+            &RepoView::notifyReferenceUpdated);
+
+    mPushAllWatchers.insert(watcher, callbacks);
+    connect(watcher, &QFutureWatcher<git::Result>::finished, watcher,
+            [this, watcher, callbacks, entry, child, name, pending] {
+              child->setBusy(false);
+
+              git::Result result = watcher->result();
+              if (callbacks->isCanceled()) {
+                child->addEntry(LogEntry::Error, tr("Push canceled."));
+              } else if (!result) {
+                error(child, tr("push to"), name, result.errorString());
+              } else {
+                callbacks->storeDeferredCredentials();
+                if (child->entries().isEmpty())
+                  child->addEntry(tr("Everything up-to-date."));
+              }
+
+              if (--*pending == 0)
+                entry->setBusy(false);
+
+              mPushAllWatchers.remove(watcher);
+              watcher->deleteLater();
+            });
+
+    watcher->setFuture(QtConcurrent::run(remote, &git::Remote::push,
+                                         callbacks, ref, QString(), force,
+                                         false));
+  }
+}
+
 bool RepoView::commit(const QString &message,
                       const git::AnnotatedCommit &upstream, LogEntry *parent,
                       bool force) {
@@ -1912,6 +2114,9 @@ void RepoView::promptToCheckout() {
 }
 
 void RepoView::checkout(const git::Commit &commit, const QStringList &paths) {
+  if (queueAfterCheckout([this, commit, paths] { checkout(commit, paths); }))
+    return;
+
   QString count = QString::number(paths.size());
   QString name = (paths.size() == 1) ? tr("file") : tr("files");
   QString text = tr("%1 - %2 %3").arg(commit.link(), count, name);
@@ -1982,6 +2187,9 @@ void RepoView::checkout(const git::Reference &ref, bool detach) {
 void RepoView::checkout(const git::Commit &commit, const git::Reference &ref,
                         bool detach) {
   Q_ASSERT(detach || ref.isValid());
+  if (queueAfterCheckout(
+          [this, commit, ref, detach] { checkout(commit, ref, detach); }))
+    return;
 
   QString name = tr("<i>no commit</i>");
   if (!detach && ref.isValid()) {
@@ -1991,12 +2199,34 @@ void RepoView::checkout(const git::Commit &commit, const git::Reference &ref,
   }
 
   LogEntry *entry = addLogEntry(name, tr("Checkout"));
-  CheckoutCallbacks callbacks(entry, GIT_CHECKOUT_NOTIFY_DIRTY);
-  if (!commit.isValid() || !mRepo.checkout(commit, &callbacks) ||
-      (detach && !mRepo.setHeadDetached(commit)) ||
+  CheckoutCallbacks *callbacks =
+      new CheckoutCallbacks(entry, GIT_CHECKOUT_NOTIFY_DIRTY, this);
+
+  auto finish = [this, commit, ref, detach, name, entry,
+                 callbacks](bool checkedOut) {
+    callbacks->deleteLater();
+    checkoutFinished(commit, ref, detach, name, entry, checkedOut,
+                     callbacks->conflicts());
+  };
+
+  // Write large tree switches in the background.
+  git::Diff diff = mRepo.checkoutDiff(commit);
+  if (!git::Repository::isParallelCheckout(diff)) {
+    finish(commit.isValid() && mRepo.checkout(commit, callbacks));
+    return;
+  }
+
+  checkoutParallel(commit, diff, callbacks, GIT_CHECKOUT_SAFE, entry, finish);
+}
+
+void RepoView::checkoutFinished(const git::Commit &commit,
+                                const git::Reference &ref, bool detach,
+                                const QString &name, LogEntry *entry,
+                                bool checkedOut, const QStringList &conflicts) {
+  if (!checkedOut || (detach && !mRepo.setHeadDetached(commit)) ||
       (!detach && !mRepo.setHead(ref))) {
     LogEntry *err = error(entry, tr("checkout"), name);
-    foreach (const QString &path, callbacks.conflicts())
+    foreach (const QString &path, conflicts)
       err->addEntry(LogEntry::File, path)->setStatus('!');
 
     if (ref.isValid()) {
@@ -2020,6 +2250,51 @@ void RepoView::checkout(const git::Commit &commit, const git::Reference &ref,
   mRefs->select(mRepo.head());
 }
 
+void RepoView::checkoutParallel(const git::Commit &commit,
+                                const git::Diff &diff,
+                                git::Repository::CheckoutCallbacks *callbacks,
+                                int strategy, LogEntry *entry,
+                                const std::function<void(bool)> &finish) {
+  Q_ASSERT(!mCheckoutWatcher);
+
+  // Stop reading the index until the worker is done with it.
+  mCommits->setStatusSuspended(true);
+  mDetails->setEnabled(false);
+  if (entry)
+    entry->setBusy(true);
+
+  mCheckoutWatcher = new QFutureWatcher<bool>(this);
+  connect(mCheckoutWatcher, &QFutureWatcher<bool>::finished, mCheckoutWatcher,
+          [this, entry, finish] {
+            QFutureWatcher<bool> *watcher = mCheckoutWatcher;
+            mCheckoutWatcher = nullptr;
+            watcher->deleteLater();
+
+            if (entry)
+              entry->setBusy(false);
+            mDetails->setEnabled(true);
+            mCommits->setStatusSuspended(false);
+            finish(watcher->result());
+          });
+
+  git::Repository repo = mRepo;
+  mCheckoutWatcher->setFuture(
+      QtConcurrent::run([repo, commit, diff, callbacks, strategy] {
+        return git::Repository(repo).checkoutParallel(commit, diff, callbacks,
+                                                      strategy);
+      }));
+}
+
+bool RepoView::queueAfterCheckout(const std::function<void()> &operation) {
+  if (!mCheckoutWatcher)
+    return false;
+
+  // Queue operation.
+  connect(mCheckoutWatcher, &QFutureWatcher<bool>::finished, mCheckoutWatcher,
+          operation);
+  return true;
+}
+
 void RepoView::promptToCreateBranch(const git::Commit &commit) {
   NewBranchDialog *dialog = new NewBranchDialog(mRepo, commit, this);
   connect(dialog, &QDialog::accepted, this, [this, dialog] {
@@ -2087,6 +2362,9 @@ void RepoView::promptToStash() {
 }
 
 void RepoView::stash(const QString &message) {
+  if (queueAfterCheckout([this, message] { stash(message); }))
+    return;
+
   QString text = tr("<i>working directory</i>");
   LogEntry *entry = addLogEntry(text, tr("Stash"));
 
@@ -2101,10 +2379,12 @@ void RepoView::stash(const QString &message) {
 }
 
 void RepoView::applyStash(int index) {
-  QList<git::Commit> stashes = mRepo.stashes();
-  Q_ASSERT(index >= 0 && index < stashes.size());
+  if (queueAfterCheckout([this, index] { applyStash(index); }))
+    return;
+
+  Q_ASSERT(index >= 0 && index < mRepo.stashCount());
 
-  git::Commit commit = stashes.at(index);
+  git::Commit commit = mRepo.lookupStash(index);
   LogEntry *entry = addLogEntry(msg(commit), tr("Apply Stash"));
   if (!mRepo.applyStash(index)) {
     error(entry, tr("apply stash"), commit.link());
@@ -2115,15 +2395,14 @@ void RepoView::applyStash(int index) {
 }
 
 void RepoView::dropStash(int index) {
-  QList<git::Commit> stashes = mRepo.stashes();
-  Q_ASSERT(index >= 0 && index < stashes.size());
+  Q_ASSERT(index >= 0 && index < mRepo.stashCount());
 
-  git::Commit commit = stashes.at(index);
+  git::Commit commit = mRepo.lookupStash(index);
   LogEntry *entry = addLogEntry(msg(commit), tr("Drop Stash"));
   if (!mRepo.dropStash(index))
     error(entry, tr("drop stash"), commit.link());
 
-  if (mRepo.stashes().size() == 0) {
+  if (mRepo.stashCount() == 0) {
     // switch back to head when there are no stashes left
     mCommits->setReference(mRepo.head());
   } else {
@@ -2132,10 +2411,12 @@ void RepoView::dropStash(int index) {
 }
 
 void RepoView::popStash(int index) {
-  QList<git::Commit> stashes = mRepo.stashes();
-  Q_ASSERT(index >= 0 && index < stashes.size());
+  if (queueAfterCheckout([this, index] { popStash(index); }))
+    return;
+
+  Q_ASSERT(index >= 0 && index < mRepo.stashCount());
 
-  git::Commit commit = stashes.at(index);
+  git::Commit commit = mRepo.lookupStash(index);
   LogEntry *entry = addLogEntry(msg(commit), tr("Pop Stash"));
   if (!mRepo.popStash(index)) {
     error(entry, tr("pop stash"), commit.link());
@@ -2274,6 +2555,11 @@ void RepoView::promptToReset(const git::Commit &commit, git_reset_t type) {
 
 void RepoView::reset(const git::Commit &commit, git_reset_t type,
                      const git::Commit &commitToAmend) {
+  if (queueAfterCheckout([this, commit, type, commitToAmend] {
+        reset(commit, type, commitToAmend);
+      }))
+    return;
+
   git::Reference head = mRepo.head();
   Q_ASSERT(head.isValid());
 
@@ -2281,14 +2567,35 @@ void RepoView::reset(const git::Commit &commit, git_reset_t type,
   QString text = tr("%1 to %2").arg(head.name(), commit.link());
   LogEntry *entry = addLogEntry(text, title);
 
-  if (!commit.reset(type, QStringList(), false))
-    error(entry, commitToAmend ? tr("amend") : tr("reset"), head.name());
+  auto finish = [this, entry, head, type, commitToAmend](bool ok) {
+    if (!ok)
+      error(entry, commitToAmend ? tr("amend") : tr("reset"), head.name());
+
+    updateSubmodules(mRepo.submodules(), true, false,
+                     (type == GIT_RESET_HARD) ? true : false, entry,
+                     type == git_reset_t::GIT_RESET_HARD);
+    if (mRepo.submodules().isEmpty())
+      refresh(type == git_reset_t::GIT_RESET_HARD);
+  };
+
+  // Write large hard resets in the background.
+  git::Diff diff;
+  if (type == GIT_RESET_HARD)
+    diff = mRepo.checkoutDiff(commit);
 
-  updateSubmodules(mRepo.submodules(), true, false,
-                   (type == GIT_RESET_HARD) ? true : false, entry,
-                   type == git_reset_t::GIT_RESET_HARD);
-  if (mRepo.submodules().isEmpty())
-    refresh(type == git_reset_t::GIT_RESET_HARD);
+  if (!git::Repository::isParallelCheckout(diff)) {
+    finish(commit.reset(type, QStringList(), false));
+    return;
+  }
+
+  // The workdir and index have been written. A mixed reset moves
+  // HEAD, cleans up the repository state and keeps the stat data of
+  // the index entries.
+  checkoutParallel(commit, diff, nullptr, GIT_CHECKOUT_FORCE, entry,
+                   [commit, finish](bool ok) {
+                     finish(ok && commit.reset(GIT_RESET_MIXED, QStringList(),
+                                               false));
+                   });
 }
 
 void RepoView::resetSubmodules(const QList<git::Submodule> &submodules,
@@ -2811,6 +3118,7 @@ void RepoView::refresh(bool restoreSelection) {
   }
   DebugRefresh("time: " << QDateTime::currentDateTime()
                         << " Set diff counter: " << counter);
+
   emit mRepo.notifier()->referenceUpdated(mRepo.head(), restoreSelection);
 }
 
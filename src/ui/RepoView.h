@@ -23,6 +23,7 @@
 #include "host/Account.h"
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QHash>
 #include <QProcess>
 #include <QSplitter>
 #include <QTimer>
@@ -38,9 +39,13 @@ class LogEntry;
 class LogView;
 class MainWindow;
 class PathspecWidget;
+class RebaseCallbacks;
 class ReferenceWidget;
+class RepoState;
 class RemoteCallbacks;
+class Statistics;
 class ToolBar;
+class TrigramIndex;
 struct ContributorInfo;
 
 namespace git {
@@ -81,7 +86,10 @@ public:
 
   git::Repository repo() const { return mRepo; }
   History *history() const { return mHistory; }
+  RepoState *repoState() const { return mState; }
   Index *index() const { return mIndex; }
+  TrigramIndex *trigramIndex() const { return mTrigramIndex; }
+  Statistics *statistics();
 
   Repository *remoteRepo();
 
@@ -111,6 +119,9 @@ public:
   git::Reference reference() const;
   void selectReference(const git::Reference &ref);
 
+  // Show the commits recorded in the reflog of the given reference.
+  void showReflog(const git::Reference &ref);
+
   // current selection
   QList<git::Commit> commits() const;
   git::Diff diff() const;
@@ -202,6 +213,10 @@ public:
   // rebase
   void rebase(const git::AnnotatedCommit &upstream, LogEntry *parent);
 
+  // Canceling an in-memory rebase that runs in the background.
+  // Returns without waiting for the worker to stop.
+  void cancelRebase();
+
   // Aborting the current ongoing rebase
   void abortRebase();
 
@@ -225,6 +240,7 @@ public:
             const git::Reference &src = git::Reference(),
             const QString &dst = QString(), bool setUpstream = false,
             bool force = false, bool tags = false);
+  void pushAll(bool force = false);
 
   // commit
   bool commit(const git::Signature &author, const git::Signature &commiter,
@@ -352,11 +368,12 @@ private slots:
   void rebaseInitError();
   void rebaseCommitInvalid(const git::Rebase rebase);
   void rebaseAboutToRebase(const git::Rebase rebase, const git::Commit before,
-                           int currIndex);
+                           int currIndex, int total);
   void rebaseFinished(const git::Rebase rebase);
   void rebaseCommitSuccess(const git::Rebase rebase, const git::Commit before,
-                           const git::Commit after, int currIndex);
+                           const git::Commit after, int currIndex, int total);
   void rebaseConflict(const git::Rebase rebase);
+  void rebaseCanceled(const git::Rebase rebase);
 
 signals:
   void statusChanged(bool dirty);
@@ -399,15 +416,37 @@ private:
 
   bool checkForConflicts(LogEntry *parent, const QString &action);
 
+  void fastForwardFinished(const git::Reference &ref,
+                           const git::Reference &head,
+                           const git::Commit &commit, LogEntry *parent,
+                           const std::function<void()> &callback,
+                           bool checkedOut, const QStringList &conflicts);
+
+  void checkoutFinished(const git::Commit &commit, const git::Reference &ref,
+                        bool detach, const QString &name, LogEntry *entry,
+                        bool checkedOut, const QStringList &conflicts);
+
+  // Write a large checkout on a worker. Status, staging and operations
+  // that touch the index wait until it's finished.
+  void checkoutParallel(const git::Commit &commit, const git::Diff &diff,
+                        git::Repository::CheckoutCallbacks *callbacks,
+                        int strategy, LogEntry *entry,
+                        const std::function<void(bool)> &finish);
+
+  // Queue the operation if a checkout is running. Returns false
+  // if the operation can run now.
+  bool queueAfterCheckout(const std::function<void()> &operation);
+
   git::Signature getSignature(const ContributorInfo &info);
 
   git::Repository mRepo;
 
   Index *mIndex;
-  QProcess mIndexer;
-  bool mRestartIndexer = false;
+  TrigramIndex *mTrigramIndex = nullptr;
+  Statistics *mStatistics = nullptr;
 
   History *mHistory;
+  RepoState *mState;
 
   Repository *mRemoteRepo;
   bool mRemoteRepoCached = false;
@@ -420,6 +459,8 @@ private:
 
   LogEntry *mLogRoot;
   LogEntry *mRebase{nullptr};
+  RebaseCallbacks *mRebaseCallbacks = nullptr;
+  QFutureWatcher<void> *mRebaseWatcher = nullptr;
   LogView *mLogView;
   QTimer mLogTimer;
   bool mIsLogVisible = false;
@@ -427,6 +468,8 @@ private:
   QTimer mFetchTimer;
   RemoteCallbacks *mCallbacks = nullptr;
   QFutureWatcher<git::Result> *mWatcher = nullptr;
+  QHash<QFutureWatcher<git::Result> *, RemoteCallbacks *> mPushAllWatchers;
+  QFutureWatcher<bool> *mCheckoutWatcher = nullptr;
 
   QList<QWidget *> mTrackedWindows;
 
@@ -11,12 +11,14 @@
 #include "History.h"
 #include "MainWindow.h"
 #include "qtsupport.h"
+#include "RepoState.h"
 #include "RepoView.h"
 #include "SearchField.h"
 #include "app/Application.h"
 #include "dialogs/PullRequestDialog.h"
 #include "git/Branch.h"
 #include "git/Commit.h"
+#include "git/ReferenceCatalog.h"
 #include "ui/HotkeyManager.h"
 #include "dialogs/SettingsDialog.h"
 #include <QAction>
@@ -828,8 +830,12 @@ ToolBar::ToolBar(MainWindow *parent) : QToolBar(parent) {
 
   mRefreshButton = new RefreshButton(this);
   addWidget(mRefreshButton);
-  connect(mRefreshButton, &Button::clicked,
-          [this] { currentView()->refresh(); });
+  connect(mRefreshButton, &Button::clicked, [this] {
+    // Pick up references that were changed outside of the app.
+    RepoView *view = currentView();
+    view->repo().referenceCatalog()->update();
+    view->refresh();
+  });
 
   if (!qgetenv("GITTYUP_OAUTH").isEmpty()) {
     addWidget(new Spacer(4, this));
@@ -974,7 +980,7 @@ void ToolBar::updateButtons(int ahead, int behind) {
   mRefreshButton->setEnabled(view);
   if (mPullRequestButton)
     mPullRequestButton->setEnabled(view);
-  mCheckoutButton->setEnabled(view && !view->repo().isBare());
+  mCheckoutButton->setEnabled(view && !view->repoState()->snapshot().bare);
 }
 
 void ToolBar::updateRemote(int ahead, int behind) {
@@ -983,7 +989,7 @@ void ToolBar::updateRemote(int ahead, int behind) {
 
   RepoView *view = currentView();
   mFetchButton->setEnabled(view);
-  mPullButton->setEnabled(view && !view->repo().isBare());
+  mPullButton->setEnabled(view && !view->repoState()->snapshot().bare);
   mPushButton->setEnabled(view);
 }
 
@@ -1002,7 +1008,8 @@ void ToolBar::updateHistory() {
 void ToolBar::updateStash() {
   RepoView *view = currentView();
   mStashButton->setEnabled(view && view->isWorkingDirectoryDirty());
-  mStashPopButton->setEnabled(view && view->repo().stashRef().isValid());
+  mStashPopButton->setEnabled(view &&
+                              view->repoState()->snapshot().stashCount);
 }
 
 void ToolBar::updateView() {
@@ -78,6 +78,9 @@ void TreeView::setModel(QAbstractItemModel *model) {
   connect(model, &QAbstractItemModel::rowsInserted, this,
           QOverload<const QModelIndex &, int, int>::of(
               &TreeView::updateCollapseCount));
+  connect(model, &QAbstractItemModel::rowsRemoved, this,
+          QOverload<const QModelIndex &, int, int>::of(
+              &TreeView::updateCollapseCount));
 
   // Allow column sorting and set the default column and sort order.
   setSortingEnabled(true);
@@ -0,0 +1,189 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "host/ApiClient.h"
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QUrlQuery>
+
+using namespace QTest;
+
+namespace {
+
+const int kPageCount = 3;
+
+// Serves three pages of a list, either with Link headers (/repos) or
+// with the page count in the body (/values).
+class MockServer : public QTcpServer {
+public:
+  MockServer() {
+    listen(QHostAddress::LocalHost);
+    connect(this, &QTcpServer::newConnection, this, [this] {
+      while (QTcpSocket *socket = nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, socket,
+                [this, socket] { read(socket); });
+        connect(socket, &QTcpSocket::disconnected, socket,
+                &QObject::deleteLater);
+      }
+    });
+  }
+
+  QString url(const QString &path) const {
+    return QString("http://127.0.0.1:%1%2").arg(serverPort()).arg(path);
+  }
+
+  int requests = 0;
+  int notModified = 0;
+
+private:
+  void read(QTcpSocket *socket) {
+    QByteArray &buffer = mBuffers[socket];
+    buffer.append(socket->readAll());
+    if (!buffer.contains("\r\n\r\n"))
+      return;
+
+    QList<QByteArray> lines = buffer.split('\n');
+    QUrl target(url(lines.first().split(' ').value(1)));
+    QByteArray etag;
+    foreach (const QByteArray &line, lines) {
+      if (line.toLower().startsWith("if-none-match:"))
+        etag = line.mid(line.indexOf(':') + 1).trimmed();
+    }
+
+    mBuffers.remove(socket);
+    ++requests;
+
+    int page = qMax(1, QUrlQuery(target).queryItemValue("page").toInt());
+    QByteArray tag = QString("\"p%1\"").arg(page).toUtf8();
+
+    QByteArray status = "200 OK";
+    QByteArray headers = "ETag: " + tag + "\r\n";
+    QByteArray body;
+    if (target.path() == "/missing") {
+      status = "404 Not Found";
+      headers.clear();
+    } else if (etag == tag) {
+      status = "304 Not Modified";
+      ++notModified;
+    } else if (target.path() == "/repos") {
+      body = QJsonDocument(QJsonArray({page})).toJson();
+      if (page == 1) {
+        QString next = url("/repos?page=2");
+        QString last = url("/repos?page=%1").arg(kPageCount);
+        QString link = QString("<%1>; rel=\"next\", <%2>; rel=\"last\"");
+        headers += "Link: " + link.arg(next, last).toUtf8() + "\r\n";
+      }
+    } else {
+      QJsonObject obj = {{"values", QJsonArray({page})},
+                         {"size", 2 * kPageCount - 1},
+                         {"pagelen", 2}};
+      if (page < kPageCount)
+        obj.insert("next", url("/values?page=%1").arg(page + 1));
+      body = QJsonDocument(obj).toJson();
+    }
+
+    socket->write("HTTP/1.1 " + status + "\r\n" + headers +
+                  "Content-Type: application/json\r\n"
+                  "Content-Length: " +
+                  QByteArray::number(body.size()) +
+                  "\r\n"
+                  "Connection: close\r\n\r\n" +
+                  body);
+    socket->disconnectFromHost();
+  }
+
+  QMap<QTcpSocket *, QByteArray> mBuffers;
+};
+
+} // namespace
+
+class TestApiClient : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void pages();
+  void conditional();
+  void bodyPagination();
+  void error();
+
+private:
+  QList<int> fetch(const QString &path, bool *failed = nullptr);
+
+  MockServer mServer;
+  QTemporaryDir mCacheDir;
+  QNetworkAccessManager mMgr;
+  ApiClient *mClient = nullptr;
+};
+
+QList<int> TestApiClient::fetch(const QString &path, bool *failed) {
+  QList<int> pages;
+  bool done = false;
+  mClient->get(
+      QNetworkRequest(mServer.url(path)),
+      [&pages](const QJsonDocument &doc) {
+        QJsonArray array = doc.isArray()
+                               ? doc.array()
+                               : doc.object().value("values").toArray();
+        foreach (const QJsonValue &value, array)
+          pages.append(value.toInt());
+      },
+      [&done, failed](const QNetworkReply *reply) {
+        if (failed)
+          *failed = reply;
+        done = true;
+      });
+
+  for (int i = 0; i < 100 && !done; ++i)
+    qWait(50);
+
+  return pages;
+}
+
+void TestApiClient::initTestCase() {
+  QVERIFY(mServer.isListening());
+  mClient = new ApiClient(&mMgr, this);
+  mClient->setCacheDir(mCacheDir.path());
+}
+
+void TestApiClient::pages() {
+  bool failed = true;
+  QCOMPARE(fetch("/repos", &failed), QList<int>({1, 2, 3}));
+  QVERIFY(!failed);
+  QCOMPARE(mServer.requests, kPageCount);
+  QCOMPARE(mServer.notModified, 0);
+}
+
+void TestApiClient::conditional() {
+  // Every page is revalidated and read from the cache.
+  mServer.requests = 0;
+  QCOMPARE(fetch("/repos"), QList<int>({1, 2, 3}));
+  QCOMPARE(mServer.requests, kPageCount);
+  QCOMPARE(mServer.notModified, kPageCount);
+}
+
+void TestApiClient::bodyPagination() {
+  mClient->setCacheDir(QString());
+  QCOMPARE(fetch("/values"), QList<int>({1, 2, 3}));
+  mClient->setCacheDir(mCacheDir.path());
+}
+
+void TestApiClient::error() {
+  bool failed = false;
+  QVERIFY(fetch("/missing", &failed).isEmpty());
+  QVERIFY(failed);
+}
+
+TEST_MAIN(TestApiClient)
+
+#include "ApiClient.moc"
@@ -10,21 +10,47 @@
 #include "Test.h"
 #include "git/Diff.h"
 
+using namespace Test;
 using namespace QTest;
 
-class TestDiff : public QObject {
+namespace {
+
+class Visitor : public git::Diff::Visitor {
 public:
-  TestDiff(){};
+  Visitor(int stop = -1) : mStop(stop) {}
+
+  bool file(const QString &path, bool binary) override {
+    files.append(qMakePair(path, binary));
+    return true;
+  }
+
+  bool line(char origin, const QByteArray &content) override {
+    lines.append(content);
+    return lines.size() != mStop;
+  }
+
+  QList<QPair<QString, bool>> files;
+  QByteArrayList lines;
+
+private:
+  int mStop;
+};
+
+} // namespace
+
+class TestDiff : public QObject {
+  Q_OBJECT
+
 private slots:
   void testContainsPath1() {
     // /src/testfile.txt, /src/testfile.txt1 - path: /src/testfile.txt --> only
     // /src/testfile.txt is shown
     QString str("/src/testfile.txt");
     QString occurence("/src/testfile.txt");
-    QVERIFY(containsPath(str, occurence));
+    QVERIFY(containsPath(occurence, str));
 
     occurence = "/src/testfile.txt1";
-    QVERIFY(!containsPath(str, occurence));
+    QVERIFY(!containsPath(occurence, str));
   }
 
   void testContainsPath2() {
@@ -32,10 +58,10 @@ private slots:
     // testfile1.txt is shown
     QString str("/src");
     QString occurence("/src/testfile.txt");
-    QVERIFY(containsPath(str, occurence));
+    QVERIFY(containsPath(occurence, str));
 
     occurence = "/src/testfile.txt1";
-    QVERIFY(containsPath(str, occurence));
+    QVERIFY(containsPath(occurence, str));
   }
 
   void testContainsPath3() {
@@ -43,14 +69,39 @@ private slots:
     // /src/test --> only /src/test/testtest.txt11 is shown
     QString str("/src/test");
     QString occurence("/src/test/test.txt11");
-    QVERIFY(containsPath(str, occurence));
+    QVERIFY(containsPath(occurence, str));
 
     occurence = "/src/testfile.txt";
-    QVERIFY(!containsPath(str, occurence));
+    QVERIFY(!containsPath(occurence, str));
 
     occurence = "/src/testfile.txt1";
-    QVERIFY(!containsPath(str, occurence));
+    QVERIFY(!containsPath(occurence, str));
+  }
+
+  void visit() {
+    ScratchRepository repo;
+    git::Commit commit = commitFile(repo, "file.txt", "a\nb\nc\n", "abc");
+    QVERIFY(commit.isValid());
+
+    Visitor visitor;
+    QVERIFY(commit.diff().visit(visitor));
+    QCOMPARE(visitor.files.size(), 1);
+    QCOMPARE(visitor.files.first(), qMakePair(QString("file.txt"), false));
+    QCOMPARE(visitor.lines, QByteArrayList({"a\n", "b\n", "c\n"}));
+
+    // Blobs over the size limit are reported as binary.
+    Visitor limited;
+    QVERIFY(commit.diff(git::Commit(), -1, false, 4).visit(limited));
+    QCOMPARE(limited.files.first(), qMakePair(QString("file.txt"), true));
+    QVERIFY(limited.lines.isEmpty());
+
+    // The visitor can stop generation early.
+    Visitor stopped(2);
+    QVERIFY(!commit.diff().visit(stopped));
+    QCOMPARE(stopped.lines.size(), 2);
   }
 };
 
 TEST_MAIN(TestDiff)
+
+#include "Diff.moc"
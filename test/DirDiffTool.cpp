@@ -0,0 +1,79 @@
+//
+//          Copyright (c) 2017, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Command.h"
+#include "git/Config.h"
+#include "git/Index.h"
+#include "git2/common.h"
+#include "tools/DirDiffTool.h"
+
+using namespace Test;
+using namespace QTest;
+
+class TestDirDiffTool : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void writeBack();
+
+private:
+  QTemporaryDir mHome;
+};
+
+void TestDirDiffTool::initTestCase() {
+  if (git::Command::bashPath().isEmpty())
+    QSKIP("bash not found");
+
+  // Use a private global config for the diff tool.
+  QVERIFY(mHome.isValid());
+  QByteArray home = QFile::encodeName(mHome.path());
+  QCOMPARE(git_libgit2_opts(GIT_OPT_SET_SEARCHPATH, GIT_CONFIG_LEVEL_GLOBAL,
+                            home.constData()),
+           0);
+
+  // Save a.txt atomically and b.txt in place.
+  git::Config config =
+      git::Config::open(QDir(mHome.path()).filePath(".gitconfig"));
+  config.setValue("diff.tool", QString("test"));
+  config.setValue("difftool.test.cmd",
+                  QString("printf 'saved\\n' > \"$REMOTE/a.txt.tmp\" && "
+                          "mv \"$REMOTE/a.txt.tmp\" \"$REMOTE/a.txt\" && "
+                          "printf 'edited\\n' > \"$REMOTE/b.txt\""));
+}
+
+void TestDirDiffTool::writeBack() {
+  ScratchRepository repo;
+  QDir dir = repo->workdir();
+
+  QMap<QString, QByteArray> files = {
+      {"a.txt", "a.txt\n"}, {"b.txt", "b.txt\n"}, {"c.txt", "c.txt\n"}};
+  QVERIFY(commitFiles(repo, files, "base").isValid());
+
+  foreach (const QString &file, files.keys())
+    QVERIFY(writeFile(dir, file, "changed\n"));
+
+  git::Diff diff = repo->status(repo->index(), nullptr);
+  QCOMPARE(diff.count(), 3);
+
+  DirDiffTool *tool = new DirDiffTool(QStringList(), diff, repo);
+  QVERIFY(tool->isValid());
+
+  QSignalSpy destroyed(tool, &QObject::destroyed);
+  QVERIFY(tool->start());
+  QVERIFY(destroyed.wait(10000));
+
+  // Both saves land in the worktree. Untouched files are left alone.
+  QCOMPARE(readFile(dir, "a.txt"), QByteArray("saved\n"));
+  QCOMPARE(readFile(dir, "b.txt"), QByteArray("edited\n"));
+  QCOMPARE(readFile(dir, "c.txt"), QByteArray("changed\n"));
+}
+
+TEST_MAIN(TestDirDiffTool)
+
+#include "DirDiffTool.moc"
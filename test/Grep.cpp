@@ -0,0 +1,152 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "index/Grep.h"
+
+using namespace QTest;
+
+namespace {
+
+const char *kContent = "first line\n"
+                       "Second Line with needle\r\n"
+                       "\n"
+                       "needle needle\n"
+                       "last NEEDLE";
+
+const char *kSource = "int a = 0; // needle in a comment\n"
+                      "/* first line\n"
+                      "   needle inside a block comment */\n"
+                      "const char *s = \"needle\";\n"
+                      "needle();\n";
+
+Grep::Options options(const QString &pattern, bool regex = false,
+                      bool caseSensitive = false,
+                      Grep::Field field = Grep::AnyField) {
+  Grep::Options options;
+  options.pattern = pattern;
+  options.regex = regex;
+  options.caseSensitive = caseSensitive;
+  options.field = field;
+  return options;
+}
+
+QList<int> lines(const QList<Grep::Match> &matches) {
+  QList<int> lines;
+  foreach (const Grep::Match &match, matches)
+    lines.append(match.line);
+  return lines;
+}
+
+} // namespace
+
+class TestGrep : public QObject {
+  Q_OBJECT
+
+private slots:
+  void literal();
+  void caseSensitive();
+  void regex();
+  void empty();
+  void fields();
+  void genericFields();
+};
+
+void TestGrep::literal() {
+  QList<Grep::Match> matches =
+      Grep::search(kContent, "file.txt", options("needle"));
+  QCOMPARE(matches.size(), 3);
+
+  QCOMPARE(matches.at(0).path, QString("file.txt"));
+  QCOMPARE(matches.at(0).line, 2);
+  QCOMPARE(matches.at(0).text, QString("Second Line with needle"));
+
+  // Multiple hits on one line are reported once.
+  QCOMPARE(matches.at(1).line, 4);
+  QCOMPARE(matches.at(2).line, 5);
+  QCOMPARE(matches.at(2).text, QString("last NEEDLE"));
+}
+
+void TestGrep::caseSensitive() {
+  QList<Grep::Match> matches =
+      Grep::search(kContent, "file.txt", options("NEEDLE", false, true));
+  QCOMPARE(matches.size(), 1);
+  QCOMPARE(matches.at(0).line, 5);
+
+  matches = Grep::search(kContent, "file.txt", options("line", false, true));
+  QCOMPARE(matches.size(), 1);
+  QCOMPARE(matches.at(0).line, 1);
+}
+
+void TestGrep::regex() {
+  QList<Grep::Match> matches =
+      Grep::search(kContent, "file.txt", options("^needle", true));
+  QCOMPARE(matches.size(), 1);
+  QCOMPARE(matches.at(0).line, 4);
+
+  matches = Grep::search(kContent, "file.txt", options("l\\w+e$", true));
+  QCOMPARE(matches.size(), 1);
+  QCOMPARE(matches.at(0).line, 1);
+
+  // Invalid expressions don't match.
+  QVERIFY(Grep::search(kContent, "file.txt", options("(", true)).isEmpty());
+}
+
+void TestGrep::empty() {
+  QVERIFY(Grep::search(kContent, "file.txt", options(QString())).isEmpty());
+  QVERIFY(Grep::search(QByteArray(), "file.txt", options("x")).isEmpty());
+}
+
+void TestGrep::fields() {
+  LexerPool lexers;
+  QList<Grep::Match> matches = Grep::search(
+      kSource, "file.cpp", options("needle", false, false, Grep::Comments),
+      &lexers);
+
+  // The block comment is lexed as a whole and not line by line.
+  QCOMPARE(lines(matches), QList<int>({1, 3}));
+
+  matches = Grep::search(kSource, "file.cpp",
+                         options("needle", false, false, Grep::Strings),
+                         &lexers);
+  QCOMPARE(lines(matches), QList<int>({4}));
+
+  matches =
+      Grep::search(kSource, "file.cpp",
+                   options("needle", false, false, Grep::Code), &lexers);
+  QCOMPARE(lines(matches), QList<int>({5}));
+
+  matches = Grep::search(kSource, "file.cpp",
+                         options("^\\s+needle", true, false, Grep::Comments),
+                         &lexers);
+  QCOMPARE(lines(matches), QList<int>({3}));
+
+  // Without a lexer pool there's no filtering.
+  matches = Grep::search(kSource, "file.cpp",
+                         options("needle", false, false, Grep::Comments));
+  QCOMPARE(lines(matches), QList<int>({1, 3, 4, 5}));
+}
+
+void TestGrep::genericFields() {
+  // The generic lexer carries strings across lines too.
+  const char *content = "x = \"first\nneedle\";\nneedle\n";
+
+  LexerPool lexers;
+  QList<Grep::Match> matches = Grep::search(
+      content, "file.unknown",
+      options("needle", false, false, Grep::Strings), &lexers);
+  QCOMPARE(lines(matches), QList<int>({2}));
+
+  matches = Grep::search(content, "file.unknown",
+                         options("needle", false, false, Grep::Code),
+                         &lexers);
+  QCOMPARE(lines(matches), QList<int>({3}));
+}
+
+TEST_MAIN(TestGrep)
+
+#include "Grep.moc"
@@ -0,0 +1,139 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+// Author: Jason Haslam
+//
+
+#include "Test.h"
+#include "git/IdHash.h"
+#include <QCryptographicHash>
+#include <QSet>
+
+using namespace QTest;
+
+namespace {
+
+const int kCount = 100000;
+
+QList<git::Id> ids(int count, int offset = 0) {
+  QList<git::Id> ids;
+  ids.reserve(count);
+  for (int i = offset; i < offset + count; ++i) {
+    QByteArray data = QByteArray::number(i);
+    ids.append(QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+  }
+
+  return ids;
+}
+
+} // namespace
+
+class TestIdHash : public QObject {
+  Q_OBJECT
+
+private slots:
+  void map();
+  void remove();
+  void set();
+
+  void benchmarkQSet();
+  void benchmarkIdSet();
+};
+
+void TestIdHash::map() {
+  QList<git::Id> keys = ids(1000);
+
+  git::IdMap<int> map;
+  for (int i = 0; i < keys.size(); ++i)
+    QVERIFY(map.insert(keys.at(i), i));
+
+  QCOMPARE(map.size(), keys.size());
+  QVERIFY(!map.insert(keys.first(), -1));
+  QCOMPARE(map.value(keys.first()), -1);
+
+  for (int i = 1; i < keys.size(); ++i)
+    QCOMPARE(map.value(keys.at(i)), i);
+
+  foreach (const git::Id &id, ids(1000, 1000))
+    QVERIFY(!map.find(id));
+
+  map[keys.at(1)] += 10;
+  QCOMPARE(map.value(keys.at(1)), 11);
+  QCOMPARE(map.keys(), keys);
+}
+
+void TestIdHash::remove() {
+  QList<git::Id> keys = ids(1000);
+
+  git::IdMap<int> map;
+  for (int i = 0; i < keys.size(); ++i)
+    map.insert(keys.at(i), i);
+
+  // Remove every other key and make sure the rest is still reachable.
+  for (int i = 0; i < keys.size(); i += 2)
+    QVERIFY(map.remove(keys.at(i)));
+  QVERIFY(!map.remove(keys.first()));
+
+  QCOMPARE(map.size(), keys.size() / 2);
+  for (int i = 0; i < keys.size(); ++i) {
+    QCOMPARE(map.contains(keys.at(i)), i % 2 == 1);
+    if (i % 2)
+      QCOMPARE(map.value(keys.at(i)), i);
+  }
+}
+
+void TestIdHash::set() {
+  QList<git::Id> keys = ids(1000);
+
+  git::IdSet set;
+  foreach (const git::Id &id, keys)
+    QVERIFY(set.insert(id));
+  foreach (const git::Id &id, keys)
+    QVERIFY(!set.insert(id));
+
+  QCOMPARE(set.size(), keys.size());
+  QVERIFY(!set.contains(git::Id()));
+  QCOMPARE(set.values(), keys);
+}
+
+void TestIdHash::benchmarkQSet() {
+  QList<git::Id> keys = ids(kCount);
+  QList<git::Id> misses = ids(kCount, kCount);
+
+  int found = 0;
+  QBENCHMARK {
+    QSet<git::Id> set;
+    set.reserve(keys.size());
+    foreach (const git::Id &id, keys)
+      set.insert(id);
+
+    foreach (const git::Id &id, keys + misses)
+      found += set.contains(id);
+  }
+
+  QVERIFY(found > 0);
+}
+
+void TestIdHash::benchmarkIdSet() {
+  QList<git::Id> keys = ids(kCount);
+  QList<git::Id> misses = ids(kCount, kCount);
+
+  int found = 0;
+  QBENCHMARK {
+    git::IdSet set(keys.size());
+    foreach (const git::Id &id, keys)
+      set.insert(id);
+
+    foreach (const git::Id &id, keys + misses)
+      found += set.contains(id);
+  }
+
+  QVERIFY(found > 0);
+}
+
+TEST_MAIN(TestIdHash)
+
+#include "IdHash.moc"
@@ -0,0 +1,67 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Identities.h"
+#include "git/Signature.h"
+
+using namespace Test;
+using namespace QTest;
+
+class TestIdentities : public QObject {
+  Q_OBJECT
+
+private slots:
+  void intern();
+};
+
+void TestIdentities::intern() {
+  ScratchRepository repo;
+
+  // The mailmap is read when the table is created.
+  QFile mailmap(repo->workdir().filePath(".mailmap"));
+  QVERIFY(mailmap.open(QFile::WriteOnly));
+  mailmap.write("Jane Doe <jane@example.com> <jdoe@old.example.com>\n");
+  mailmap.close();
+
+  git::Identities *identities = repo->identities();
+  QCOMPARE(identities, repo->identities());
+  QCOMPARE(identities->count(), 1);
+
+  quint32 jane =
+      identities->intern(repo->signature("Jane Doe", "jane@example.com"));
+  quint32 old =
+      identities->intern(repo->signature("J. Doe", "jdoe@old.example.com"));
+  quint32 john =
+      identities->intern(repo->signature("John  Smith", "John@Example.com"));
+
+  QVERIFY(jane != 0);
+  QCOMPARE(old, jane);
+  QVERIFY(john != jane);
+  QCOMPARE(identities->count(), 3);
+
+  // Interning again doesn't add anything.
+  git::Signature signature = repo->signature("J. Doe", "jdoe@old.example.com");
+  QCOMPARE(identities->intern(signature), jane);
+  QCOMPARE(identities->count(), 3);
+
+  git::Identities::Identity identity = identities->identity(old);
+  QCOMPARE(identity.name, QString("Jane Doe"));
+  QCOMPARE(identity.email, QString("jane@example.com"));
+  QCOMPARE(identity.initials, QString("JD"));
+
+  identity = identities->identity(john);
+  QCOMPARE(identity.emailTerm, QByteArray("john@example.com"));
+  QCOMPARE(identity.nameTerms, QList<QByteArray>({"john", "smith"}));
+
+  QVERIFY(identities->identity(0).name.isEmpty());
+  QVERIFY(identities->identity(100).name.isEmpty());
+}
+
+TEST_MAIN(TestIdentities)
+
+#include "Identities.moc"
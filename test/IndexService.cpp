@@ -0,0 +1,257 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "index/IndexService.h"
+#include <QLocalServer>
+#include <QMutex>
+#include <QThread>
+#include <QUuid>
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+const int kTimeout = 5000;
+
+QString uniqueName() {
+  return QString("test-indexer-%1").arg(QUuid::createUuid().toString());
+}
+
+QByteArray key(const git::Repository &repo) {
+  return repo.dir().path().toUtf8();
+}
+
+git::Commit commit(git::Repository repo, int i) {
+  QByteArray content = "line " + QByteArray::number(i) + '\n';
+  return commitFile(repo, "file.txt", content, QString("commit %1").arg(i));
+}
+
+// Answer cancel requests from another thread.
+class Server : public QThread {
+public:
+  Server(const QString &name) : mName(name) {}
+
+  bool isListening() const { return mListening.loadAcquire(); }
+
+  QByteArrayList lines() const {
+    QMutexLocker locker(&mMutex);
+    return mLines;
+  }
+
+protected:
+  void run() override {
+    QLocalServer server;
+    if (!server.listen(mName))
+      return;
+
+    mListening.storeRelease(1);
+    if (!server.waitForNewConnection(kTimeout))
+      return;
+
+    QLocalSocket *socket = server.nextPendingConnection();
+    while (socket->waitForReadyRead(kTimeout)) {
+      while (socket->canReadLine()) {
+        QByteArray line = socket->readLine().trimmed();
+        {
+          QMutexLocker locker(&mMutex);
+          mLines.append(line);
+        }
+
+        if (line.startsWith("cancel ")) {
+          socket->write("done " + line.mid(7) + '\n');
+          socket->waitForBytesWritten(kTimeout);
+          return;
+        }
+      }
+    }
+  }
+
+private:
+  QString mName;
+  QAtomicInt mListening;
+
+  mutable QMutex mMutex;
+  QByteArrayList mLines;
+};
+
+// Collect the lines that the indexer sends to one client.
+class Client : public QObject {
+public:
+  Client(const QString &name) {
+    connect(&mSocket, &QLocalSocket::readyRead, [this] {
+      while (mSocket.canReadLine())
+        lines.append(mSocket.readLine().trimmed());
+    });
+
+    // Wait for the server to start listening.
+    QElapsedTimer timer;
+    timer.start();
+    do {
+      mSocket.connectToServer(name);
+      if (mSocket.waitForConnected(100))
+        break;
+      qWait(100);
+    } while (timer.elapsed() < kTimeout);
+  }
+
+  bool isConnected() const {
+    return mSocket.state() == QLocalSocket::ConnectedState;
+  }
+
+  void send(const QByteArray &command, const git::Repository &repo) {
+    mSocket.write(command + ' ' + key(repo) + '\n');
+    mSocket.flush();
+  }
+
+  void close() { mSocket.disconnectFromServer(); }
+
+  QByteArrayList lines;
+
+private:
+  QLocalSocket mSocket;
+};
+
+} // namespace
+
+class TestIndexService : public QObject {
+  Q_OBJECT
+
+private slots:
+  void spawnFailure();
+  void cancelUnconfirmed();
+  void idleExit();
+  void sharedCancel();
+};
+
+void TestIndexService::spawnFailure() {
+  ScratchRepository repo;
+  QString name = uniqueName();
+  QString program = QDir::temp().filePath(uniqueName());
+  IndexService service(name, program);
+
+  // The request doesn't block when the server can't be started.
+  QElapsedTimer timer;
+  timer.start();
+  service.start(repo);
+  QVERIFY(timer.elapsed() < 1000);
+
+  // The client stops trying.
+  QLocalServer server;
+  QVERIFY(server.listen(name));
+  qWait(1000);
+  QVERIFY(!server.hasPendingConnections());
+
+  // A later request reaches a server that was started elsewhere.
+  service.start(repo);
+  QTRY_VERIFY(server.hasPendingConnections());
+
+  QLocalSocket *socket = server.nextPendingConnection();
+  QTRY_VERIFY(socket->canReadLine());
+
+  QByteArray line = socket->readLine().trimmed();
+  QVERIFY(line.startsWith("index "));
+  QVERIFY(line.endsWith(' ' + key(repo)));
+}
+
+void TestIndexService::cancelUnconfirmed() {
+  ScratchRepository repo;
+  QString name = uniqueName();
+  Server server(name);
+  server.start();
+  QTRY_VERIFY(server.isListening());
+
+  IndexService service(name, QString());
+  service.start(repo);
+  QTRY_COMPARE(server.lines().size(), 1);
+
+  // The server hasn't confirmed the request yet.
+  // The cancel is still sent. The client doesn't wait for it.
+  QVERIFY(!service.isIndexing(repo));
+
+  QSignalSpy finished(&service, &IndexService::finished);
+  QElapsedTimer timer;
+  timer.start();
+  service.cancel(repo);
+  QVERIFY(timer.elapsed() < 1000);
+  QVERIFY(finished.isEmpty());
+
+  // The client is told when the server is done.
+  QTRY_COMPARE(server.lines().value(1), "cancel " + key(repo));
+  QTRY_COMPARE(finished.size(), 1);
+  QCOMPARE(finished.first().first().toString(), key(repo));
+  QVERIFY(server.wait(kTimeout));
+}
+
+void TestIndexService::idleExit() {
+  QString name = uniqueName();
+  QProcess process;
+  process.start(INDEXER_EXECUTABLE, {"--server", name, "--idle", "200"});
+  QVERIFY(process.waitForStarted(kTimeout));
+
+  // The server stays up while it has a client.
+  {
+    Client client(name);
+    QVERIFY(client.isConnected());
+    qWait(500);
+    QCOMPARE(process.state(), QProcess::Running);
+    client.close();
+  }
+
+  // It exits when it's been idle for a while.
+  QVERIFY(process.waitForFinished(kTimeout));
+  QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+  QCOMPARE(process.exitCode(), 0);
+}
+
+void TestIndexService::sharedCancel() {
+  ScratchRepository repo;
+  for (int i = 0; i < 32; ++i)
+    QVERIFY(commit(repo, i).isValid());
+
+  QString name = uniqueName();
+  QProcess process;
+  process.start(INDEXER_EXECUTABLE,
+                {"--server", name, "--idle", "200", "--batch", "1"});
+  QVERIFY(process.waitForStarted(kTimeout));
+
+  Client a(name);
+  Client b(name);
+  QVERIFY(a.isConnected());
+  QVERIFY(b.isConnected());
+
+  QByteArray start = "start " + key(repo);
+  QByteArray done = "done " + key(repo);
+
+  a.send("index 0", repo);
+  b.send("index 0", repo);
+  QTRY_VERIFY(a.lines.contains(start));
+  QTRY_VERIFY(b.lines.contains(start));
+
+  // The job keeps going for the other client. The canceling
+  // client isn't told that it's done until the job ends.
+  a.send("cancel", repo);
+  qWait(200);
+  if (a.lines.contains(done))
+    QTRY_VERIFY(b.lines.contains(done));
+
+  // Both clients are told when the last one cancels.
+  if (!b.lines.contains(done))
+    b.send("cancel", repo);
+  QTRY_VERIFY(a.lines.contains(done));
+  QTRY_VERIFY(b.lines.contains(done));
+  QCOMPARE(a.lines.count(done), 1);
+
+  a.close();
+  b.close();
+  QVERIFY(process.waitForFinished(kTimeout));
+}
+
+TEST_MAIN(TestIndexService)
+
+#include "IndexService.moc"
@@ -0,0 +1,137 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/IdHash.h"
+#include "index/Index.h"
+#include <QSignalSpy>
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+using Commits = QList<git::Commit>;
+
+Index::PostingMap postings(const QByteArray &term, quint32 id) {
+  Index::Posting posting;
+  posting.id = id;
+  posting.field = Index::Message;
+  posting.positions.append(0);
+
+  Index::PostingMap map;
+  map[term].append(posting);
+  return map;
+}
+
+} // namespace
+
+class TestIndexSnapshot : public QObject {
+  Q_OBJECT
+
+private slots:
+  void swap();
+  void sweep();
+};
+
+void TestIndexSnapshot::swap() {
+  ScratchRepository repo;
+  git::Commit first = commitFile(repo, "file.txt", "1", "1");
+  git::Commit second = commitFile(repo, "file.txt", "2", "2");
+  QVERIFY(first.isValid() && second.isValid());
+
+  Index index(repo);
+  index.ids().append(first.id());
+  QVERIFY(index.write(postings("foo", 0)));
+
+  Index::SnapshotRef before = index.snapshot();
+  Index::Term foo(Index::Message, "foo");
+  QCOMPARE(before->postings(foo, true).size(), 1);
+  QCOMPARE(before->commits(before->postings(foo)), Commits({first}));
+
+  index.ids().append(second.id());
+  QVERIFY(index.write(postings("bar", 1)));
+
+  // The old snapshot still reads the data it was loaded with.
+  Index::Term bar(Index::Message, "bar");
+  QCOMPARE(before->ids().size(), 1);
+  QVERIFY(before->postings(bar).isEmpty());
+  QList<Index::Posting> old = before->postings(foo, true);
+  QCOMPARE(old.size(), 1);
+  QCOMPARE(old.first().positions, QVector<quint32>({0}));
+
+  Index::SnapshotRef after = index.snapshot();
+  QCOMPARE(after->ids().size(), 2);
+  QCOMPARE(after->commits(after->postings(bar)), Commits({second}));
+  QCOMPARE(index.commits("foo"), Commits({first}));
+
+  // A background reload swaps in a fresh snapshot.
+  QSignalSpy spy(&index, &Index::indexReset);
+  index.reload();
+  QVERIFY(spy.wait());
+  QVERIFY(index.snapshot() != after);
+  QCOMPARE(index.snapshot()->dict().size(), 2);
+}
+
+void TestIndexSnapshot::sweep() {
+  ScratchRepository repo;
+  Index index(repo);
+
+  // Index five commits with a common term and one unique term.
+  git::IdSet unreachable;
+  Index::PostingMap map;
+  for (int i = 0; i < 5; ++i) {
+    QByteArray content = QByteArray::number(i);
+    git::Commit commit = commitFile(repo, "file.txt", content, content);
+    QVERIFY(commit.isValid());
+    index.ids().append(commit.id());
+    map["common"].append(postings("common", i).value("common"));
+    if (i == 4)
+      unreachable.insert(commit.id());
+  }
+
+  map["unique"] = postings("unique", 4).value("unique");
+  QVERIFY(index.write(map));
+
+  // One deleted doc out of five is tombstoned but not dropped yet.
+  QVERIFY(index.sweep(unreachable, git::IdSet()));
+  QVERIFY(!index.sweep(unreachable, git::IdSet()));
+
+  Index::SnapshotRef snapshot = index.snapshot();
+  QCOMPARE(snapshot->ids().size(), 5);
+  QVERIFY(snapshot->isDeleted(4));
+  QCOMPARE(index.commits("common").size(), 4);
+  QVERIFY(index.commits("unique").isEmpty());
+
+  // Docs that become reachable again are restored.
+  QVERIFY(index.sweep(git::IdSet(), unreachable));
+  QCOMPARE(index.commits("unique").size(), 1);
+  QVERIFY(index.sweep(unreachable, git::IdSet()));
+
+  // Compaction drops the doc and terms that only it contained.
+  QVERIFY(index.compact());
+  snapshot = index.snapshot();
+  QCOMPARE(snapshot->ids().size(), 4);
+  QCOMPARE(snapshot->deleted().count(true), 0);
+  QCOMPARE(snapshot->dict().size(), 1);
+  QCOMPARE(index.commits("common").size(), 4);
+  QVERIFY(!index.compact());
+
+  // The frontier is stored until the index is removed.
+  Index::IdList tips = {snapshot->ids().last()};
+  QVERIFY(index.writeFrontier(tips, 4));
+
+  int count = 0;
+  QCOMPARE(index.frontier(&count), tips);
+  QCOMPARE(count, 4);
+  QVERIFY(index.remove());
+  QVERIFY(index.frontier().isEmpty());
+}
+
+TEST_MAIN(TestIndexSnapshot)
+
+#include "IndexSnapshot.moc"
@@ -0,0 +1,230 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "index/Index.h"
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+const int kTimeout = 30000;
+
+git::Commit commit(git::Repository repo, int i) {
+  QByteArray content = "line " + QByteArray::number(i) + '\n';
+  return commitFile(repo, "file.txt", content, QString("commit %1").arg(i));
+}
+
+QSet<QString> ids(const QList<git::Commit> &commits) {
+  QSet<QString> ids;
+  foreach (const git::Commit &commit, commits)
+    ids.insert(commit.id().toString());
+  return ids;
+}
+
+QSet<QString> deleted(const git::Repository &repo) {
+  QSet<QString> ids;
+  Index index(repo);
+  Index::SnapshotRef snapshot = index.snapshot();
+  for (int i = 0; i < snapshot->ids().size(); ++i) {
+    if (snapshot->isDeleted(i))
+      ids.insert(snapshot->ids().at(i).toString());
+  }
+
+  return ids;
+}
+
+// Run the indexer to completion and collect its progress.
+class Run {
+public:
+  Run(const git::Repository &repo) {
+    QProcess process;
+    process.start(INDEXER_EXECUTABLE, {"--verbose", repo.dir().path()});
+    if (!process.waitForFinished(kTimeout) ||
+        process.exitStatus() != QProcess::NormalExit ||
+        process.exitCode() != 0)
+      return;
+
+    mFinished = true;
+    QByteArrayList lines = process.readAllStandardOutput().split('\n');
+    foreach (const QByteArray &line, lines) {
+      QString text = QString::fromUtf8(line).section(" - ", 1);
+      if (text.startsWith("map: "))
+        mMapped.insert(text.mid(5));
+      else if (text == "sweep")
+        mSwept = true;
+    }
+  }
+
+  bool isFinished() const { return mFinished; }
+  bool isSwept() const { return mSwept; }
+  const QSet<QString> &mapped() const { return mMapped; }
+
+private:
+  bool mFinished = false;
+  bool mSwept = false;
+  QSet<QString> mMapped;
+};
+
+} // namespace
+
+class TestIndexer : public QObject {
+  Q_OBJECT
+
+private slots:
+  void resume();
+  void forcePush();
+  void staleFrontier();
+  void budget();
+};
+
+void TestIndexer::resume() {
+  ScratchRepository repo;
+  QList<git::Commit> commits;
+  for (int i = 0; i < 3; ++i)
+    commits.append(commit(repo, i));
+
+  Run first(repo);
+  QVERIFY(first.isFinished());
+  QCOMPARE(first.mapped(), ids(commits));
+  QCOMPARE(Index(repo).frontier(), Index::IdList({commits.last().id()}));
+
+  // Only the new commits are walked.
+  QList<git::Commit> added;
+  for (int i = 3; i < 5; ++i)
+    added.append(commit(repo, i));
+
+  Run second(repo);
+  QVERIFY(second.isFinished());
+  QCOMPARE(second.mapped(), ids(added));
+  QVERIFY(!second.isSwept());
+  QCOMPARE(Index(repo).frontier(), Index::IdList({added.last().id()}));
+  QCOMPARE(Index(repo).snapshot()->ids().size(), 5);
+
+  // Nothing is walked when nothing changed.
+  Run third(repo);
+  QVERIFY(third.isFinished());
+  QVERIFY(third.mapped().isEmpty());
+  QVERIFY(!third.isSwept());
+}
+
+void TestIndexer::forcePush() {
+  ScratchRepository repo;
+  QList<git::Commit> commits;
+  for (int i = 0; i < 4; ++i)
+    commits.append(commit(repo, i));
+
+  Run first(repo);
+  QVERIFY(first.isFinished());
+  QCOMPARE(first.mapped(), ids(commits));
+
+  // Rewrite the branch from the second commit.
+  QVERIFY(commits.at(1).reset(GIT_RESET_HARD, QStringList(), false));
+  git::Commit rewritten = commit(repo, 4);
+  QVERIFY(rewritten.isValid());
+
+  // The new commit is mapped and the commits that were
+  // dropped are found by walking back from the old frontier.
+  Run second(repo);
+  QVERIFY(second.isFinished());
+  QCOMPARE(second.mapped(), ids({rewritten}));
+  QVERIFY(second.isSwept());
+  QCOMPARE(deleted(repo), ids({commits.at(2), commits.at(3)}));
+  QCOMPARE(Index(repo).frontier(), Index::IdList({rewritten.id()}));
+
+  // Going back restores the dropped commits without mapping them again.
+  QVERIFY(commits.last().reset(GIT_RESET_HARD, QStringList(), false));
+
+  Run third(repo);
+  QVERIFY(third.isFinished());
+  QVERIFY(third.mapped().isEmpty());
+  QVERIFY(third.isSwept());
+  QCOMPARE(deleted(repo), ids({rewritten}));
+  QCOMPARE(Index(repo).frontier(), Index::IdList({commits.last().id()}));
+}
+
+void TestIndexer::staleFrontier() {
+  ScratchRepository repo;
+  QList<git::Commit> commits;
+  for (int i = 0; i < 3; ++i)
+    commits.append(commit(repo, i));
+
+  Run first(repo);
+  QVERIFY(first.isFinished());
+
+  git::Commit dropped = commit(repo, 3);
+  Run second(repo);
+  QVERIFY(second.isFinished());
+  QCOMPARE(second.mapped(), ids({dropped}));
+
+  int count = 0;
+  QCOMPARE(Index(repo).frontier(&count), Index::IdList({dropped.id()}));
+  QCOMPARE(count, 4);
+
+  // Pretend that the frontier wasn't advanced after the last batch.
+  QVERIFY(Index(repo).writeFrontier({commits.last().id()}, 3));
+
+  // Commits that were indexed after the frontier are swept
+  // even though walking back from the frontier doesn't find them.
+  QVERIFY(commits.last().reset(GIT_RESET_HARD, QStringList(), false));
+
+  Run third(repo);
+  QVERIFY(third.isFinished());
+  QVERIFY(third.mapped().isEmpty());
+  QVERIFY(third.isSwept());
+  QCOMPARE(deleted(repo), ids({dropped}));
+}
+
+void TestIndexer::budget() {
+  ScratchRepository repo;
+  QByteArray filler = QByteArray("filler\n").repeated(64);
+  QMap<QString, QByteArray> files = {{"a.txt", "early\n" + filler},
+                                     {"b.txt", "late\n"},
+                                     {"c.bin", QByteArray("\0binary", 7)}};
+
+  // Stop lexing after a few terms.
+  git::Config config = repo->appConfig();
+  config.setValue("index.termlimit", 8);
+
+  git::Commit terms = commitFiles(repo, files, "terms");
+  QVERIFY(terms.isValid());
+
+  Run first(repo);
+  QVERIFY(first.isFinished());
+  QCOMPARE(first.mapped(), ids({terms}));
+
+  // Content after the limit isn't indexed. Every file is still
+  // found by name, including binary files and files after the limit.
+  Index index(repo);
+  QCOMPARE(index.commits("added:early"), QList<git::Commit>({terms}));
+  QVERIFY(index.commits("added:late").isEmpty());
+  QCOMPARE(index.commits("file:b.txt"), QList<git::Commit>({terms}));
+  QCOMPARE(index.commits("file:c.bin"), QList<git::Commit>({terms}));
+  QCOMPARE(index.commits("path:c.bin"), QList<git::Commit>({terms}));
+
+  // Stop generating content after a few bytes.
+  QVERIFY(config.remove("index.termlimit"));
+  config.setValue("index.commitlimit", 32);
+
+  files = {{"a.txt", "sooner\n" + filler}, {"b.txt", "later\n"}};
+  git::Commit bytes = commitFiles(repo, files, "bytes");
+  QVERIFY(bytes.isValid());
+
+  Run second(repo);
+  QVERIFY(second.isFinished());
+  QCOMPARE(second.mapped(), ids({bytes}));
+
+  index.reset();
+  QCOMPARE(index.commits("added:sooner"), QList<git::Commit>({bytes}));
+  QVERIFY(index.commits("added:later").isEmpty());
+  QCOMPARE(index.commits("file:b.txt").size(), 2);
+}
+
+TEST_MAIN(TestIndexer)
+
+#include "Indexer.moc"
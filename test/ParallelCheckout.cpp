@@ -0,0 +1,220 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Index.h"
+#include "git/Tree.h"
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+class Callbacks : public git::Repository::CheckoutCallbacks {
+public:
+  Callbacks(int flags = GIT_CHECKOUT_NOTIFY_CONFLICT |
+                        GIT_CHECKOUT_NOTIFY_DIRTY)
+      : mFlags(flags) {}
+
+  int flags() const override { return mFlags; }
+
+  bool notify(char status, const QString &path) override {
+    paths[path] = status;
+    return true;
+  }
+
+  void progress(const QString &path, int current, int total) override {
+    // Record the files that were reported before the checkout finished.
+    if (current == total)
+      finished = paths;
+  }
+
+  QMap<QString, char> paths;
+  QMap<QString, char> finished;
+
+private:
+  int mFlags;
+};
+
+} // namespace
+
+class TestParallelCheckout : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void write();
+  void conflicts();
+  void force();
+  void restore();
+  void updated();
+
+private:
+  ScratchRepository *mRepo = nullptr;
+  git::Commit mBase;
+  git::Commit mTarget;
+};
+
+void TestParallelCheckout::init() {
+  mRepo = new ScratchRepository;
+  git::Repository repo = *mRepo;
+  QDir dir = repo.workdir();
+
+  QStringList files = {"a.txt", "keep.txt", "del.txt",
+                       "script.sh", "dir/f.txt", "x"};
+  foreach (const QString &file, files)
+    QVERIFY(writeFile(dir, file, file.toUtf8() + '\n'));
+
+  repo.index().setStaged(files, true);
+  mBase = repo.commit("base");
+  QVERIFY(mBase.isValid());
+
+  // Modify, delete and replace files with directories and vice versa.
+  QVERIFY(writeFile(dir, "a.txt", "changed\n"));
+  QVERIFY(dir.remove("del.txt"));
+  QVERIFY(dir.remove("dir/f.txt") && dir.rmdir("dir"));
+  QVERIFY(dir.remove("x"));
+  repo.index().setStaged({"a.txt", "del.txt", "dir/f.txt", "x"}, true);
+
+  QVERIFY(writeFile(dir, "dir", "dir\n"));
+  QVERIFY(writeFile(dir, "x/y.txt", "y\n"));
+  QStringList added = {"dir", "x/y.txt"};
+
+#ifdef Q_OS_UNIX
+  QFile script(dir.filePath("script.sh"));
+  QVERIFY(script.setPermissions(script.permissions() | QFile::ExeOwner));
+  QVERIFY(QFile::link("a.txt", dir.filePath("link")));
+  added << "script.sh" << "link";
+#endif
+
+  repo.index().setStaged(added, true);
+  mTarget = repo.commit("target");
+  QVERIFY(mTarget.isValid());
+
+  // Go back to the base commit.
+  QVERIFY(mBase.reset(GIT_RESET_HARD, QStringList(), false));
+  QCOMPARE(readFile(dir, "a.txt"), QByteArray("a.txt\n"));
+}
+
+void TestParallelCheckout::cleanup() {
+  delete mRepo;
+  mRepo = nullptr;
+}
+
+void TestParallelCheckout::write() {
+  git::Repository repo = *mRepo;
+  QDir dir = repo.workdir();
+
+  git::Diff diff = repo.checkoutDiff(mTarget);
+  QVERIFY(diff.isValid());
+  QVERIFY(!git::Repository::isParallelCheckout(diff));
+
+  Callbacks callbacks;
+  QVERIFY(repo.checkoutParallel(mTarget, diff, &callbacks));
+  QVERIFY(callbacks.paths.isEmpty());
+
+  QCOMPARE(readFile(dir, "a.txt"), QByteArray("changed\n"));
+  QCOMPARE(readFile(dir, "keep.txt"), QByteArray("keep.txt\n"));
+  QCOMPARE(readFile(dir, "dir"), QByteArray("dir\n"));
+  QCOMPARE(readFile(dir, "x/y.txt"), QByteArray("y\n"));
+  QVERIFY(!dir.exists("del.txt"));
+  QVERIFY(QFileInfo(dir.filePath("dir")).isFile());
+
+#ifdef Q_OS_UNIX
+  QFile script(dir.filePath("script.sh"));
+  QVERIFY(script.permissions() & QFile::ExeOwner);
+  QFileInfo link(dir.filePath("link"));
+  QVERIFY(link.isSymLink());
+  QCOMPARE(QFileInfo(link.symLinkTarget()).fileName(), QString("a.txt"));
+#endif
+
+  // The index matches the target and the workdir matches the index.
+  git::Index index = repo.index();
+  QCOMPARE(index.writeTree().id(), mTarget.tree().id());
+  QCOMPARE(repo.diffIndexToWorkdir(index).count(), 0);
+}
+
+void TestParallelCheckout::conflicts() {
+  git::Repository repo = *mRepo;
+  QDir dir = repo.workdir();
+
+  // Local changes to affected paths abort the checkout.
+  QVERIFY(writeFile(dir, "a.txt", "local\n"));
+
+  Callbacks callbacks;
+  git::Diff diff = repo.checkoutDiff(mTarget);
+  QVERIFY(!repo.checkoutParallel(mTarget, diff, &callbacks));
+  QCOMPARE(callbacks.paths.value("a.txt"), '!');
+  QCOMPARE(readFile(dir, "a.txt"), QByteArray("local\n"));
+  QCOMPARE(readFile(dir, "del.txt"), QByteArray("del.txt\n"));
+
+  // Other dirty files are reported and left alone.
+  QVERIFY(writeFile(dir, "a.txt", "a.txt\n"));
+  QVERIFY(writeFile(dir, "keep.txt", "local\n"));
+
+  callbacks.paths.clear();
+  QVERIFY(repo.checkoutParallel(mTarget, diff, &callbacks));
+  QCOMPARE(callbacks.paths.value("keep.txt"), 'M');
+  QCOMPARE(readFile(dir, "keep.txt"), QByteArray("local\n"));
+  QCOMPARE(readFile(dir, "a.txt"), QByteArray("changed\n"));
+}
+
+void TestParallelCheckout::force() {
+  git::Repository repo = *mRepo;
+  QDir dir = repo.workdir();
+
+  // Force overwrites affected paths and restores other dirty files.
+  QVERIFY(writeFile(dir, "a.txt", "local\n"));
+  QVERIFY(writeFile(dir, "keep.txt", "local\n"));
+
+  git::Diff diff = repo.checkoutDiff(mTarget);
+  QVERIFY(repo.checkoutParallel(mTarget, diff, nullptr, GIT_CHECKOUT_FORCE));
+  QCOMPARE(readFile(dir, "a.txt"), QByteArray("changed\n"));
+  QCOMPARE(readFile(dir, "keep.txt"), QByteArray("keep.txt\n"));
+
+  // A mixed reset finishes a hard reset.
+  QVERIFY(mTarget.reset(GIT_RESET_MIXED, QStringList(), false));
+  QCOMPARE(repo.diffTreeToIndex(mTarget.tree()).count(), 0);
+  QCOMPARE(repo.diffIndexToWorkdir().count(), 0);
+}
+
+void TestParallelCheckout::restore() {
+  git::Repository repo = *mRepo;
+  QDir dir = repo.workdir();
+
+  // An untracked file keeps the directory in the way of a new file.
+  QVERIFY(writeFile(dir, "dir/extra.txt", "extra\n"));
+
+  git::Diff diff = repo.checkoutDiff(mTarget);
+  QVERIFY(!repo.checkoutParallel(mTarget, diff, nullptr, GIT_CHECKOUT_FORCE));
+  QVERIFY(git::Repository::lastError().contains("'dir'"));
+
+  // Paths that were already written are back at the base commit.
+  QCOMPARE(readFile(dir, "a.txt"), QByteArray("a.txt\n"));
+  QCOMPARE(readFile(dir, "del.txt"), QByteArray("del.txt\n"));
+  QCOMPARE(readFile(dir, "dir/f.txt"), QByteArray("dir/f.txt\n"));
+  QCOMPARE(repo.index().writeTree().id(), mBase.tree().id());
+}
+
+void TestParallelCheckout::updated() {
+  git::Repository repo = *mRepo;
+
+  // Updated files are reported before the last progress call.
+  Callbacks callbacks(GIT_CHECKOUT_NOTIFY_UPDATED);
+  git::Diff diff = repo.checkoutDiff(mTarget);
+  QVERIFY(repo.checkoutParallel(mTarget, diff, &callbacks));
+  QCOMPARE(callbacks.paths.size(), diff.count());
+  QCOMPARE(callbacks.finished, callbacks.paths);
+  QCOMPARE(callbacks.paths.value("a.txt"), 'M');
+  QCOMPARE(callbacks.paths.value("del.txt"), 'D');
+}
+
+TEST_MAIN(TestParallelCheckout)
+
+#include "ParallelCheckout.moc"
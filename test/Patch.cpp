@@ -0,0 +1,98 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Patch.h"
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+QByteArrayList lines(const git::Patch::ConflictHunk &hunk) {
+  QByteArrayList lines;
+  for (int i = 0; i < hunk.offsets.size() - 1; ++i) {
+    int offset = hunk.offsets.at(i);
+    lines.append(hunk.text.mid(offset, hunk.offsets.at(i + 1) - offset));
+  }
+
+  return lines;
+}
+
+} // namespace
+
+class TestPatch : public QObject {
+  Q_OBJECT
+
+private slots:
+  void conflicts();
+};
+
+void TestPatch::conflicts() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QString path = dir.filePath("file.txt");
+  QVERIFY(writeFile(dir.path(), "file.txt", "a\n"
+                                            "b\n"
+                                            "<<<<<<< ours\n"
+                                            "x\n"
+                                            "=======\n"
+                                            "y\n"
+                                            ">>>>>>> theirs\n"
+                                            "c\n"
+                                            "d\n"
+                                            "e\n"
+                                            "<<<<<<< ours\n"
+                                            "z\n"
+                                            "=======\n"
+                                            ">>>>>>> theirs"));
+
+  QList<git::Patch::ConflictHunk> hunks = git::Patch::conflicts(path, 1);
+  QCOMPARE(hunks.size(), 2);
+
+  // Regions include one line of context on either side.
+  const git::Patch::ConflictHunk &first = hunks.at(0);
+  QCOMPARE(first.line, 1);
+  QCOMPARE(first.min, 2);
+  QCOMPARE(first.mid, 4);
+  QCOMPARE(first.max, 6);
+  QCOMPARE(lines(first),
+           QByteArrayList({"b\n", "<<<<<<< ours\n", "x\n", "=======\n", "y\n",
+                           ">>>>>>> theirs\n", "c\n"}));
+
+  // The last line doesn't need a newline.
+  const git::Patch::ConflictHunk &second = hunks.at(1);
+  QCOMPARE(second.line, 9);
+  QCOMPARE(second.min, 10);
+  QCOMPARE(second.mid, 12);
+  QCOMPARE(second.max, 13);
+  QCOMPARE(lines(second), QByteArrayList({"e\n", "<<<<<<< ours\n", "z\n",
+                                          "=======\n", ">>>>>>> theirs"}));
+
+  // Context is clamped at the start of the file.
+  QCOMPARE(git::Patch::conflicts(path, 3).first().line, 0);
+
+  // Changes to the file are picked up instead of the cached result.
+  QVERIFY(writeFile(dir.path(), "file.txt", "<<<<<<< ours\n"
+                                            "=======\n"
+                                            ">>>>>>> theirs\n"
+                                            "<<<<<<< unterminated\n"));
+
+  hunks = git::Patch::conflicts(path, 1);
+  QCOMPARE(hunks.size(), 1);
+  QCOMPARE(hunks.first().line, 0);
+  QCOMPARE(hunks.first().max, 2);
+  QCOMPARE(lines(hunks.first()).last(), QByteArray("<<<<<<< unterminated\n"));
+
+  // Missing files have no conflicts.
+  QVERIFY(git::Patch::conflicts(dir.filePath("missing"), 1).isEmpty());
+}
+
+TEST_MAIN(TestPatch)
+
+#include "Patch.moc"
@@ -0,0 +1,133 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Index.h"
+#include "ui/RangeDiff.h"
+
+using namespace Test;
+using namespace QTest;
+
+class TestRangeDiff : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void key();
+  void diff();
+  void request();
+  void latest();
+  void cancel();
+
+private:
+  ScratchRepository *mRepo = nullptr;
+  QList<git::Commit> mCommits;
+};
+
+void TestRangeDiff::initTestCase() {
+  qRegisterMetaType<git::Diff>();
+
+  mRepo = new ScratchRepository;
+  git::Repository repo = *mRepo;
+  QDir dir = repo.workdir();
+
+  QByteArray content;
+  for (int i = 0; i < 20; ++i)
+    content += QByteArray::number(i) + " some line of text\n";
+
+  mCommits.prepend(
+      commitFiles(repo, {{"a.txt", content}, {"b.txt", "b\n"}}, "base"));
+  mCommits.prepend(commitFile(repo, "b.txt", "b \nc\n", "modify"));
+
+  QVERIFY(dir.rename("a.txt", "moved.txt"));
+  repo.index().setStaged({"a.txt", "moved.txt"}, true);
+  mCommits.prepend(repo.commit("rename"));
+
+  foreach (const git::Commit &commit, mCommits)
+    QVERIFY(commit.isValid());
+}
+
+void TestRangeDiff::cleanupTestCase() {
+  mCommits.clear();
+  delete mRepo;
+  mRepo = nullptr;
+}
+
+void TestRangeDiff::key() {
+  // A commit and its parent aren't a range.
+  QVERIFY(RangeDiff::key(mCommits.at(0), mCommits.at(1), false).isEmpty());
+  QVERIFY(RangeDiff::key(mCommits.at(0), git::Commit(), false).isEmpty());
+
+  QString key = RangeDiff::key(mCommits.at(0), mCommits.at(2), false);
+  QVERIFY(!key.isEmpty());
+  QCOMPARE(RangeDiff::key(mCommits.at(0), mCommits.at(2), false), key);
+  QVERIFY(RangeDiff::key(mCommits.at(0), mCommits.at(2), true) != key);
+}
+
+void TestRangeDiff::diff() {
+  RangeDiff diffs;
+  QString key = RangeDiff::key(mCommits.at(0), mCommits.at(2), false);
+  QVERIFY(!diffs.cached(key).isValid());
+
+  // The range diff detects renames and is cached.
+  git::Diff diff = diffs.diff(mCommits.at(0), mCommits.at(2), false);
+  QCOMPARE(diff.count(), 2);
+  int index = diff.indexOf("moved.txt");
+  QVERIFY(index >= 0);
+  QCOMPARE(diff.status(index), GIT_DELTA_RENAMED);
+  QCOMPARE(diffs.cached(key).count(), 2);
+}
+
+void TestRangeDiff::request() {
+  RangeDiff diffs;
+  QSignalSpy spy(&diffs, &RangeDiff::finished);
+  diffs.request(mCommits.at(0), mCommits.at(2), true);
+  QVERIFY(spy.wait());
+  QCOMPARE(spy.count(), 1);
+
+  git::Diff diff = spy.at(0).at(0).value<git::Diff>();
+  QCOMPARE(diff.status(diff.indexOf("moved.txt")), GIT_DELTA_RENAMED);
+
+  QString key = RangeDiff::key(mCommits.at(0), mCommits.at(2), true);
+  QVERIFY(diffs.cached(key).isValid());
+  QVERIFY(!diffs.cached(RangeDiff::key(mCommits.at(0), mCommits.at(2), false))
+               .isValid());
+}
+
+void TestRangeDiff::latest() {
+  RangeDiff diffs;
+  QSignalSpy spy(&diffs, &RangeDiff::finished);
+  diffs.request(mCommits.at(0), mCommits.at(2), false);
+  diffs.request(mCommits.at(0), mCommits.at(2), true);
+  QVERIFY(spy.wait());
+  QTest::qWait(100);
+
+  // Only the latest request is reported but both results are cached.
+  QCOMPARE(spy.count(), 1);
+  QVERIFY(diffs.cached(RangeDiff::key(mCommits.at(0), mCommits.at(2), false))
+              .isValid());
+  QVERIFY(diffs.cached(RangeDiff::key(mCommits.at(0), mCommits.at(2), true))
+              .isValid());
+}
+
+void TestRangeDiff::cancel() {
+  RangeDiff diffs;
+  QSignalSpy spy(&diffs, &RangeDiff::finished);
+  diffs.request(mCommits.at(0), mCommits.at(2), false);
+  diffs.cancel();
+  QVERIFY(!spy.wait(500));
+
+  // The result is still cached.
+  QString key = RangeDiff::key(mCommits.at(0), mCommits.at(2), false);
+  QVERIFY(diffs.cached(key).isValid());
+}
+
+TEST_MAIN(TestRangeDiff)
+
+#include "RangeDiff.moc"
@@ -0,0 +1,91 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/RefSnapshot.h"
+#include "git/TagRef.h"
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+QList<QByteArray> names(const git::RefSnapshot::Range &range) {
+  QList<QByteArray> names;
+  for (const git::RefSnapshot::Entry &entry : range)
+    names.append(entry.name);
+  return names;
+}
+
+} // namespace
+
+class TestRefSnapshot : public QObject {
+  Q_OBJECT
+
+private slots:
+  void read();
+};
+
+void TestRefSnapshot::read() {
+  ScratchRepository repo;
+  git::Commit first = commitFile(repo, "file.txt", "1", "1");
+  git::Commit second = commitFile(repo, "file.txt", "2", "2");
+  QVERIFY(first.isValid() && second.isValid());
+  QVERIFY(repo->createTag(first, "annotated", "message").isValid());
+
+  // Loose refs take precedence over packed refs.
+  QByteArray id1 = first.id().toString().toUtf8();
+  QByteArray id2 = second.id().toString().toUtf8();
+  QDir dir = repo->dir();
+  QVERIFY(writeFile(dir, "packed-refs",
+                    "# pack-refs with: peeled fully-peeled sorted \n" + id1 +
+                        " refs/heads/packed\n" + id1 +
+                        " refs/remotes/origin/a\n" + id2 +
+                        " refs/remotes/origin/b\n" + id1 + " refs/tags/p\n"));
+  QVERIFY(writeFile(dir, "refs/remotes/origin/a", id2 + "\n"));
+  QVERIFY(writeFile(dir, "refs/remotes/origin/HEAD",
+                    "ref: refs/remotes/origin/b\n"));
+
+  git::RefSnapshot snapshot = repo->refSnapshot();
+  QVERIFY(snapshot.isValid());
+  QVERIFY(snapshot.isCurrent());
+
+  git::RefSnapshot::Range remotes = snapshot.entries("refs/remotes/origin/");
+  QCOMPARE(names(remotes),
+           QList<QByteArray>({"refs/remotes/origin/HEAD",
+                              "refs/remotes/origin/a",
+                              "refs/remotes/origin/b"}));
+  for (const git::RefSnapshot::Entry &entry : remotes)
+    QCOMPARE(entry.commit, second.id());
+
+  // Annotated tags peel to the tagged commit.
+  git::RefSnapshot::Range tags = snapshot.entries("refs/tags/");
+  QCOMPARE(names(tags),
+           QList<QByteArray>({"refs/tags/annotated", "refs/tags/p"}));
+  QCOMPARE(tags.begin()->commit, first.id());
+  QVERIFY(tags.begin()->id != first.id());
+
+  QCOMPARE(snapshot.entries(first.id()).size(), 3);
+  QVERIFY(snapshot.contains("refs/heads/packed", first.id()));
+  QVERIFY(!snapshot.contains("refs/heads/packed", second.id()));
+  QVERIFY(snapshot.entries("refs/notes/").size() == 0);
+
+  QCOMPARE(git::RefSnapshot::shorthand("refs/remotes/origin/a"),
+           QString("origin/a"));
+  QCOMPARE(git::RefSnapshot::shorthand("refs/stash"), QString("stash"));
+
+  // Commits resolve their references through the snapshot.
+  QCOMPARE(first.refs().size(), 3);
+
+  // Changes made through the repository are picked up.
+  QVERIFY(repo->createBranch("new", first).isValid());
+  QCOMPARE(repo->refSnapshot().entries(first.id()).size(), 4);
+}
+
+TEST_MAIN(TestRefSnapshot)
+
+#include "RefSnapshot.moc"
@@ -0,0 +1,133 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Branch.h"
+#include "git/ReferenceCatalog.h"
+#include "git/TagRef.h"
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+git::Commit commit(git::Repository repo, int day) {
+  QDateTime date(QDate(2020, 1, day), QTime(12, 0), Qt::UTC);
+  git::Signature signature = repo.signature("Jane", "jane@x.com", date);
+  QByteArray content = QByteArray::number(day);
+  return commitFile(repo, "file.txt", content, content, signature);
+}
+
+QStringList names(git::ReferenceCatalog *catalog,
+                  git::ReferenceCatalog::Kind kind) {
+  QStringList names;
+  foreach (const git::ReferenceCatalog::Entry &entry, catalog->entries(kind))
+    names.append(entry.name);
+  return names;
+}
+
+} // namespace
+
+class TestReferenceCatalog : public QObject {
+  Q_OBJECT
+
+private slots:
+  void entries();
+  void external();
+};
+
+void TestReferenceCatalog::entries() {
+  ScratchRepository repo;
+  git::Commit first = commit(repo, 1);
+  QVERIFY(first.isValid());
+  QVERIFY(repo->createBranch("old", first).isValid());
+  QVERIFY(repo->createTag(first, "v1").isValid());
+
+  git::Commit second = commit(repo, 2);
+  QVERIFY(second.isValid());
+  QVERIFY(repo->createTag(second, "v2").isValid());
+
+  // The first load doesn't block.
+  git::ReferenceCatalog *catalog = repo->referenceCatalog();
+  QCOMPARE(catalog, repo->referenceCatalog());
+  QVERIFY(!catalog->isLoaded());
+  QVERIFY(catalog->entries(git::ReferenceCatalog::Tag).isEmpty());
+
+  QSignalSpy loaded(catalog, &git::ReferenceCatalog::updated);
+  QVERIFY(loaded.wait());
+  QVERIFY(catalog->isLoaded());
+
+  // Entries are sorted from the newest commit to the oldest.
+
+  QString head = repo->head().name();
+  QCOMPARE(names(catalog, git::ReferenceCatalog::LocalBranch),
+           QStringList({head, "old"}));
+  QCOMPARE(names(catalog, git::ReferenceCatalog::Tag),
+           QStringList({"v2", "v1"}));
+  QVERIFY(names(catalog, git::ReferenceCatalog::RemoteBranch).isEmpty());
+
+  const git::ReferenceCatalog::Entry &entry =
+      catalog->entries(git::ReferenceCatalog::Tag).first();
+  QCOMPARE(entry.target, second.id());
+  QCOMPARE(git::ReferenceCatalog::qualifiedName(git::ReferenceCatalog::Tag,
+                                                entry.name),
+           QString("refs/tags/v2"));
+
+  // Changes are applied without reloading.
+  QSignalSpy spy(catalog, &git::ReferenceCatalog::updated);
+  git::Branch branch = repo->createBranch("new", second);
+  QVERIFY(branch.isValid());
+  QVERIFY(spy.count() > 0);
+  QCOMPARE(names(catalog, git::ReferenceCatalog::LocalBranch),
+           QStringList({head, "new", "old"}));
+
+  QVERIFY(branch.rename("renamed").isValid());
+  QCOMPARE(names(catalog, git::ReferenceCatalog::LocalBranch),
+           QStringList({head, "renamed", "old"}));
+
+  repo->lookupBranch("old", GIT_BRANCH_LOCAL).remove();
+  QCOMPARE(names(catalog, git::ReferenceCatalog::LocalBranch),
+           QStringList({head, "renamed"}));
+
+  QVERIFY(repo->lookupTag("v1").remove());
+  QCOMPARE(names(catalog, git::ReferenceCatalog::Tag), QStringList({"v2"}));
+}
+
+void TestReferenceCatalog::external() {
+  ScratchRepository repo;
+  git::Commit first = commit(repo, 1);
+  QVERIFY(first.isValid());
+
+  git::ReferenceCatalog *catalog = repo->referenceCatalog();
+  QSignalSpy spy(catalog, &git::ReferenceCatalog::updated);
+  QVERIFY(spy.wait());
+  QString head = repo->head().name();
+  QCOMPARE(names(catalog, git::ReferenceCatalog::LocalBranch),
+           QStringList({head}));
+
+  // Write a reference behind the notifier's back.
+  QByteArray id = first.id().toString().toUtf8() + '\n';
+  QVERIFY(writeFile(repo->dir(), "refs/heads/external", id));
+
+  // Both point to the same commit, so they're sorted by name.
+  spy.clear();
+  catalog->update();
+  QVERIFY(spy.wait());
+  QCOMPARE(names(catalog, git::ReferenceCatalog::LocalBranch),
+           QStringList({"external", head}));
+
+  // Nothing is reported if nothing changed.
+  spy.clear();
+  catalog->update();
+  QVERIFY(!spy.wait(500));
+  QCOMPARE(names(catalog, git::ReferenceCatalog::LocalBranch),
+           QStringList({"external", head}));
+}
+
+TEST_MAIN(TestReferenceCatalog)
+
+#include "ReferenceCatalog.moc"
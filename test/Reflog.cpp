@@ -0,0 +1,139 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Reflog.h"
+#include "ui/CommitList.h"
+#include "ui/MainWindow.h"
+#include "ui/RepoView.h"
+
+using namespace Test;
+using namespace QTest;
+
+class TestReflog : public QObject {
+  Q_OBJECT
+
+private slots:
+  void head();
+  void stash();
+  void model();
+};
+
+void TestReflog::head() {
+  ScratchRepository repo;
+  QVERIFY(!repo->head().reflog().isValid());
+
+  QList<git::Id> ids;
+  for (int i = 0; i < 3; ++i) {
+    QByteArray content = QByteArray::number(i);
+    git::Commit commit = commitFile(repo, "file.txt", content, content);
+    QVERIFY(commit.isValid());
+    ids.prepend(commit.id());
+  }
+
+  git::Reflog reflog = repo->head().reflog();
+  QVERIFY(reflog.isValid());
+  QCOMPARE(reflog.count(), 3);
+  for (int i = 0; i < ids.size(); ++i)
+    QCOMPARE(reflog.id(i), ids.at(i));
+
+  QCOMPARE(reflog.previousId(0), ids.at(1));
+  QVERIFY(!reflog.id(3).isValid());
+  QVERIFY(reflog.message(3).isEmpty());
+
+  QString name = repo->head().qualifiedName();
+  QCOMPARE(repo->reflog(name).count(), 3);
+  QVERIFY(!repo->reflog("refs/heads/missing").count());
+}
+
+void TestReflog::stash() {
+  ScratchRepository repo;
+  QCOMPARE(repo->stashCount(), 0);
+  QVERIFY(!repo->lookupStash(0).isValid());
+
+  QVERIFY(commitFile(repo, "file.txt", "base", "base").isValid());
+
+  QList<git::Commit> stashes;
+  for (int i = 0; i < 3; ++i) {
+    QVERIFY(writeFile(repo->workdir(), "file.txt", QByteArray::number(i)));
+    git::Commit stash = repo->stash(QString::number(i));
+    QVERIFY(stash.isValid());
+    stashes.prepend(stash);
+  }
+
+  // Entries are ordered from newest to oldest, like stash@{n}.
+  QCOMPARE(repo->stashCount(), 3);
+  for (int i = 0; i < stashes.size(); ++i)
+    QCOMPARE(repo->lookupStash(i), stashes.at(i));
+
+  git::Reflog reflog = repo->stashRef().reflog();
+  QCOMPARE(reflog.count(), 3);
+  QVERIFY(reflog.message(0).contains("2"));
+
+  QVERIFY(repo->dropStash(1));
+  QCOMPARE(repo->stashCount(), 2);
+  QCOMPARE(repo->lookupStash(1), stashes.last());
+}
+
+void TestReflog::model() {
+  ScratchRepository repo;
+
+  // Write more entries than fit in one page.
+  QList<git::Commit> commits;
+  for (int i = 0; i < 70; ++i) {
+    QByteArray content = QByteArray::number(i);
+    commits.prepend(commitFile(repo, "file.txt", content, content));
+    QVERIFY(commits.first().isValid());
+  }
+
+  QList<git::Commit> stashes;
+  for (int i = 0; i < 2; ++i) {
+    QByteArray content = "stash" + QByteArray::number(i);
+    QVERIFY(writeFile(repo->workdir(), "file.txt", content));
+    stashes.prepend(repo->stash(QString::number(i)));
+    QVERIFY(stashes.first().isValid());
+  }
+
+  MainWindow window(repo);
+  RepoView *view = window.currentView();
+  CommitList *list = view->findChild<CommitList *>();
+  QVERIFY(list);
+
+  // Commits are looked up a page at a time.
+  view->showReflog(repo->head());
+  QAbstractItemModel *model = list->model();
+  QCOMPARE(model->rowCount(), 64);
+  QVERIFY(model->canFetchMore(QModelIndex()));
+
+  model->fetchMore(QModelIndex());
+  QCOMPARE(model->rowCount(), 70);
+  QVERIFY(!model->canFetchMore(QModelIndex()));
+
+  for (int i = 0; i < commits.size(); ++i) {
+    QModelIndex index = model->index(i, 0);
+    QCOMPARE(index.data(CommitList::CommitRole).value<git::Commit>(),
+             commits.at(i));
+    QVERIFY(!index.data(CommitList::StashRole).isValid());
+  }
+
+  // Only rows of the stash reflog have stash actions.
+  view->showReflog(repo->stashRef());
+  QCOMPARE(model->rowCount(), 2);
+  for (int i = 0; i < stashes.size(); ++i) {
+    QModelIndex index = model->index(i, 0);
+    QCOMPARE(index.data(CommitList::CommitRole).value<git::Commit>(),
+             stashes.at(i));
+    QCOMPARE(index.data(CommitList::StashRole).toInt(), i);
+  }
+
+  view->showReflog(repo->head());
+  QVERIFY(!model->index(0, 0).data(CommitList::StashRole).isValid());
+}
+
+TEST_MAIN(TestReflog)
+
+#include "Reflog.moc"
@@ -0,0 +1,124 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "index/Statistics.h"
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+bool commit(git::Repository repo, const QString &name,
+            const QByteArray &content, const QString &author,
+            const QString &email) {
+  git::Signature signature = repo.signature(author, email);
+  return commitFile(repo, name, content, name, signature).isValid();
+}
+
+} // namespace
+
+class TestStatistics : public QObject {
+  Q_OBJECT
+
+private slots:
+  void update();
+  void rewrite();
+  void readWrite();
+};
+
+void TestStatistics::update() {
+  ScratchRepository repo;
+  QVERIFY(commit(repo, "src/ui/a.txt", "1\n2\n3\n", "Jane", "jane@x.com"));
+  QVERIFY(commit(repo, "src/ui/a.txt", "1\n3\n", "Jane", "Jane@X.com"));
+  QVERIFY(commit(repo, "src/b.txt", "1\n", "John", "john@x.com"));
+
+  Statistics statistics(repo);
+  QSignalSpy spy(&statistics, &Statistics::updated);
+  statistics.update();
+  QVERIFY(spy.wait());
+
+  QList<Statistics::Author> authors = statistics.authors();
+  QCOMPARE(authors.size(), 2);
+  QCOMPARE(authors.at(0).email, QString("jane@x.com"));
+  QCOMPARE(authors.at(0).counts.commits, 2u);
+  QCOMPARE(authors.at(0).counts.additions, 3u);
+  QCOMPARE(authors.at(0).counts.deletions, 1u);
+  QCOMPARE(authors.at(1).name, QString("John"));
+
+  authors = statistics.authors("src/ui/");
+  QCOMPARE(authors.size(), 1);
+  QCOMPARE(authors.at(0).name, QString("Jane"));
+
+  QCOMPARE(statistics.authors("src").size(), 2);
+  QVERIFY(statistics.authors("doc").isEmpty());
+
+  // Only new commits are counted.
+  QVERIFY(commit(repo, "src/ui/c.txt", "1\n2\n", "John", "john@x.com"));
+  statistics.update();
+  QVERIFY(spy.wait());
+
+  authors = statistics.authors("src/ui", 1);
+  QCOMPARE(authors.size(), 1);
+  QCOMPARE(authors.at(0).counts.commits, 2u);
+
+  QMap<QDate, Statistics::Counts> timeline = statistics.timeline();
+  QCOMPARE(timeline.size(), 1);
+  QCOMPARE(timeline.first().commits, 4u);
+  QCOMPARE(statistics.timeline("john@x.com").first().commits, 2u);
+}
+
+void TestStatistics::rewrite() {
+  ScratchRepository repo;
+  QVERIFY(commit(repo, "a.txt", "1\n", "Jane", "jane@x.com"));
+  git::Commit first = repo->head().target();
+  QVERIFY(commit(repo, "b.txt", "1\n", "John", "john@x.com"));
+  QVERIFY(commit(repo, "c.txt", "1\n", "John", "john@x.com"));
+
+  Statistics statistics(repo);
+  QSignalSpy spy(&statistics, &Statistics::updated);
+  statistics.update();
+  QVERIFY(spy.wait());
+  QCOMPARE(statistics.timeline().first().commits, 3u);
+
+  // Commits that were dropped aren't counted anymore.
+  QVERIFY(first.reset(GIT_RESET_HARD, QStringList(), false));
+  QVERIFY(commit(repo, "d.txt", "1\n", "Jane", "jane@x.com"));
+  statistics.update();
+  QVERIFY(spy.wait());
+
+  QList<Statistics::Author> authors = statistics.authors();
+  QCOMPARE(authors.size(), 1);
+  QCOMPARE(authors.at(0).email, QString("jane@x.com"));
+  QCOMPARE(authors.at(0).counts.commits, 2u);
+  QCOMPARE(statistics.timeline().first().commits, 2u);
+}
+
+void TestStatistics::readWrite() {
+  Statistics::Data data;
+  data.tips.append(git::Id(QByteArray(20, 'a')));
+  data.names.insert("jane@x.com", "Jane");
+  data.paths[QString()]["jane@x.com"].commits = 3;
+  data.paths["src"]["jane@x.com"].additions = 300;
+  data.months[24000]["jane@x.com"].deletions = 70000;
+
+  QTemporaryDir dir;
+  QString file = dir.filePath("stats");
+  QVERIFY(Statistics::write(file, data));
+
+  Statistics::Data copy = Statistics::read(file);
+  QCOMPARE(copy.tips, data.tips);
+  QCOMPARE(copy.names, data.names);
+  QCOMPARE(copy.paths.size(), 2);
+  QCOMPARE(copy.paths.value(QString()).value("jane@x.com").commits, 3u);
+  QCOMPARE(copy.paths.value("src").value("jane@x.com").additions, 300u);
+  QCOMPARE(copy.months.value(24000).value("jane@x.com").deletions, 70000u);
+}
+
+TEST_MAIN(TestStatistics)
+
+#include "Statistics.moc"
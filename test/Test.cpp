@@ -10,6 +10,7 @@
 #include "Test.h"
 #include "Debug.h"
 #include "git/Config.h"
+#include "git/Index.h"
 #include "ui/RepoView.h"
 // #include <JlCompress.h>
 #include <exception>
@@ -150,6 +151,65 @@ void initRepo(git::Repository &repo) {
   repo.gitConfig().setValue("user.email", QString("test@user"));
 }
 
+bool writeFile(const QDir &dir, const QString &name,
+               const QByteArray &content) {
+  if (!dir.mkpath(QFileInfo(name).path()))
+    return false;
+
+  QFile file(dir.filePath(name));
+  if (!file.open(QFile::WriteOnly))
+    return false;
+
+  return file.write(content) == content.size();
+}
+
+QByteArray readFile(const QDir &dir, const QString &name) {
+  QFile file(dir.filePath(name));
+  return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+static bool stageFiles(git::Repository repo,
+                       const QMap<QString, QByteArray> &files) {
+  QDir dir = repo.workdir();
+  foreach (const QString &name, files.keys()) {
+    if (!writeFile(dir, name, files.value(name)))
+      return false;
+  }
+
+  repo.index().setStaged(files.keys(), true);
+  return true;
+}
+
+git::Commit commitFiles(git::Repository repo,
+                        const QMap<QString, QByteArray> &files,
+                        const QString &message) {
+  if (!stageFiles(repo, files))
+    return git::Commit();
+
+  return repo.commit(message);
+}
+
+git::Commit commitFiles(git::Repository repo,
+                        const QMap<QString, QByteArray> &files,
+                        const QString &message,
+                        const git::Signature &signature) {
+  if (!stageFiles(repo, files))
+    return git::Commit();
+
+  return repo.commit(signature, signature, message);
+}
+
+git::Commit commitFile(git::Repository repo, const QString &name,
+                       const QByteArray &content, const QString &message) {
+  return commitFiles(repo, {{name, content}}, message);
+}
+
+git::Commit commitFile(git::Repository repo, const QString &name,
+                       const QByteArray &content, const QString &message,
+                       const git::Signature &signature) {
+  return commitFiles(repo, {{name, content}}, message, signature);
+}
+
 ScratchRepository::ScratchRepository(bool autoRemove) {
   mDir.setAutoRemove(autoRemove);
   mRepo = git::Repository::init(mDir.path());
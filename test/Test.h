@@ -11,7 +11,9 @@
 #define TEST_H
 
 #include "app/Application.h"
+#include "git/Commit.h"
 #include "git/Repository.h"
+#include "git/Signature.h"
 #include <iostream>
 #include <QTemporaryDir>
 #include <QtTest/QtTest>
@@ -59,6 +61,25 @@ void fetch(RepoView *repoView, git::Remote remote);
 QString extractRepository(const QString &filename, bool useTempDir);
 void initRepo(git::Repository &repo);
 
+// Write a file relative to the directory. Parent directories are created.
+bool writeFile(const QDir &dir, const QString &name, const QByteArray &content);
+QByteArray readFile(const QDir &dir, const QString &name);
+
+// Write files to the working directory, stage them and commit them.
+// Returns an invalid commit on failure.
+git::Commit commitFiles(git::Repository repo,
+                        const QMap<QString, QByteArray> &files,
+                        const QString &message);
+git::Commit commitFiles(git::Repository repo,
+                        const QMap<QString, QByteArray> &files,
+                        const QString &message,
+                        const git::Signature &signature);
+git::Commit commitFile(git::Repository repo, const QString &name,
+                       const QByteArray &content, const QString &message);
+git::Commit commitFile(git::Repository repo, const QString &name,
+                       const QByteArray &content, const QString &message,
+                       const git::Signature &signature);
+
 Application createApp(int &argc, char *argv[]);
 
 template <typename T> int runTest(int argc, char *argv[]) {
@@ -7,6 +7,7 @@
 #include "ui/FileContextMenu.h"
 #include "conf/Settings.h"
 
+#include <QSignalSpy>
 #include <QTextEdit>
 
 using namespace Test;
@@ -45,6 +46,8 @@ private slots:
   void fileMergeCrash();
   void dirtySubmoduleAndStagedSubmodule();
   void conflictedAndStagedFile();
+  void reconcileStatus();
+  void reconcileRename();
 
 private:
 };
@@ -352,6 +355,96 @@ void TestTreeView::conflictedAndStagedFile() {
   }
 }
 
+void TestTreeView::reconcileStatus() {
+  ScratchRepository repo;
+  QDir dir = repo->workdir();
+  QVERIFY(dir.mkpath("folder"));
+
+  auto write = [&dir](const QString &name) {
+    QFile file(dir.filePath(name));
+    QVERIFY(file.open(QFile::WriteOnly));
+    QTextStream(&file) << name << Qt::endl;
+  };
+
+  write("folder/a.txt");
+  write("folder/b.txt");
+
+  DiffTreeModel model(repo);
+  model.enableListView(false);
+  QVERIFY(!model.setDiff(repo->status(repo->index(), nullptr)));
+
+  QModelIndex folder = model.index(0, 0);
+  QCOMPARE(model.rowCount(folder), 2);
+  void *a = model.index("folder/a.txt").internalPointer();
+
+  QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+  QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+  QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+
+  // Replace b.txt with c.txt.
+  QVERIFY(dir.remove("folder/b.txt"));
+  write("folder/c.txt");
+  QVERIFY(model.setDiff(repo->status(repo->index(), nullptr)));
+
+  QCOMPARE(reset.count(), 0);
+  QCOMPARE(inserted.count(), 1);
+  QCOMPARE(removed.count(), 1);
+
+  // The unchanged file keeps its node.
+  QModelIndex index = model.index("folder/a.txt");
+  QCOMPARE(index.internalPointer(), a);
+  QVERIFY(!model.index("folder/b.txt").isValid());
+  QVERIFY(model.index("folder/c.txt").isValid());
+  QCOMPARE(model.rowCount(model.index(0, 0)), 2);
+  QCOMPARE(model.patchIndices(model.index(0, 0)), QList<int>({0, 1}));
+}
+
+void TestTreeView::reconcileRename() {
+  ScratchRepository repo;
+  QDir dir = repo->workdir();
+  QVERIFY(dir.mkpath("folder/sub"));
+
+  auto write = [&dir](const QString &name) {
+    QFile file(dir.filePath(name));
+    QVERIFY(file.open(QFile::WriteOnly));
+    QTextStream(&file) << name << Qt::endl;
+  };
+
+  write("folder/a.txt");
+  write("folder/sub/b.txt");
+
+  DiffTreeModel model(repo);
+  model.enableListView(false);
+  QVERIFY(!model.setDiff(repo->status(repo->index(), nullptr)));
+
+  QModelIndex folder = model.index("folder");
+  QModelIndex sub = model.index("folder/sub");
+  QVERIFY(folder.isValid() && sub.isValid());
+
+  QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+
+  // Rename the only file of each folder. Both folders are emptied and
+  // refilled during the reconciliation.
+  QVERIFY(dir.rename("folder/a.txt", "folder/c.txt"));
+  QVERIFY(dir.rename("folder/sub/b.txt", "folder/sub/d.txt"));
+  QVERIFY(model.setDiff(repo->status(repo->index(), nullptr)));
+  QCOMPARE(reset.count(), 0);
+
+  // The folders keep their nodes and get the renamed files.
+  QCOMPARE(model.index("folder").internalPointer(), folder.internalPointer());
+  QCOMPARE(model.index("folder/sub").internalPointer(), sub.internalPointer());
+  QVERIFY(!model.index("folder/a.txt").isValid());
+  QVERIFY(!model.index("folder/sub/b.txt").isValid());
+  QVERIFY(model.index("folder/c.txt").isValid());
+  QVERIFY(model.index("folder/sub/d.txt").isValid());
+  QCOMPARE(model.rowCount(model.index("folder")), 2);
+  QCOMPARE(model.rowCount(model.index("folder/sub")), 1);
+
+  QList<int> indices = model.patchIndices(model.index("folder"));
+  std::sort(indices.begin(), indices.end());
+  QCOMPARE(indices, QList<int>({0, 1}));
+}
+
 TEST_MAIN(TestTreeView)
 
 #include "TreeView.moc"
@@ -0,0 +1,154 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Reference.h"
+#include "git/Tree.h"
+#include "index/TrigramIndex.h"
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+// Commit the file and return the new tree.
+git::Id commit(git::Repository repo, const QString &name,
+               const QByteArray &content) {
+  QString message = QString("update %1").arg(name);
+  git::Commit commit = commitFile(repo, name, content, message);
+  return commit.isValid() ? commit.tree().id() : git::Id();
+}
+
+QStringList paths(const Grep::Entries &entries) {
+  QStringList paths;
+  foreach (const Grep::Entry &entry, entries)
+    paths.append(entry.path);
+  paths.sort();
+  return paths;
+}
+
+} // namespace
+
+class TestTrigramIndex : public QObject {
+  Q_OBJECT
+
+private slots:
+  void literals();
+  void build();
+  void unindexed();
+};
+
+void TestTrigramIndex::literals() {
+  using Literals = QList<QByteArray>;
+  QCOMPARE(TrigramIndex::literals("a.b", false), Literals({"a.b"}));
+  QCOMPARE(TrigramIndex::literals("foo.*bar", true),
+           Literals({"foo", "bar"}));
+  QCOMPARE(TrigramIndex::literals("colou?r", true),
+           Literals({"colo", "r"}));
+  QCOMPARE(TrigramIndex::literals("ab+c\\.d", true),
+           Literals({"ab", "c.d"}));
+  QCOMPARE(TrigramIndex::literals("x(abc)?yz[0-9]{2}w", true),
+           Literals({"x", "yz", "w"}));
+  QCOMPARE(TrigramIndex::literals("abc|def", true), Literals());
+  QCOMPARE(TrigramIndex::literals("(?x) abc", true), Literals());
+}
+
+void TestTrigramIndex::build() {
+  ScratchRepository repo;
+  QVERIFY(commit(repo, "a.txt", "hello world\n").isValid());
+  git::Id tree = commit(repo, "b.txt", "Goodbye, World\n");
+  QVERIFY(tree.isValid());
+
+  TrigramIndex::Data data =
+      TrigramIndex::build(repo, TrigramIndex::Data(), tree);
+  QCOMPARE(data.tree, tree);
+  QCOMPARE(data.files.size(), 2);
+
+  // Write it out and read it back.
+  QTemporaryDir dir;
+  QString file = dir.filePath("trigrams");
+  QVERIFY(TrigramIndex::write(file, data));
+  data = TrigramIndex::read(file);
+  QCOMPARE(data.tree, tree);
+  QCOMPARE(data.files.size(), 2);
+
+  // Only update the modified file.
+  tree = commit(repo, "a.txt", "hello there\n");
+  QVERIFY(tree.isValid());
+  data = TrigramIndex::build(repo, data, tree);
+  QCOMPARE(data.tree, tree);
+  QCOMPARE(data.removed, 1);
+  QCOMPARE(data.paths.size(), 2);
+
+  QVector<quint32> there = data.postings.value(('t' << 16) | ('h' << 8) | 'e');
+  QCOMPARE(there.size(), 1);
+  QCOMPARE(data.files.at(there.first()).path, QString("a.txt"));
+
+  QVector<quint32> wor = data.postings.value(('w' << 16) | ('o' << 8) | 'r');
+  QCOMPARE(wor.size(), 2); // a stale posting is left behind
+  QCOMPARE(data.files.at(wor.first()).path, QString());
+  QCOMPARE(data.files.at(wor.last()).path, QString("b.txt"));
+
+  // Compact on write.
+  QVERIFY(TrigramIndex::write(file, data));
+  data = TrigramIndex::read(file);
+  QCOMPARE(data.files.size(), 2);
+  QCOMPARE(data.removed, 0);
+
+  wor = data.postings.value(('w' << 16) | ('o' << 8) | 'r');
+  QCOMPARE(wor.size(), 1);
+  QCOMPARE(data.files.at(wor.first()).path, QString("b.txt"));
+  QCOMPARE(paths(data.files), QStringList({"a.txt", "b.txt"}));
+}
+
+void TestTrigramIndex::unindexed() {
+  ScratchRepository repo;
+  QByteArray large = QByteArray("needle in a haystack\n").repeated(64 * 1024);
+  QVERIFY(commit(repo, "large.txt", large).isValid());
+  QVERIFY(commit(repo, "data.bin", QByteArray("needle\0", 7)).isValid());
+  git::Id tree = commit(repo, "small.txt", "hello world\n");
+  QVERIFY(tree.isValid());
+
+  // Large text files are remembered without their trigrams.
+  TrigramIndex::Data data =
+      TrigramIndex::build(repo, TrigramIndex::Data(), tree);
+  QCOMPARE(data.files.size(), 1);
+  QCOMPARE(QStringList(data.unindexed.keys()), QStringList({"large.txt"}));
+
+  QTemporaryDir dir;
+  QString file = dir.filePath("trigrams");
+  QVERIFY(TrigramIndex::write(file, data));
+  data = TrigramIndex::read(file);
+  QCOMPARE(QStringList(data.unindexed.keys()), QStringList({"large.txt"}));
+
+  // They're candidates for every query. Binary files aren't.
+  TrigramIndex index(repo);
+  QSignalSpy updated(&index, &TrigramIndex::updated);
+  index.update();
+  QTRY_COMPARE(updated.size(), 1);
+
+  Grep::Options options;
+  options.pattern = "hello";
+  Grep::Entries files;
+  QVERIFY(index.candidates(options, files));
+  QCOMPARE(paths(files), QStringList({"large.txt", "small.txt"}));
+
+  options.pattern = "needle";
+  QVERIFY(index.candidates(options, files));
+  QCOMPARE(paths(files), QStringList({"large.txt"}));
+
+  // They're indexed once they're small enough.
+  tree = commit(repo, "large.txt", "needle\n");
+  QVERIFY(tree.isValid());
+  data = TrigramIndex::build(repo, data, tree);
+  QVERIFY(data.unindexed.isEmpty());
+  QCOMPARE(data.paths.size(), 2);
+}
+
+TEST_MAIN(TestTrigramIndex)
+
+#include "TrigramIndex.moc"
@@ -10,6 +10,7 @@
 #include "Test.h"
 #include "conf/Settings.h"
 #include "git/Config.h"
+#include <QtConcurrent>
 
 using namespace QTest;
 
@@ -18,6 +19,8 @@ class TestConfig : public QObject {
 
 private slots:
   void mergetools();
+  void appConfigCache();
+  void appConfigThreads();
 };
 
 void TestConfig::mergetools() {
@@ -38,6 +41,49 @@ void TestConfig::mergetools() {
   QVERIFY(names.contains("difftool.araxis.cmd"));
 }
 
+void TestConfig::appConfigCache() {
+  Test::ScratchRepository repo;
+  QVERIFY(!repo->isUntrackedHidden());
+
+  // Writes through the shared snapshot are visible to every handle.
+  repo->appConfig().setValue("untracked.hide", true);
+  QVERIFY(repo->appConfig().value<bool>("untracked.hide"));
+  QVERIFY(repo->isUntrackedHidden());
+
+  // Changes made to the file by someone else are picked up too.
+  git::Config file =
+      git::Config::open(repo->appDir().filePath("config"));
+  file.setValue("untracked.hide", false);
+  QVERIFY(!repo->appConfig().value<bool>("untracked.hide", true));
+  QVERIFY(!repo->isUntrackedHidden());
+}
+
+void TestConfig::appConfigThreads() {
+  Test::ScratchRepository scratch;
+  git::Repository repo = scratch;
+
+  // Every handle shares one libgit2 config. Hammer it from several
+  // threads at once. Each access is serialized by the shared lock.
+  QAtomicInt mismatches = 0;
+  QList<int> keys = {0, 1, 2, 3, 4, 5, 6, 7};
+  QtConcurrent::blockingMap(keys, [repo, &mismatches](int key) {
+    QString name = QString("test.key%1").arg(key);
+    for (int i = 0; i < 100; ++i) {
+      git::Config config = repo.appConfig();
+      config.setValue(name, i);
+      if (config.value<int>(name) != i)
+        mismatches.ref();
+      config.value<bool>("untracked.hide", false);
+    }
+  });
+
+  QCOMPARE(mismatches.loadAcquire(), 0);
+
+  git::Config config = repo.appConfig();
+  foreach (int key, keys)
+    QCOMPARE(config.value<int>(QString("test.key%1").arg(key)), 99);
+}
+
 TEST_MAIN(TestConfig)
 
 #include "config.moc"
@@ -15,6 +15,7 @@
 #include "ui/DoubleTreeWidget.h"
 #include "ui/RepoView.h"
 #include "ui/TreeView.h"
+#include "git2/repository.h"
 #include <QFile>
 #include <QPushButton>
 #include <QTextEdit>
@@ -31,6 +32,7 @@ private slots:
   void firstCommit();
   void secondCommit();
   void thirdCommit();
+  void mergePreview();
   void mergeConflict();
   void resolve();
   void cleanupTestCase();
@@ -158,6 +160,27 @@ void TestMerge::thirdCommit() {
   refresh(view, false);
 }
 
+void TestMerge::mergePreview() {
+  git::Commit ours = mRepo->head().target();
+  git::Commit theirs = mRepo->lookupRef("refs/heads/branch2").target();
+  QVERIFY(ours.isValid() && theirs.isValid());
+
+  git::Repository::MergePreview preview = mRepo->mergePreview(ours, theirs);
+  QVERIFY(preview.valid);
+  QVERIFY(!preview.upToDate);
+  QVERIFY(!preview.fastForward);
+  QCOMPARE(preview.conflicts, QStringList("test"));
+
+  // Nothing was written.
+  QVERIFY(mRepo->state() == GIT_REPOSITORY_STATE_NONE);
+  QVERIFY(!mRepo->diffIndexToWorkdir().isConflicted());
+
+  // Merging an ancestor is a no-op.
+  preview = mRepo->mergePreview(ours, ours.parents().first());
+  QVERIFY(preview.valid);
+  QVERIFY(preview.upToDate);
+}
+
 void TestMerge::mergeConflict() {
   RepoView *view = mWindow->currentView();
   git::Reference master =
@@ -0,0 +1,82 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+
+#include "Test.h"
+#include "git/Index.h"
+#include "git/Remote.h"
+#include "ui/MainWindow.h"
+#include "ui/RepoView.h"
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+using namespace Test;
+using namespace QTest;
+
+class TestPush : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void pushAll();
+  void cleanupTestCase();
+
+private:
+  ScratchRepository mRepo;
+  QTemporaryDir mRemoteDir;
+  MainWindow *mWindow = nullptr;
+};
+
+void TestPush::initTestCase() {
+  QFile file(mRepo->workdir().filePath("test"));
+  QVERIFY(file.open(QFile::WriteOnly));
+  QTextStream(&file) << "This will be pushed." << Qt::endl;
+  file.close();
+
+  mRepo->index().setStaged({"test"}, true);
+  QVERIFY(mRepo->commit("initial commit").isValid());
+
+  // Exercise the threaded pack builder.
+  mRepo->gitConfig().setValue("pack.threads", 2);
+
+  foreach (const QString &name, {QString("first"), QString("second")}) {
+    QString path = QDir(mRemoteDir.path()).filePath(name);
+    QVERIFY(git::Repository::init(path, true).isValid());
+    QVERIFY(mRepo->addRemote(name, QUrl::fromLocalFile(path).toString()));
+  }
+
+  mWindow = new MainWindow(mRepo);
+  mWindow->show();
+  QVERIFY(qWaitForWindowExposed(mWindow));
+}
+
+void TestPush::pushAll() {
+  RepoView *view = mWindow->currentView();
+  git::Reference head = mRepo->head();
+  QVERIFY(head.isValid());
+
+  view->pushAll();
+
+  foreach (const QString &name, {QString("first"), QString("second")}) {
+    QString path = QDir(mRemoteDir.path()).filePath(name);
+    git::Repository remote = git::Repository::open(path);
+    QVERIFY(remote.isValid());
+    QTRY_VERIFY_WITH_TIMEOUT(remote.lookupRef(head.qualifiedName()).isValid(),
+                             30000);
+
+    git::Reference ref = remote.lookupRef(head.qualifiedName());
+    QCOMPARE(ref.target().id(), head.target().id());
+  }
+}
+
+void TestPush::cleanupTestCase() {
+  mWindow->close();
+}
+
+TEST_MAIN(TestPush)
+
+#include "push.moc"
@@ -83,6 +83,8 @@ private slots:
                                               // cli and finish in the GUI
   void abortMR();
   void commitDuringRebase();
+  void inMemoryWithoutConflicts();
+  void inMemoryConflict(); // falls back to an on-disk rebase
 
 private:
   git::Repository mRepo;
@@ -926,6 +928,95 @@ void TestRebase::commitDuringRebase() {
   QCOMPARE(rebaseConflict, 0);
 }
 
+void TestRebase::inMemoryWithoutConflicts() {
+  INIT_REPO("rebaseConflicts.zip", true);
+
+  int rebaseFinished = 0;
+  int rebaseCommitSuccess = 0;
+
+  connect(mRepo.notifier(), &git::RepositoryNotifier::rebaseInitError,
+          [=]() { QVERIFY(false); }); // Should not be called
+  connect(mRepo.notifier(), &git::RepositoryNotifier::rebaseConflict,
+          [=]() { QVERIFY(false); }); // Should not be called
+  connect(mRepo.notifier(), &git::RepositoryNotifier::rebaseFinished,
+          [=, &rebaseFinished](const Rebase rebase) {
+            QVERIFY(rebase.isInMemory());
+            rebaseFinished++;
+          });
+  connect(mRepo.notifier(), &git::RepositoryNotifier::rebaseCommitSuccess,
+          [=, &rebaseCommitSuccess](const Rebase rebase, const Commit before,
+                                    const Commit after, int counter) {
+            // Nothing is written to the workdir while replaying.
+            QCOMPARE(mRepo.rebaseOngoing(), false);
+            rebaseCommitSuccess++;
+          });
+
+  const QString rebaseBranchName = "refs/heads/noConflict";
+
+  git::Reference branch = mRepo.lookupRef(rebaseBranchName);
+  QVERIFY(branch.isValid());
+  QCOMPARE(mRepo.checkout(branch.annotatedCommit().commit()), true);
+  QVERIFY(mRepo.setHead(branch));
+
+  git::Reference mainBranch = mRepo.lookupRef(QString("refs/heads/main"));
+  QVERIFY(mainBranch.isValid());
+  auto ac = mainBranch.annotatedCommit();
+  mRepo.rebaseInMemory(ac);
+
+  // Check that branch is based on "main" now
+  branch = mRepo.lookupRef(rebaseBranchName);
+  QVERIFY(branch.isValid());
+  git::Commit tip = branch.annotatedCommit().commit();
+  QList<Commit> parents = tip.parents();
+  QCOMPARE(parents.count(), 1);
+  QCOMPARE(parents.at(0).id(), ac.commit().id());
+
+  // The workdir was materialized at the end.
+  QCOMPARE(mRepo.diffTreeToIndex(tip.tree()).count(), 0);
+
+  QCOMPARE(mRepo.rebaseOngoing(), false);
+  QCOMPARE(rebaseFinished, 1);
+  QCOMPARE(rebaseCommitSuccess, 1);
+}
+
+void TestRebase::inMemoryConflict() {
+  INIT_REPO("rebaseConflicts.zip", true);
+
+  int rebaseFinished = 0;
+  int rebaseConflict = 0;
+
+  connect(mRepo.notifier(), &git::RepositoryNotifier::rebaseFinished,
+          [=, &rebaseFinished]() { rebaseFinished++; });
+  connect(mRepo.notifier(), &git::RepositoryNotifier::rebaseConflict,
+          [=, &rebaseConflict](const Rebase rebase) {
+            QVERIFY(!rebase.isInMemory());
+            rebaseConflict++;
+          });
+
+  const QString rebaseBranchName = "refs/heads/singleCommitConflict";
+
+  git::Reference branch = mRepo.lookupRef(rebaseBranchName);
+  QVERIFY(branch.isValid());
+  QCOMPARE(mRepo.checkout(branch.annotatedCommit().commit()), true);
+  QVERIFY(mRepo.setHead(branch));
+
+  git::Reference mainBranch = mRepo.lookupRef(QString("refs/heads/main"));
+  QVERIFY(mainBranch.isValid());
+  mRepo.rebaseInMemory(mainBranch.annotatedCommit());
+
+  // The conflict is materialized as a regular rebase.
+  QCOMPARE(rebaseConflict, 1);
+  QCOMPARE(rebaseFinished, 0);
+  QCOMPARE(mRepo.rebaseOngoing(), true);
+
+  diff = mRepo.status(mRepo.index(), nullptr, false);
+  QCOMPARE(diff.count(), 1);
+  QCOMPARE(diff.patch(0).isConflicted(), true);
+
+  mRepo.rebaseAbort();
+  QCOMPARE(mRepo.rebaseOngoing(), false);
+}
+
 TEST_MAIN(TestRebase)
 
 #include "rebase.moc"
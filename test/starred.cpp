@@ -0,0 +1,152 @@
+//
+//          Copyright (c) 2016, Scientific Toolworks, Inc.
+//
+// This software is licensed under the MIT License. The LICENSE.md file
+// describes the conditions under which this software may be distributed.
+//
+// Author: Jason Haslam
+//
+
+#include "Test.h"
+#include "index/Index.h"
+#include "index/Query.h"
+#include <QCryptographicHash>
+
+using namespace Test;
+using namespace QTest;
+
+namespace {
+
+git::Id id(int i) {
+  QByteArray data = QByteArray::number(i);
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QStringList ids(const QList<git::Commit> &commits) {
+  QStringList ids;
+  foreach (const git::Commit &commit, commits)
+    ids.append(commit.id().toString());
+  ids.sort();
+  return ids;
+}
+
+// Evaluate a boolean query from the commit lists of its operands.
+QStringList combine(const Index::Snapshot *snapshot, const QString &lhs,
+                    const QString &op, const QString &rhs) {
+  QSet<QString> left = ids(Query::parseQuery(lhs)->commits(snapshot)).toSet();
+  QSet<QString> right = ids(Query::parseQuery(rhs)->commits(snapshot)).toSet();
+  QStringList result =
+      (op == "AND" ? left.intersect(right) : left.unite(right)).values();
+  result.sort();
+  return result;
+}
+
+} // namespace
+
+class TestStarred : public QObject {
+  Q_OBJECT
+
+private slots:
+  void log();
+  void compaction();
+  void query();
+};
+
+void TestStarred::log() {
+  Test::ScratchRepository repo;
+  repo->setCommitStarred(id(0), true);
+  repo->setCommitStarred(id(1), true);
+  repo->setCommitStarred(id(2), true);
+  repo->setCommitStarred(id(1), false);
+
+  // Reload from disk.
+  git::Repository reopened = git::Repository::open(repo->dir().path());
+  QVERIFY(reopened.isValid());
+  QVERIFY(reopened.isCommitStarred(id(0)));
+  QVERIFY(!reopened.isCommitStarred(id(1)));
+  QVERIFY(reopened.isCommitStarred(id(2)));
+}
+
+void TestStarred::compaction() {
+  Test::ScratchRepository repo;
+  repo->setCommitStarred(id(0), true);
+  for (int i = 0; i < 1000; ++i)
+    repo->setCommitStarred(id(1), i % 2 == 0);
+
+  // The log never grows far past the threshold.
+  QFile file(repo->appDir().filePath("starred"));
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QVERIFY(file.readAll().count('\n') < 300);
+
+  git::Repository reopened = git::Repository::open(repo->dir().path());
+  QVERIFY(reopened.isCommitStarred(id(0)));
+  QVERIFY(!reopened.isCommitStarred(id(1)));
+}
+
+void TestStarred::query() {
+  Test::ScratchRepository repo;
+
+  // Index four of five commits. Every one has "common" and odd ones
+  // have "odd".
+  QList<git::Commit> commits;
+  Index index(repo);
+  Index::PostingMap map;
+  for (int i = 0; i < 5; ++i) {
+    QByteArray content = QByteArray::number(i);
+    git::Commit commit = commitFile(repo, "file.txt", content, content);
+    QVERIFY(commit.isValid());
+    commits.append(commit);
+    if (i == 4)
+      break;
+
+    Index::Posting posting;
+    posting.id = i;
+    posting.field = Index::Message;
+    posting.positions.append(0);
+
+    index.ids().append(commit.id());
+    map["common"].append(posting);
+    if (i % 2)
+      map["odd"].append(posting);
+  }
+
+  QVERIFY(index.write(map));
+
+  // Star two indexed commits and one that isn't indexed yet.
+  commits.at(0).setStarred(true);
+  commits.at(1).setStarred(true);
+  commits.at(4).setStarred(true);
+
+  Index::SnapshotRef snapshot = index.snapshot();
+  QBitArray starred = Query::parseQuery("is:starred")->docs(snapshot.data());
+  QCOMPARE(starred.count(true), 2);
+
+  // Queries confined to the index are evaluated as bitmaps. Compare them
+  // with the result of combining the commit lists of their operands.
+  // Terms next to each other are combined with AND.
+  QList<QStringList> queries = {{"common", "AND", "is:starred"},
+                                {"is:starred", "AND", "odd"},
+                                {"odd", "AND", "is:starred"},
+                                {"common", "OR", "odd"}};
+  foreach (const QStringList &parts, queries) {
+    QString op = (parts.at(1) == "OR") ? " OR " : " ";
+    QueryRef query = Query::parseQuery(parts.at(0) + op + parts.at(2));
+    QVERIFY(query->isIndexedOnly());
+    QVERIFY(!query->docs(snapshot.data()).isNull());
+    QCOMPARE(ids(query->commits(snapshot.data())),
+             combine(snapshot.data(), parts.at(0), parts.at(1), parts.at(2)));
+  }
+
+  QCOMPARE(ids(Query::parseQuery("odd is:starred")->commits(snapshot.data())),
+           ids({commits.at(1)}));
+
+  // Others fall back to commit lists and include unindexed commits.
+  QueryRef query = Query::parseQuery("odd OR is:starred");
+  QVERIFY(!query->isIndexedOnly());
+  QCOMPARE(ids(query->commits(snapshot.data())),
+           ids({commits.at(0), commits.at(1), commits.at(3), commits.at(4)}));
+}
+
+TEST_MAIN(TestStarred)
+
+#include "starred.moc"